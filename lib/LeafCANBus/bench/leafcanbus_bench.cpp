@@ -0,0 +1,1321 @@
+/**
+ * LeafCANBus end-to-end benchmark on the Linux port (host only)
+ *
+ * Two LeafCANBus instances share one bus: "tx" plays a module sending
+ * frames, "rx" plays a consumer with LeafCANMessages subscriptions.
+ *
+ * Burst: tx.send() bursts of frames across several IDs, rx.process() drains
+ * after each burst. Reports frames/s through send -> port -> process ->
+ * unpack, and checks every frame was delivered to its subscription.
+ *
+ * TX queue: LeafCANTxQueue must hand out random standard/extended frames in
+ * bus arbitration order (FIFO per ID), evict the lowest priority when full
+ * and drop frames past their deadline. Reports push+pop cost per frame.
+ *
+ * Health: LeafCANHealth driven through a scripted bus-off storm on a
+ * simulated clock; recovery backoff must double up to its cap, reset once
+ * the bus has been stable, and the per-state dwell times must add up. A
+ * driver restart must bring bus-off or recovering back to error-active.
+ *
+ * Publish: a module-style loop (publish() at 1 ms + process()) for a fixed
+ * wall time; reports how many periodic frames arrived vs. expected.
+ *
+ * Dispatch: LeafCANSubscriptionIndex with DISPATCH_SUBS subscriptions (two
+ * callbacks on some IDs, one mask subscription) against the linear slot
+ * scan LeafCANBus used before; both must run the same callbacks.
+ *
+ * Filter: for random subscription sets, the computed TWAI acceptance filter
+ * must pass every frame some subscription wants (checked over all 2048
+ * standard IDs and the extended IDs in play). Reports how much of the ID
+ * space leaks through, and that the loopback port drops unsubscribed frames.
+ *
+ * Latency: a sender thread streams two IDs at LATENCY_RATE frames/s while
+ * the main thread runs a module loop (process(); delay(10)). One ID goes
+ * through subscribe() (queue), the other through subscribeDirect() (RX
+ * path into LeafCANState). Reports frame-to-state latency and overflows
+ * for several RX queue depths, and checks LeafCANState never tears.
+ *
+ * Schedule: three publishers on one interval, loop driven by
+ * waitForNextPublish(). Reports each publisher's phase, deadline jitter
+ * and misses, and checks the phases keep the frames apart on the bus.
+ *
+ * ISO-TP: two LeafCANIsoTp endpoints move 4095-byte and 10000-byte (32-bit
+ * length) messages both ways with BS/STmin flow control, plus one message
+ * too large for the receive buffer (must end in FC overflow). Reports
+ * throughput and bus efficiency; on a SocketCAN interface it also talks to
+ * a kernel CAN_ISOTP socket.
+ *
+ * Time sync: LeafCANTimeSync fed simulated sync/follow-up pairs from a
+ * master clock with an offset, 50 ppm drift and RX stamp jitter must lock
+ * within a few microseconds; then a master and a follower LeafCANBus on the
+ * bus exchange syncs and frames carrying origin timestamps, whose age the
+ * follower measures.
+ *
+ * Usage:
+ *   leafcanbus_bench                  loopback bus (no kernel CAN needed)
+ *   leafcanbus_bench vcan0            SocketCAN interface
+ *   leafcanbus_bench --check [iface]  exit 1 on loss or < 10k frames/s
+ */
+
+#include "LeafCANBus.h"
+#include "LeafCANFilter.h"
+#include "LeafCANTxQueue.h"
+#include "LeafCANIsoTp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+
+#define BURST_FRAMES    (CAN_PORT_RX_QUEUE_LEN / 2)
+#define BURST_COUNT     20000
+#define PUBLISH_MS      500
+#define CHECK_MIN_FPS   10000.0
+
+#define DISPATCH_IDS    64
+#define DISPATCH_SUBS   96
+#define DISPATCH_FRAMES 2000000
+
+struct Counted {
+    uint32_t frames;
+    union {
+        GPSPositionState gps_position;
+        GPSVelocityState gps_velocity;
+        BodyTempState body_temp;
+        BodyVoltageState body_voltage;
+    } state;
+};
+
+#define COUNTING_UNPACK(name, field)                                    \
+    static void count_##name(const uint8_t* data, uint8_t len, void* state) { \
+        Counted* c = (Counted*)state;                                   \
+        unpack_##name(data, len, &c->state.field);                      \
+        c->frames++;                                                    \
+    }
+
+COUNTING_UNPACK(gps_position, gps_position)
+COUNTING_UNPACK(gps_velocity, gps_velocity)
+COUNTING_UNPACK(body_temp, body_temp)
+COUNTING_UNPACK(body_voltage, body_voltage)
+
+struct Stream {
+    uint32_t can_id;
+    can_unpack_callback_t unpack;
+    Counted counted;
+};
+
+// IDs present in every battery/motor configuration
+static Stream streams[] = {
+    { CAN_ID_GPS_POSITION,      count_gps_position, {} },
+    { CAN_ID_GPS_VELOCITY,      count_gps_velocity, {} },
+    { CAN_ID_BODY_TEMP_SENSORS, count_body_temp,    {} },
+    { CAN_ID_BODY_VOLTAGE,      count_body_voltage, {} },
+};
+static const int STREAM_COUNT = sizeof(streams) / sizeof(streams[0]);
+
+static double now_s() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool run_burst(LeafCANBus& tx, LeafCANBus& rx, double* fps) {
+    BodyTempState temps = { 215, -48, 733, 1201 };
+    uint8_t data[8];
+    uint8_t len;
+    pack_body_temp(&temps, data, &len);
+
+    uint32_t sent = 0;
+    uint32_t send_failures = 0;
+    double t0 = now_s();
+    for (int b = 0; b < BURST_COUNT; b++) {
+        for (int i = 0; i < BURST_FRAMES; i++) {
+            const Stream& s = streams[(b * BURST_FRAMES + i) % STREAM_COUNT];
+            if (tx.send(s.can_id, data, len)) sent++;
+            else send_failures++;
+        }
+        // SocketCAN delivers on the RX thread; give it a moment per burst
+        uint32_t target = rx.getRxCount() + BURST_FRAMES;
+        for (int spin = 0; spin < 1000 && rx.getRxCount() < target; spin++) {
+            rx.process();
+        }
+    }
+    double elapsed = now_s() - t0;
+
+    uint32_t delivered = 0;
+    for (int i = 0; i < STREAM_COUNT; i++) delivered += streams[i].counted.frames;
+
+    *fps = delivered / elapsed;
+    printf("burst:   sent %u  delivered %u  send failures %u  rx errors %u\n",
+           sent, delivered, send_failures, rx.getErrorCount());
+    printf("         %.3f s  %.0f frames/s  %.0f ns/frame\n",
+           elapsed, *fps, elapsed * 1e9 / (delivered ? delivered : 1));
+    CANTxStats txs = tx.getTxStats();
+    printf("         tx queue: max depth %u  dropped %u  expired %u  latency mean %.1f us  max %u us\n",
+           txs.max_depth, txs.dropped, txs.expired,
+           txs.sent ? (double)txs.latency_total_us / txs.sent : 0.0, txs.latency_max_us);
+    CANBusHealth health = rx.getBusHealth();
+    printf("         rx bus %s, %u RX events\n", can_bus_state_name(health.state),
+           health.events[CAN_EVENT_RX_DATA]);
+
+    // Last decoded body temp frame must match what was packed
+    const BodyTempState& got = streams[2].counted.state.body_temp;
+    bool decoded_ok = memcmp(&got, &temps, sizeof(temps)) == 0;
+    if (!decoded_ok) printf("         decoded body temp frame mismatch\n");
+
+    return decoded_ok && send_failures == 0 && delivered == sent && rx.getErrorCount() == 0;
+}
+
+static bool run_publish(LeafCANBus& tx, LeafCANBus& rx) {
+    BodyVoltageState volts = {};
+    uint32_t before = streams[3].counted.frames;
+
+    // Module shape: setup() registers, loop() calls process()
+    tx.publish(CAN_ID_BODY_VOLTAGE, 1, pack_body_voltage, &volts);
+
+    uint32_t start = millis();
+    while (millis() - start < PUBLISH_MS) {
+        tx.process();
+        rx.process();
+        delayMicroseconds(50);
+    }
+    rx.process();
+
+    uint32_t got = streams[3].counted.frames - before;
+    printf("publish: 1 ms interval for %d ms -> %u frames (expected ~%d)\n",
+           PUBLISH_MS, got, PUBLISH_MS);
+
+    // Allow scheduler slack on a loaded host, but never more than one per tick
+    return got >= PUBLISH_MS / 2 && got <= PUBLISH_MS + 1;
+}
+
+// ============================================================================
+// TX QUEUE: arbitration order, eviction, deadlines
+// ============================================================================
+
+#define TXQ_FRAMES 2000000
+
+// Bus arbitration: base ID first, standard before extended, then ID[17:0]
+static uint64_t arbitration_rank(const CANFrame& f) {
+    if (!f.extended) return (uint64_t)(f.id & 0x7FF) << 19;
+    return (uint64_t)((f.id >> 18) & 0x7FF) << 19 | 1u << 18 | (f.id & 0x3FFFF);
+}
+
+static CANFrame tx_frame(uint32_t id, bool extended, uint32_t seq) {
+    CANFrame f;
+    memset(&f, 0, sizeof(f));
+    f.id = id;
+    f.extended = extended;
+    f.len = 4;
+    memcpy(f.data, &seq, sizeof(seq));
+    return f;
+}
+
+static bool run_tx_queue() {
+    LeafCANTxQueue q;
+    bool evicted;
+    uint32_t expired = 0;
+    uint32_t seq = 0;
+    uint32_t misordered = 0;
+    CANTxEntry e;
+    srand(3);
+
+    // Random batches (few distinct IDs so FIFO ties are exercised)
+    double t0 = now_s();
+    uint32_t popped = 0;
+    while (popped < TXQ_FRAMES) {
+        int n = 1 + rand() % CAN_PORT_TX_QUEUE_LEN;
+        for (int i = 0; i < n; i++) {
+            bool ext = rand() % 4 == 0;
+            uint32_t id = ext ? (uint32_t)(rand() % 8) << 18 | (rand() % 4) : 0x700 + rand() % 16;
+            q.push(tx_frame(id, ext, seq++), 0, 0, false, &evicted);
+        }
+        uint64_t last_rank = 0;
+        uint32_t last_seq = 0;
+        bool first = true;
+        while (q.pop(&e, 0, &expired)) {
+            uint64_t rank = arbitration_rank(e.frame);
+            uint32_t s;
+            memcpy(&s, e.frame.data, sizeof(s));
+            if (!first && (rank < last_rank || (rank == last_rank && s < last_seq))) misordered++;
+            first = false;
+            last_rank = rank;
+            last_seq = s;
+            popped++;
+        }
+    }
+    double elapsed = now_s() - t0;
+
+    // Full queue: a higher-priority frame evicts the lowest, a lower one is refused
+    for (int i = 0; i < CAN_PORT_TX_QUEUE_LEN; i++) q.push(tx_frame(0x700 + i, false, i), 0, 0, false, &evicted);
+    bool high_ok = q.push(tx_frame(0x100, false, 0), 0, 0, false, &evicted) && evicted;
+    bool low_refused = !q.push(tx_frame(0x7FF, false, 0), 0, 0, false, &evicted);
+    bool evicted_lowest = true;
+    bool first_is_high = q.pop(&e, 0, &expired) && e.frame.id == 0x100;
+    while (q.pop(&e, 0, &expired)) {
+        if (e.frame.id == 0x700 + CAN_PORT_TX_QUEUE_LEN - 1) evicted_lowest = false;
+    }
+
+    // Deadlines: stale frames are skipped, fresh ones still go out
+    q.push(tx_frame(0x100, false, 0), 1000, 1500, true, &evicted);
+    q.push(tx_frame(0x200, false, 0), 1000, 5000, true, &evicted);
+    q.push(tx_frame(0x300, false, 0), 1000, 0, false, &evicted);
+    uint32_t stale = 0;
+    uint32_t out = 0;
+    while (q.pop(&e, 2000, &stale)) out++;
+
+    printf("txqueue:  %u frames in random batches  %.1f ns/frame push+pop  %u out of order\n",
+           popped, elapsed * 1e9 / popped, misordered);
+    printf("          full: higher-priority frame %s, lower %s; deadline: %u expired, %u sent\n",
+           high_ok && first_is_high && evicted_lowest ? "evicts the lowest" : "NOT queued correctly",
+           low_refused ? "refused" : "NOT refused", stale, out);
+    return misordered == 0 && high_ok && first_is_high && evicted_lowest && low_refused &&
+           stale == 1 && out == 2;
+}
+
+// ============================================================================
+// HEALTH: bus-off recovery backoff on a simulated clock
+// ============================================================================
+
+#define HEALTH_STORM 8
+
+static bool run_health() {
+    LeafCANHealth h;
+    uint32_t now = 0;
+    h.reset(now);
+    bool ok = true;
+
+    // Errors build up to bus-off
+    now += 100; h.onEvent(CAN_EVENT_BUS_ERROR, now); h.onEvent(CAN_EVENT_ERROR_WARNING, now);
+    now += 100; h.onEvent(CAN_EVENT_ERROR_PASSIVE, now);
+    ok = h.state() == CAN_BUS_ERROR_PASSIVE && ok;
+
+    // Storm: every recovery is followed by another bus-off 50 ms later
+    uint32_t backoffs[HEALTH_STORM];
+    for (int i = 0; i < HEALTH_STORM; i++) {
+        now += 50;
+        h.onEvent(CAN_EVENT_BUS_OFF, now);
+        CANBusHealth snap;
+        h.snapshot(&snap, now);
+        backoffs[i] = snap.backoff_ms;
+
+        // Nothing before the backoff has elapsed, then exactly one attempt
+        ok = !h.recoveryDue(now + snap.backoff_ms - 1) && ok;
+        ok = h.msUntilRecovery(now + 1) == snap.backoff_ms - 1 && ok;
+        now += snap.backoff_ms;
+        ok = h.recoveryDue(now) && !h.recoveryDue(now) && ok;
+        ok = h.state() == CAN_BUS_RECOVERING && ok;
+        now += 20;
+        h.onEvent(CAN_EVENT_BUS_RECOVERED, now);
+        ok = h.state() == CAN_BUS_ERROR_ACTIVE && ok;
+    }
+    for (int i = 0; i < HEALTH_STORM; i++) {
+        uint32_t expected = CAN_PORT_RECOVERY_MIN_MS << i;
+        if (expected > CAN_PORT_RECOVERY_MAX_MS) expected = CAN_PORT_RECOVERY_MAX_MS;
+        ok = backoffs[i] == expected && ok;
+    }
+
+    // Stable long enough: the next bus-off starts from the minimum again
+    now += CAN_PORT_RECOVERY_STABLE_MS;
+    h.onEvent(CAN_EVENT_BUS_OFF, now);
+    CANBusHealth snap;
+    h.snapshot(&snap, now + 10);
+    bool reset_ok = snap.backoff_ms == CAN_PORT_RECOVERY_MIN_MS;
+
+    uint32_t dwell_total = 0;
+    for (int i = 0; i < CAN_BUS_STATE_COUNT; i++) dwell_total += snap.dwell_ms[i];
+
+    printf("health:   backoff");
+    for (int i = 0; i < HEALTH_STORM; i++) printf(" %u", backoffs[i]);
+    printf(" ms, after %d s stable %u ms\n", CAN_PORT_RECOVERY_STABLE_MS / 1000, snap.backoff_ms);
+    printf("          %u attempts, %u recoveries, %u bus-off alerts; dwell",
+           snap.recovery_attempts, snap.recoveries, snap.events[CAN_EVENT_BUS_OFF]);
+    for (int i = 0; i < CAN_BUS_STATE_COUNT; i++) {
+        printf(" %s %u", can_bus_state_name((CANBusState)i), snap.dwell_ms[i]);
+    }
+    printf(" ms\n");
+
+    // A driver restart (filter change) leaves bus-off or a recovery behind
+    bool restart_ok = true;
+    for (int recovering = 0; recovering < 2; recovering++) {
+        LeafCANHealth r;
+        r.reset(0);
+        r.onEvent(CAN_EVENT_BUS_OFF, 10);
+        if (recovering) r.recoveryDue(10 + CAN_PORT_RECOVERY_MIN_MS);
+        r.onRestart(20 + CAN_PORT_RECOVERY_MIN_MS);
+        restart_ok = r.state() == CAN_BUS_ERROR_ACTIVE && restart_ok;
+        restart_ok = !r.recoveryDue(20 + CAN_PORT_RECOVERY_MAX_MS) && restart_ok;
+        restart_ok = r.msUntilRecovery(20 + CAN_PORT_RECOVERY_MAX_MS) == UINT32_MAX && restart_ok;
+    }
+    printf("          driver restart from bus-off/recovering: %s\n", restart_ok ? "error-active" : "stuck");
+
+    return ok && reset_ok && restart_ok && dwell_total == now + 10 &&
+           snap.recovery_attempts == HEALTH_STORM && snap.recoveries == HEALTH_STORM &&
+           snap.state == CAN_BUS_OFF && snap.state_ms == 10;
+}
+
+// ============================================================================
+// DISPATCH: hashed index vs. linear scan
+// ============================================================================
+
+static void count_call(const uint8_t* data, uint8_t len, void* state) {
+    (void)data;
+    (void)len;
+    (*(uint32_t*)state)++;
+}
+
+// Pre-index LeafCANBus dispatch, extended with masks for a like-for-like check
+struct LinearSub {
+    uint32_t can_id;
+    uint32_t mask;
+    can_unpack_callback_t unpack_fn;
+    void* state_ptr;
+};
+
+static uint16_t linear_dispatch(const LinearSub* subs, int count, uint32_t can_id,
+                                const uint8_t* data, uint8_t len) {
+    uint16_t called = 0;
+    for (int i = 0; i < count; i++) {
+        if (((can_id ^ subs[i].can_id) & subs[i].mask) == 0) {
+            subs[i].unpack_fn(data, len, subs[i].state_ptr);
+            called++;
+        }
+    }
+    return called;
+}
+
+static bool run_dispatch() {
+    static LeafCANSubscriptionIndex<DISPATCH_SUBS> index;
+    static LinearSub linear[DISPATCH_SUBS];
+    static uint32_t index_counts[DISPATCH_SUBS];
+    static uint32_t linear_counts[DISPATCH_SUBS];
+    static uint32_t frame_ids[4096];
+
+    // 64 IDs spread like a real bus (standard + a few extended), the first 31
+    // with a second subscriber, plus one mask covering 0x6B0-0x6B7
+    int n = 0;
+    uint32_t ids[DISPATCH_IDS];
+    for (int i = 0; i < DISPATCH_IDS; i++) {
+        ids[i] = (i % 16 == 15) ? 0x18FF0000u + i : 0x0A0u + i * 23;
+    }
+    for (int i = 0; i < DISPATCH_SUBS - 1; i++) {
+        uint32_t id = ids[i % DISPATCH_IDS];
+        index.add(id, count_call, &index_counts[n]);
+        linear[n] = { id, CAN_SUB_EXACT_MASK, count_call, &linear_counts[n] };
+        n++;
+    }
+    index.addMask(0x6B0, 0x7F8, count_call, &index_counts[n]);
+    linear[n] = { 0x6B0, 0x7F8, count_call, &linear_counts[n] };
+    n++;
+
+    // 3 in 4 frames hit a subscribed ID, the rest are other traffic
+    uint32_t seed = 12345;
+    for (int i = 0; i < 4096; i++) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t r = seed >> 8;
+        frame_ids[i] = (r & 3) ? ids[(r >> 2) % DISPATCH_IDS] : 0x600u + ((r >> 2) & 0x1FF);
+    }
+
+    uint8_t data[8] = { 0 };
+    uint64_t index_calls = 0;
+    uint64_t linear_calls = 0;
+
+    double t0 = now_s();
+    for (int i = 0; i < DISPATCH_FRAMES; i++) {
+        index_calls += index.dispatch(frame_ids[i & 4095], data, 8);
+    }
+    double t_index = now_s() - t0;
+
+    t0 = now_s();
+    for (int i = 0; i < DISPATCH_FRAMES; i++) {
+        linear_calls += linear_dispatch(linear, n, frame_ids[i & 4095], data, 8);
+    }
+    double t_linear = now_s() - t0;
+
+    printf("dispatch: %d subscriptions on %u IDs + 1 mask, %d frames\n",
+           n, index.idCount(), DISPATCH_FRAMES);
+    printf("          index  %6.1f ns/frame\n", t_index * 1e9 / DISPATCH_FRAMES);
+    printf("          linear %6.1f ns/frame\n", t_linear * 1e9 / DISPATCH_FRAMES);
+
+    bool ok = index_calls == linear_calls &&
+              memcmp(index_counts, linear_counts, sizeof(index_counts)) == 0;
+    if (!ok) printf("          index and linear scan ran different callbacks\n");
+    return ok;
+}
+
+// ============================================================================
+// FILTER: computed acceptance filter vs. subscriptions
+// ============================================================================
+
+#define FILTER_TRIALS 2000
+
+static void noop_call(const uint8_t* data, uint8_t len, void* state) {
+    (void)data;
+    (void)len;
+    (void)state;
+}
+
+// Same conversion as LeafCANBus::applyFilter()
+template <uint16_t N>
+static CANFilter filter_for(const LeafCANSubscriptionIndex<N>& index) {
+    CANFilterRule rules[N];
+    for (uint16_t i = 0; i < index.size(); i++) {
+        rules[i].id = index.entry(i).can_id;
+        rules[i].mask = index.entry(i).mask;
+        rules[i].extended = index.entry(i).can_id > 0x7FF;
+    }
+    return can_filter_compute(rules, index.size());
+}
+
+// Every frame a subscription wants must pass; returns standard IDs accepted
+template <uint16_t N>
+static int verify_filter(const LeafCANSubscriptionIndex<N>& index, const CANFilter& filter,
+                         uint32_t* seed, bool* ok) {
+    int accepted = 0;
+    CANFrame frame = {};
+    frame.len = 8;
+    for (uint32_t id = 0; id <= 0x7FF; id++) {
+        *seed = *seed * 1103515245u + 12345u;
+        frame.id = id;
+        frame.extended = false;
+        memcpy(frame.data, seed, sizeof(*seed));
+        bool pass = can_filter_accepts(&filter, &frame);
+        accepted += pass;
+        if (!pass && index.dispatch(id, frame.data, 8) > 0) {
+            printf("          standard 0x%03X subscribed but filtered\n", (unsigned)id);
+            *ok = false;
+        }
+    }
+    for (uint16_t i = 0; i < index.size(); i++) {
+        const auto& e = index.entry(i);
+        if (e.can_id <= 0x7FF) continue;
+        for (int k = 0; k < 64; k++) {
+            *seed = *seed * 1103515245u + 12345u;
+            frame.id = (e.can_id | (*seed & ~e.mask)) & CAN_SUB_EXACT_MASK;
+            frame.extended = true;
+            if (!can_filter_accepts(&filter, &frame)) {
+                printf("          extended 0x%08X subscribed but filtered\n", (unsigned)frame.id);
+                *ok = false;
+            }
+        }
+    }
+    return accepted;
+}
+
+static bool run_filter(LeafCANBus& tx, LeafCANBus& rx) {
+    static LeafCANSubscriptionIndex<64> index;
+    uint32_t seed = 777;
+    bool ok = true;
+    double leak_sum = 0.0;
+    int dual = 0;
+
+    for (int t = 0; t < FILTER_TRIALS; t++) {
+        index.clear();
+        seed = seed * 1103515245u + 12345u;
+        int count = 1 + (seed >> 8) % 16;
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t r = seed >> 4;
+            switch (r % 8) {
+            case 0:  index.add(0x18FF0000u | (r >> 3 & 0xFFFF), noop_call, nullptr); break;
+            case 1:  index.addMask((r >> 3) & 0x7FF, 0x7F8, noop_call, nullptr); break;
+            default: index.add((r >> 3) & 0x7FF, noop_call, nullptr); break;
+            }
+        }
+        CANFilter filter = filter_for(index);
+        int accepted = verify_filter(index, filter, &seed, &ok);
+        leak_sum += accepted / 2048.0;
+        dual += !filter.single_filter;
+    }
+    printf("filter:   %d random subscription sets, %d used dual mode, %.1f%% of 11-bit IDs accepted on average\n",
+           FILTER_TRIALS, dual, leak_sum * 100.0 / FILTER_TRIALS);
+
+    // The BMS converter's subscriptions
+    index.clear();
+    index.add(0x1DB, noop_call, nullptr);
+    index.add(0x1DC, noop_call, nullptr);
+    index.add(0x390, noop_call, nullptr);
+    CANFilter bms = filter_for(index);
+    int bms_accepted = verify_filter(index, bms, &seed, &ok);
+    printf("          bms-victron (0x1DB 0x1DC 0x390): %s code=0x%08X mask=0x%08X -> %d of 2048 IDs\n",
+           bms.single_filter ? "single" : "dual",
+           (unsigned)bms.acceptance_code, (unsigned)bms.acceptance_mask, bms_accepted);
+
+    // End to end: unsubscribed traffic never reaches rx's queue
+    uint32_t rx_before = rx.getRxCount();
+    uint32_t filtered_before = rx.getFilteredCount();
+    uint8_t data[8] = { 0 };
+    for (int i = 0; i < 1000; i++) {
+        tx.send(0x100 + (i % 64), data, 8);
+        rx.process();
+    }
+    uint32_t dropped = rx.getFilteredCount() - filtered_before;
+    printf("          loopback: 1000 unsubscribed frames -> %u filtered, %u received\n",
+           dropped, rx.getRxCount() - rx_before);
+    ok = ok && dropped == 1000 && rx.getRxCount() == rx_before;
+
+    if (!ok) printf("          filter check failed\n");
+    return ok;
+}
+
+// ============================================================================
+// LATENCY: direct (RX path) vs. queued (process()) delivery
+// ============================================================================
+
+#define LATENCY_RATE    4000
+#define LATENCY_MS      300
+#define LOOP_DELAY_MS   10
+#define TEAR_MS         200
+
+struct Sender {
+    const char* interface;
+    volatile bool started;
+    uint32_t direct_sent;
+    uint32_t queued_sent;
+};
+
+static void* sender_main(void* arg) {
+    Sender* s = (Sender*)arg;
+    LeafCANBus tx;
+    tx.begin(s->interface);
+    s->started = true;
+
+    GPSPositionState gps = { 45.5, -122.6, 50.0f, 9, 1 };
+    BodyTempState temps = { 215, -48, 733, 1201 };
+    uint8_t gps_data[8], temp_data[8];
+    uint8_t gps_len, temp_len;
+    pack_gps_position(&gps, gps_data, &gps_len);
+    pack_body_temp(&temps, temp_data, &temp_len);
+
+    uint32_t period_us = 1000000 / LATENCY_RATE;
+    uint32_t start = micros();
+    for (uint32_t i = 0; micros() - start < LATENCY_MS * 1000u; i++) {
+        while (micros() - start < i * period_us) {}
+        if (i & 1) s->direct_sent += tx.send(CAN_ID_GPS_POSITION, gps_data, gps_len);
+        else s->queued_sent += tx.send(CAN_ID_BODY_TEMP_SENSORS, temp_data, temp_len);
+    }
+    tx.end();
+    return nullptr;
+}
+
+static void print_latency(const char* label, const CANLatencyStats& l) {
+    printf("%s %6u frames  mean %7.1f us  max %7u us\n", label, l.frames,
+           l.frames ? (double)l.total_us / l.frames : 0.0, l.max_us);
+}
+
+static bool run_latency_depth(const char* interface, uint16_t depth) {
+    static Counted queued;
+    LeafCANState<GPSPositionState> gps;
+
+    LeafCANBus rx;
+    rx.begin(interface, depth);
+    rx.subscribe(CAN_ID_BODY_TEMP_SENSORS, count_body_temp, &queued);
+    rx.subscribeDirect(CAN_ID_GPS_POSITION, unpack_gps_position, gps);
+    rx.process();   // Apply the filter before traffic starts
+
+    Sender sender = { interface, false, 0, 0 };
+    pthread_t thread;
+    pthread_create(&thread, nullptr, sender_main, &sender);
+
+    // Module loop
+    uint32_t start = millis();
+    while (millis() - start < LATENCY_MS + 50) {
+        rx.process();
+        delay(LOOP_DELAY_MS);
+    }
+    pthread_join(thread, nullptr);
+    rx.process();
+
+    CANPortStats port = rx.getPortStats();
+    CANLatencyStats direct = rx.getLatencyStats(true);
+    printf("latency:  rx queue depth %u, loop delay %d ms, %d frames/s\n", depth, LOOP_DELAY_MS, LATENCY_RATE);
+    print_latency("          direct", direct);
+    print_latency("          queued", rx.getLatencyStats(false));
+    printf("          queue overflows %u  driver overflows %u  handled in RX path %u\n",
+           port.queue_overflows, port.driver_overflows, port.handled);
+
+    GPSPositionState latest = gps.read();
+    bool ok = direct.frames == sender.direct_sent && port.handled == sender.direct_sent &&
+              gps.updateCount() == sender.direct_sent && latest.satellites == 9;
+    if (!ok) printf("          direct path lost frames (%u sent)\n", sender.direct_sent);
+
+    rx.end();
+    return ok;
+}
+
+// LeafCANState: a writer thread fills every word with the same counter; a
+// reader must never see a mix of two updates
+// Every word of a snapshot holds the same update number; a reader that sees
+// two different numbers got a mix of two updates. The large state keeps a
+// reader's copy long enough for the writer to lap it mid-copy.
+template <int Words>
+struct TearState {
+    uint32_t words[Words];
+};
+
+template <int Words>
+struct TearWriter {
+    LeafCANState<TearState<Words>>* state;
+    volatile bool stop;
+};
+
+template <int Words>
+static void* tear_writer_main(void* arg) {
+    TearWriter<Words>* w = (TearWriter<Words>*)arg;
+    for (uint32_t n = 1; !w->stop; n++) {
+        TearState<Words>* back = (TearState<Words>*)w->state->beginWrite();
+        for (int i = 0; i < Words; i++) back->words[i] = n;
+        w->state->endWrite();
+    }
+    return nullptr;
+}
+
+template <int Words>
+static bool run_tear_check() {
+    static LeafCANState<TearState<Words>> state;
+    static TearState<Words> snap;
+    TearWriter<Words> writer = { &state, false };
+    pthread_t thread;
+    pthread_create(&thread, nullptr, tear_writer_main<Words>, &writer);
+
+    uint32_t reads = 0, torn = 0, backwards = 0, last = 0;
+    uint32_t start = millis();
+    while (millis() - start < TEAR_MS) {
+        snap = state.read();
+        for (int i = 1; i < Words; i++) {
+            if (snap.words[i] != snap.words[0]) {
+                torn++;
+                break;
+            }
+        }
+        if (snap.words[0] < last) backwards++;
+        last = snap.words[0];
+        reads++;
+    }
+    writer.stop = true;
+    pthread_join(thread, nullptr);
+
+    printf("state:    %5u B, %u reads during %u updates, %u torn, %u out of order\n",
+           (unsigned)sizeof(TearState<Words>), reads, state.updateCount(), torn, backwards);
+    return torn == 0 && backwards == 0;
+}
+
+// A direct handler that answers each frame with send() (must not deadlock)
+#define REPLY_FRAMES    200
+
+static LeafCANBus* reply_bus;
+
+static void unpack_and_reply(const uint8_t* data, uint8_t len, void* state) {
+    unpack_gps_position(data, len, state);
+    reply_bus->send(CAN_ID_BODY_TEMP_SENSORS, data, 8);
+}
+
+static bool run_reply_check(const char* interface) {
+    static Counted replies;
+    replies.frames = 0;
+    LeafCANState<GPSPositionState> gps;
+
+    LeafCANBus requester, responder;
+    requester.begin(interface);
+    responder.begin(interface);
+    requester.subscribe(CAN_ID_BODY_TEMP_SENSORS, count_body_temp, &replies);
+    reply_bus = &responder;
+    responder.subscribeDirect(CAN_ID_GPS_POSITION, unpack_and_reply, gps);
+    requester.process();
+    responder.process();
+
+    uint8_t data[8] = { 0 };
+    for (int i = 0; i < REPLY_FRAMES; i++) {
+        requester.send(CAN_ID_GPS_POSITION, data, sizeof(data));
+        requester.process();
+    }
+    uint32_t start = millis();
+    while (replies.frames < REPLY_FRAMES && millis() - start < 500) {
+        requester.process();
+        delay(1);
+    }
+
+    printf("reply:    %u of %d frames answered from the direct handler\n", replies.frames, REPLY_FRAMES);
+    requester.end();
+    responder.end();
+    return replies.frames == REPLY_FRAMES;
+}
+
+static bool run_latency(const char* interface) {
+    bool ok = true;
+    const uint16_t depths[] = { 8, CAN_PORT_RX_QUEUE_LEN, 64 };
+    for (uint16_t depth : depths) {
+        ok = run_latency_depth(interface, depth) && ok;
+    }
+    ok = run_reply_check(interface) && ok;
+    ok = run_tear_check<16>() && ok;
+    return run_tear_check<4096>() && ok;
+}
+
+// ============================================================================
+// SCHEDULE: phased publishers driven by waitForNextPublish()
+// ============================================================================
+
+#define SCHEDULE_INTERVAL_MS 20
+#define SCHEDULE_MS          1000
+#define SCHEDULE_MIN_GAP_MS  4
+
+struct Arrivals {
+    uint32_t count;
+    uint32_t last_us;
+};
+
+static Arrivals arrivals;
+
+static void record_arrival(const uint8_t* data, uint8_t len, void* state) {
+    (void)data;
+    (void)len;
+    Arrivals* a = (Arrivals*)state;
+    a->count++;
+    a->last_us = micros();
+}
+
+static bool run_schedule(const char* interface) {
+    LeafCANBus tx;
+    LeafCANBus rx;
+    if (!tx.begin(interface) || !rx.begin(interface)) return false;
+
+    GPSPositionState position = {};
+    GPSVelocityState velocity = {};
+    BodyTempState temps = {};
+    const uint32_t ids[] = { CAN_ID_GPS_POSITION, CAN_ID_GPS_VELOCITY, CAN_ID_BODY_TEMP_SENSORS };
+    tx.publish(ids[0], SCHEDULE_INTERVAL_MS, pack_gps_position, &position);
+    tx.publish(ids[1], SCHEDULE_INTERVAL_MS, pack_gps_velocity, &velocity);
+    tx.publish(ids[2], SCHEDULE_INTERVAL_MS, pack_body_temp, &temps);
+    for (uint32_t id : ids) rx.subscribe(id, record_arrival, &arrivals);
+
+    // Closest spacing between frames from different publishers (0 = same process())
+    memset(&arrivals, 0, sizeof(arrivals));
+    uint32_t min_spacing_us = UINT32_MAX;
+    uint32_t start = millis();
+    while (millis() - start < SCHEDULE_MS) {
+        tx.waitForNextPublish(10);
+        uint32_t before = arrivals.count;
+        uint32_t previous_us = arrivals.last_us;
+        tx.process();
+        rx.process();
+        if (before > 0 && arrivals.count > before) {
+            uint32_t spacing = arrivals.count - before > 1 ? 0 : arrivals.last_us - previous_us;
+            if (spacing < min_spacing_us) min_spacing_us = spacing;
+        }
+    }
+
+    bool ok = true;
+    uint32_t phases[3];
+    uint32_t expected = SCHEDULE_MS / SCHEDULE_INTERVAL_MS;
+    printf("schedule: 3 publishers at %d ms for %d ms, waitForNextPublish() loop\n",
+           SCHEDULE_INTERVAL_MS, SCHEDULE_MS);
+    for (int i = 0; i < 3; i++) {
+        PublisherStats st;
+        if (!tx.getPublisherStats(ids[i], &st)) return false;
+        phases[i] = st.phase_ms;
+        printf("          0x%03X  phase %2u ms  sent %3u  missed %u  jitter mean %6.1f us  max %6u us\n",
+               (unsigned)ids[i], st.phase_ms, st.sent, st.missed,
+               st.sent ? (double)st.jitter_total_us / st.sent : 0.0, st.jitter_max_us);
+        ok = st.sent + 2 >= expected && st.sent <= expected + 1 && ok;
+    }
+    printf("          closest arrivals %.1f ms apart\n", min_spacing_us / 1000.0);
+
+    // Phases are chosen at publish(), independent of host load
+    for (int i = 0; i < 3; i++) {
+        for (int j = i + 1; j < 3; j++) {
+            uint32_t d = (phases[i] + SCHEDULE_INTERVAL_MS - phases[j]) % SCHEDULE_INTERVAL_MS;
+            if (SCHEDULE_INTERVAL_MS - d < d) d = SCHEDULE_INTERVAL_MS - d;
+            if (d < SCHEDULE_MIN_GAP_MS) {
+                printf("          phases of 0x%03X and 0x%03X only %u ms apart\n",
+                       (unsigned)ids[i], (unsigned)ids[j], d);
+                ok = false;
+            }
+        }
+    }
+
+    tx.end();
+    rx.end();
+    return ok;
+}
+
+// ============================================================================
+// ON-CHANGE: deadband + heartbeat publishers
+// ============================================================================
+
+#define ONCHANGE_CHECK_MS     10
+#define ONCHANGE_HEARTBEAT_MS 200
+#define ONCHANGE_MS           2000
+
+// Standard data frame incl. interframe space, without stuff bits
+static uint32_t frame_bits(uint8_t len) {
+    return 47 + 8 * len;
+}
+
+struct Received {
+    BodyTempState temps;
+    uint32_t frames;
+    uint32_t last_us;
+    uint32_t max_silence_us;
+};
+
+static void receive_temps(const uint8_t* data, uint8_t len, void* state) {
+    Received* r = (Received*)state;
+    uint32_t now = micros();
+    unpack_body_temp(data, len, &r->temps);
+    if (r->frames > 0 && now - r->last_us > r->max_silence_us) r->max_silence_us = now - r->last_us;
+    r->frames++;
+    r->last_us = now;
+}
+
+static int16_t max_error(const BodyTempState& a, const BodyTempState& b) {
+    int16_t e[4] = {
+        (int16_t)abs(a.temp1 - b.temp1), (int16_t)abs(a.temp2 - b.temp2),
+        (int16_t)abs(a.temp3 - b.temp3), (int16_t)abs(a.temp4 - b.temp4),
+    };
+    int16_t m = 0;
+    for (int16_t v : e) if (v > m) m = v;
+    return m;
+}
+
+static bool run_on_change(const char* interface) {
+    LeafCANBus tx;
+    LeafCANBus rx;
+    if (!tx.begin(interface) || !rx.begin(interface)) return false;
+
+    BodyTempState temps = { 200, 210, 220, 230 };
+    GPSTimeState time = { 2024, 6, 1, 12, 0, 0 };
+    Received received = {};
+    uint32_t time_frames = 0;
+    tx.publishOnChange(CAN_ID_BODY_TEMP_SENSORS, ONCHANGE_CHECK_MS, ONCHANGE_HEARTBEAT_MS,
+                       pack_body_temp, &temps, body_temp_changed);
+    tx.publishOnChange(CAN_ID_GPS_TIME, ONCHANGE_CHECK_MS, ONCHANGE_HEARTBEAT_MS * 5,
+                       pack_gps_time, &time);
+    rx.subscribe(CAN_ID_BODY_TEMP_SENSORS, receive_temps, &received);
+    rx.subscribe(CAN_ID_GPS_TIME, record_arrival, &arrivals);
+
+    // Temps: +0.1 °C every 50 ms on sensor 1, +-0.2 °C noise on all four
+    memset(&arrivals, 0, sizeof(arrivals));
+    srand(7);
+    int16_t worst_error = 0;
+    uint32_t start = millis();
+    uint32_t last_step = start;
+    int16_t base1 = temps.temp1;
+    while (millis() - start < ONCHANGE_MS) {
+        uint32_t now = millis();
+        if (now - last_step >= 50) {
+            last_step = now;
+            base1++;
+        }
+        temps.temp1 = base1 + rand() % 5 - 2;
+        temps.temp2 = 210 + rand() % 5 - 2;
+        temps.temp3 = 220 + rand() % 5 - 2;
+        temps.temp4 = 230 + rand() % 5 - 2;
+        time.second = (now - start) / 1000;
+
+        tx.waitForNextPublish(ONCHANGE_CHECK_MS);
+        tx.process();
+        rx.process();
+        if (received.frames > 0) {
+            int16_t e = max_error(temps, received.temps);
+            if (e > worst_error) worst_error = e;
+        }
+    }
+    time_frames = arrivals.count;
+
+    PublisherStats st_temp, st_time;
+    tx.getPublisherStats(CAN_ID_BODY_TEMP_SENSORS, &st_temp);
+    tx.getPublisherStats(CAN_ID_GPS_TIME, &st_time);
+
+    uint32_t checks = st_temp.sent + st_temp.suppressed + st_time.sent + st_time.suppressed;
+    uint32_t saved_bits = st_temp.suppressed * frame_bits(8) + st_time.suppressed * frame_bits(7);
+    uint32_t sent_bits = st_temp.sent * frame_bits(8) + st_time.sent * frame_bits(7);
+    double seconds = ONCHANGE_MS / 1000.0;
+    printf("onchange: check %d ms, heartbeat %d ms, %d ms\n",
+           ONCHANGE_CHECK_MS, ONCHANGE_HEARTBEAT_MS, ONCHANGE_MS);
+    printf("          body temp  sent %3u (%u heartbeats)  suppressed %3u  rx max error %d.%d C  max silence %.1f ms\n",
+           st_temp.sent, st_temp.heartbeats, st_temp.suppressed, worst_error / 10, worst_error % 10,
+           received.max_silence_us / 1000.0);
+    printf("          gps time   sent %3u (%u heartbeats)  suppressed %3u  received %u\n",
+           st_time.sent, st_time.heartbeats, st_time.suppressed, time_frames);
+    printf("          bus load %.2f%% vs %.2f%% periodic at %d kbit/s (%u of %u frames saved)\n",
+           100.0 * sent_bits / seconds / CAN_BITRATE,
+           100.0 * (sent_bits + saved_bits) / seconds / CAN_BITRATE, CAN_BITRATE / 1000,
+           tx.getSuppressedCount(), checks);
+
+    // Deadband (+ one ramp step and noise between checks) bounds the error;
+    // loaded hosts may stretch silence by a few checks
+    bool ok = st_temp.suppressed > st_temp.sent && st_time.sent >= 2;
+    ok = worst_error <= BODY_TEMP_DEADBAND + 4 && ok;
+    ok = received.max_silence_us <= (ONCHANGE_HEARTBEAT_MS + 5 * ONCHANGE_CHECK_MS) * 1000 && ok;
+    ok = received.frames == st_temp.sent && time_frames == st_time.sent && ok;
+
+    tx.end();
+    rx.end();
+    return ok;
+}
+
+// ============================================================================
+// ISO-TP: multi-frame transfers between two endpoints (+ kernel CAN_ISOTP)
+// ============================================================================
+
+#define ISOTP_REQ_ID     0x7E0
+#define ISOTP_RESP_ID    0x7E8
+#define ISOTP_BLOCK_SIZE 8
+#define ISOTP_BIG_LEN    10000
+#define ISOTP_ROUNDS     20
+#define ISOTP_RX_DEPTH   64
+
+struct IsoTpSink {
+    uint32_t messages;
+    uint32_t len;
+    uint32_t bad;           // Payload mismatches
+    uint32_t seed;          // Expected pattern
+};
+
+static void fill_pattern(uint8_t* buf, uint32_t len, uint32_t seed) {
+    for (uint32_t i = 0; i < len; i++) buf[i] = (uint8_t)(i * 31 + seed);
+}
+
+static void isotp_received(uint8_t* data, uint32_t len, void* context) {
+    IsoTpSink* sink = (IsoTpSink*)context;
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] != (uint8_t)(i * 31 + sink->seed)) {
+            sink->bad++;
+            break;
+        }
+    }
+    sink->messages++;
+    sink->len = len;
+}
+
+struct IsoTpNode {
+    LeafCANBus bus;
+    LeafCANIsoTp tp;
+    IsoTpSink sink;
+    uint8_t rx_buf[ISOTP_BIG_LEN];
+};
+
+static void isotp_step(IsoTpNode& a, IsoTpNode& b) {
+    a.bus.process();
+    a.tp.process();
+    b.bus.process();
+    b.tp.process();
+}
+
+// Send len bytes from -> to; true once delivered intact
+static bool isotp_transfer(IsoTpNode& from, IsoTpNode& to, const uint8_t* data, uint32_t len,
+                           uint32_t seed) {
+    uint32_t before = to.sink.messages;
+    to.sink.seed = seed;
+    if (!from.tp.send(data, len)) return false;
+    uint32_t start = millis();
+    while ((from.tp.txBusy() || to.sink.messages == before) && millis() - start < 2 * ISOTP_FC_TIMEOUT_MS) {
+        isotp_step(from, to);
+    }
+    return to.sink.messages == before + 1 && to.sink.len == len && to.sink.bad == 0;
+}
+
+struct KernelPeer {
+    int fd;
+    const uint8_t* send_data;
+    uint32_t send_len;
+    uint8_t recv_buf[ISOTP_MAX_12BIT_LEN];
+    ssize_t received;
+    bool sent;
+};
+
+static void* kernel_peer_main(void* arg) {
+    KernelPeer* k = (KernelPeer*)arg;
+    k->received = read(k->fd, k->recv_buf, sizeof(k->recv_buf));
+    k->sent = write(k->fd, k->send_data, k->send_len) == (ssize_t)k->send_len;
+    return nullptr;
+}
+
+// Our endpoint against the Linux CAN_ISOTP stack (default options: no
+// padding, BS 0, STmin 0 asked of us)
+static bool run_isotp_kernel(const char* interface, IsoTpNode& node, const uint8_t* data) {
+    int fd = socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
+    if (fd < 0) {
+        printf("          kernel CAN_ISOTP not available, interop skipped\n");
+        return true;
+    }
+    struct can_isotp_fc_options fc = { ISOTP_BLOCK_SIZE, 0, 0 };
+    setsockopt(fd, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fc, sizeof(fc));
+    struct timeval timeout = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = if_nametoindex(interface);
+    addr.can_addr.tp.tx_id = ISOTP_RESP_ID;     // Kernel plays the peer node
+    addr.can_addr.tp.rx_id = ISOTP_REQ_ID;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        printf("          kernel CAN_ISOTP bind failed, interop skipped\n");
+        close(fd);
+        return true;
+    }
+
+    KernelPeer k = { fd, data, ISOTP_MAX_12BIT_LEN, {}, -1, false };
+    pthread_t thread;
+    pthread_create(&thread, nullptr, kernel_peer_main, &k);
+
+    // We send first, then receive the kernel's copy back
+    uint32_t before = node.sink.messages;
+    node.sink.seed = 1;
+    bool ok = node.tp.send(data, ISOTP_MAX_12BIT_LEN);
+    uint32_t start = millis();
+    while (millis() - start < 3000 && (node.tp.txBusy() || node.sink.messages == before)) {
+        node.bus.process();
+        node.tp.process();
+    }
+    pthread_join(thread, nullptr);
+    close(fd);
+
+    ok = ok && k.received == ISOTP_MAX_12BIT_LEN && memcmp(k.recv_buf, data, ISOTP_MAX_12BIT_LEN) == 0;
+    ok = ok && k.sent && node.sink.messages == before + 1 && node.sink.bad == 0;
+    printf("          kernel CAN_ISOTP interop %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool run_isotp(const char* interface) {
+    static IsoTpNode a, b;
+    static uint8_t data[ISOTP_BIG_LEN];
+    if (!a.bus.begin(interface) || !b.bus.begin(interface, ISOTP_RX_DEPTH)) return false;
+
+    IsoTpConfig ca = { ISOTP_REQ_ID, ISOTP_RESP_ID, ISOTP_BLOCK_SIZE, 0, ISOTP_NO_PADDING };
+    IsoTpConfig cb = { ISOTP_RESP_ID, ISOTP_REQ_ID, ISOTP_BLOCK_SIZE, 0, ISOTP_NO_PADDING };
+    a.tp.begin(a.bus, ca);
+    b.tp.begin(b.bus, cb);
+    a.tp.setReceiveBuffer(a.rx_buf, sizeof(a.rx_buf), isotp_received, &a.sink);
+    b.tp.setReceiveBuffer(b.rx_buf, sizeof(b.rx_buf), isotp_received, &b.sink);
+    a.bus.process();    // Apply filters before traffic starts
+    b.bus.process();
+
+    bool ok = true;
+    uint32_t lens[] = { 5, 7, 8, 100, ISOTP_MAX_12BIT_LEN, ISOTP_BIG_LEN };
+    for (uint32_t len : lens) {
+        fill_pattern(data, len, len);
+        ok = isotp_transfer(a, b, data, len, len) && ok;
+        ok = isotp_transfer(b, a, data, len, len) && ok;
+    }
+    if (!ok) printf("FAIL: isotp transfer mismatch\n");
+
+    // Throughput: 4095-byte messages a -> b back to back
+    fill_pattern(data, ISOTP_MAX_12BIT_LEN, 3);
+    IsoTpStats sa0 = a.tp.getStats(), sb0 = b.tp.getStats();
+    double t0 = now_s();
+    bool stream_ok = true;
+    for (int i = 0; i < ISOTP_ROUNDS; i++) stream_ok = isotp_transfer(a, b, data, ISOTP_MAX_12BIT_LEN, 3) && stream_ok;
+    double elapsed = now_s() - t0;
+    IsoTpStats sa = a.tp.getStats(), sb = b.tp.getStats();
+    uint32_t data_frames = sa.frames_sent - sa0.frames_sent;
+    uint32_t fc_frames = sb.frames_sent - sb0.frames_sent;
+    ok = stream_ok && ok;
+
+    // Unpadded: FF 8 bytes, CFs 8 (last one shorter), FC 3 bytes
+    uint32_t per_msg = data_frames / ISOTP_ROUNDS;
+    uint32_t last_cf = 1 + (ISOTP_MAX_12BIT_LEN - 6) % 7;
+    uint64_t bits = (uint64_t)ISOTP_ROUNDS * ((per_msg - 1) * frame_bits(8) + frame_bits(last_cf))
+                  + (uint64_t)fc_frames * frame_bits(3);
+    double efficiency = 100.0 * ISOTP_ROUNDS * ISOTP_MAX_12BIT_LEN * 8 / (double)bits;
+    printf("isotp:    %d x %d bytes, BS %d: %.0f KB/s in process, %u data + %u FC frames/msg\n",
+           ISOTP_ROUNDS, ISOTP_MAX_12BIT_LEN, ISOTP_BLOCK_SIZE,
+           ISOTP_ROUNDS * ISOTP_MAX_12BIT_LEN / elapsed / 1024.0, per_msg, fc_frames / ISOTP_ROUNDS);
+    printf("          bus efficiency %.1f%% (raw 8-byte frames %.1f%%) -> %.1f KB/s payload at %d kbit/s\n",
+           efficiency, 100.0 * 64 / frame_bits(8), CAN_BITRATE * efficiency / 100.0 / 8 / 1024.0,
+           CAN_BITRATE / 1000);
+
+    // Receive buffer too small: sender must see FC overflow, not hang
+    uint32_t overflows = sa.overflows;
+    b.tp.setReceiveBuffer(b.rx_buf, 64, isotp_received, &b.sink);
+    ok = a.tp.send(data, 100) && ok;
+    for (int i = 0; i < 10 && a.tp.txBusy(); i++) isotp_step(a, b);
+    bool overflow_ok = !a.tp.txBusy() && a.tp.getStats().overflows == overflows + 1;
+    printf("          small buffer: %s\n", overflow_ok ? "FC overflow" : "FAILED");
+    b.tp.setReceiveBuffer(b.rx_buf, sizeof(b.rx_buf), isotp_received, &b.sink);
+    ok = overflow_ok && ok;
+
+    IsoTpStats s = a.tp.getStats();
+    ok = s.timeouts == 0 && s.sequence_errors == 0 && b.tp.getStats().sequence_errors == 0 && ok;
+
+    // On SocketCAN the kernel stack takes b's place
+    b.bus.end();
+    if (strcmp(interface, CAN_PORT_LOOPBACK) != 0) {
+        fill_pattern(data, ISOTP_MAX_12BIT_LEN, 1);
+        ok = run_isotp_kernel(interface, a, data) && ok;
+    }
+    a.bus.end();
+    return ok;
+}
+
+// ============================================================================
+// TIME SYNC: offset/drift estimation + origin timestamps across nodes
+// ============================================================================
+
+#define SYNC_SIM_SAMPLES    120
+#define SYNC_SIM_DRIFT_PPB  50000       // Master runs 50 ppm fast
+#define SYNC_SIM_JITTER_US  20          // RX stamp error, +-
+#define SYNC_INTERVAL_MS    20
+#define SYNC_RUN_MS         400
+#define SYNC_ORIGIN_ID      0x7F0       // Bench frame: origin timestamp in bytes 0-3
+
+static bool run_time_sync_sim() {
+    LeafCANTimeSync sync;
+    const int64_t offset_us = 1234567890;
+    auto master_at = [&](uint64_t local_us) {
+        return (uint64_t)(local_us + offset_us + (int64_t)local_us * SYNC_SIM_DRIFT_PPB / 1000000000);
+    };
+
+    srand(11);
+    uint64_t local = 5000000;
+    int64_t worst = 0;
+    uint32_t missed = 0;
+    for (int i = 0; i < SYNC_SIM_SAMPLES; i++, local += 1000000) {
+        uint64_t rx = local + rand() % (2 * SYNC_SIM_JITTER_US + 1) - SYNC_SIM_JITTER_US;
+        sync.onSync((uint8_t)i, rx);
+        if (i % 10 == 9) {
+            missed++;       // Follow-up lost
+            continue;
+        }
+        sync.onFollowUp((uint8_t)i, master_at(local), i * 1000);
+
+        // Settled: check the clock half an interval after the sample
+        if (i >= 20) {
+            uint64_t t = local + 500000;
+            int64_t e = (int64_t)(sync.toMaster(t) - master_at(t));
+            if (e < 0) e = -e;
+            if (e > worst) worst = e;
+        }
+    }
+
+    CANTimeSyncStats st;
+    sync.snapshot(&st, SYNC_SIM_SAMPLES * 1000);
+    double drift_error_ppm = (st.drift_ppb - SYNC_SIM_DRIFT_PPB) / 1000.0;
+    printf("timesync: simulated 50 ppm, +-%d us jitter: error max %lld us, drift %.2f ppm (%+.2f), "
+           "%u samples, %u missed, %u step\n",
+           SYNC_SIM_JITTER_US, (long long)worst, st.drift_ppb / 1000.0, drift_error_ppm,
+           st.samples, st.missed, st.steps);
+
+    // The last lost follow-up only counts once the next sync arrives
+    bool ok = st.synced && st.steps == 1 && st.missed == missed - 1;
+    ok = worst <= 2 * SYNC_SIM_JITTER_US && ok;
+    ok = drift_error_ppm > -5.0 && drift_error_ppm < 5.0 && ok;
+    return ok;
+}
+
+struct OriginAges {
+    LeafCANBus* bus;
+    uint32_t frames;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+static void record_origin(const uint8_t* data, uint8_t len, void* state) {
+    OriginAges* a = (OriginAges*)state;
+    if (len < 4) return;
+    uint32_t origin = (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+    uint32_t age = a->bus->originAgeUs(origin);
+    a->frames++;
+    a->total_us += age;
+    if (age > a->max_us) a->max_us = age;
+}
+
+static bool run_time_sync(const char* interface) {
+    bool ok = run_time_sync_sim();
+
+    LeafCANBus master;
+    LeafCANBus follower;
+    if (!master.begin(interface) || !follower.begin(interface)) return false;
+    OriginAges ages = { &follower, 0, 0, 0 };
+    master.beginTimeMaster(SYNC_INTERVAL_MS);
+    follower.followTimeSync();
+    follower.subscribe(SYNC_ORIGIN_ID, record_origin, &ages);
+    follower.process();     // Apply the filter before traffic starts
+
+    // Master: origin-stamped frame every 5 ms; follower's loop lags behind
+    uint32_t start = millis();
+    uint32_t last_frame = start;
+    uint32_t sent = 0;
+    while (millis() - start < SYNC_RUN_MS) {
+        master.process();
+        if (follower.isTimeSynced() && millis() - last_frame >= 5) {
+            last_frame = millis();
+            uint32_t origin = (uint32_t)master.syncedMicros();
+            uint8_t data[4] = { (uint8_t)origin, (uint8_t)(origin >> 8), (uint8_t)(origin >> 16),
+                                (uint8_t)(origin >> 24) };
+            if (master.send(SYNC_ORIGIN_ID, data, sizeof(data))) sent++;
+        }
+        delay(1);
+        follower.process();
+    }
+
+    CANTimeSyncStats st = follower.getTimeSyncStats();
+    uint64_t diff = master.syncedMicros();
+    diff = follower.syncedMicros() - diff;
+    printf("          %s: %u syncs, follower error max %u us, offset %lld us, drift %.2f ppm\n",
+           interface, st.samples, st.error_max_us, (long long)st.offset_us, st.drift_ppb / 1000.0);
+    printf("          origin timestamps: %u frames, age mean %.0f us, max %u us\n",
+           ages.frames, ages.frames ? (double)ages.total_us / ages.frames : 0.0, ages.max_us);
+
+    // Same host clock on both sides: the estimate must land within the
+    // RX stamp delay, and every age must be positive and below one loop
+    ok = st.synced && st.samples >= SYNC_RUN_MS / SYNC_INTERVAL_MS / 2 && ok;
+    ok = (int64_t)diff > -1000 && (int64_t)diff < 1000 && ok;
+    ok = ages.frames == sent && sent > 0 && ages.max_us < 20000 && ok;
+
+    master.end();
+    follower.end();
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    bool check = false;
+    const char* interface = CAN_PORT_LOOPBACK;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) check = true;
+        else interface = argv[i];
+    }
+
+    LeafCANBus tx;
+    LeafCANBus rx;
+    if (!tx.begin(interface) || !rx.begin(interface)) {
+        printf("Could not open %s\n", interface);
+        return 1;
+    }
+
+    for (int i = 0; i < STREAM_COUNT; i++) {
+        rx.subscribe(streams[i].can_id, streams[i].unpack, &streams[i].counted);
+    }
+
+    double fps = 0.0;
+    bool ok = run_burst(tx, rx, &fps);
+    ok = run_publish(tx, rx) && ok;
+    ok = run_tx_queue() && ok;
+    ok = run_health() && ok;
+    ok = run_dispatch() && ok;
+    ok = run_filter(tx, rx) && ok;
+
+    tx.end();
+    rx.end();
+
+    ok = run_latency(interface) && ok;
+    ok = run_schedule(interface) && ok;
+    ok = run_on_change(interface) && ok;
+    ok = run_isotp(interface) && ok;
+    ok = run_time_sync(interface) && ok;
+
+    if (check) {
+        if (fps < CHECK_MIN_FPS) {
+            printf("FAIL: %.0f frames/s below %.0f\n", fps, CHECK_MIN_FPS);
+            ok = false;
+        }
+        printf("%s\n", ok ? "PASS" : "FAIL");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,471 @@
+/**
+ * LeafCANMessages round-trip checker and throughput benchmark (host only)
+ *
+ * Round-trip: for every codec, every signal is swept over its full raw range
+ * (exhaustively up to 16 bits, strided + edges for 32-bit signals) with the
+ * remaining bytes randomized, and the frame must survive unpack -> pack
+ * bit-for-bit on the bytes the codec defines. The DLC produced by pack must
+ * match the wire DLC.
+ *
+ * Registry: LeafCANRegistry's table must be sorted, every signal must fit
+ * in 8 bytes, and every codec here must be registered with the same DLC.
+ *
+ * Bulk: leafcan_encode_bulk() must reproduce random frames from their
+ * leafcan_decode() values for every registered message.
+ *
+ * Benchmark: ns/frame for pack and unpack of each codec, plus bulk encode
+ * throughput per registered message.
+ *
+ * Usage:
+ *   leafcanmsgs_bench                     round-trip + benchmark
+ *   leafcanmsgs_bench --check             round-trip only
+ *   leafcanmsgs_bench --save base.txt     write ns/frame results
+ *   leafcanmsgs_bench --baseline base.txt compare; exit 1 on >15% regression
+ */
+
+#include "LeafCANMessages.h"
+#include "LeafCANRegistry.h"
+#include "LeafCANBulk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <map>
+#include <vector>
+
+// Same signatures as LeafCANBus.h callbacks (that header needs Arduino)
+typedef void (*can_unpack_fn)(const uint8_t* data, uint8_t len, void* state);
+typedef void (*can_pack_fn)(const void* state, uint8_t* data, uint8_t* len);
+
+// Raw signal location inside the frame (little-endian assembly of `bytes`
+// bytes starting at `offset`; `mask` selects the bits the codec owns)
+struct SignalDef {
+    uint8_t offset;
+    uint8_t bytes;
+    uint32_t mask;
+    uint32_t max_raw;   // Sweep upper bound (inclusive); 0 = full range
+};
+
+struct CodecDef {
+    const char* name;
+    uint32_t can_id;
+    uint8_t dlc;
+    can_unpack_fn unpack;
+    can_pack_fn pack;
+    SignalDef signals[8];
+    uint8_t signal_count;
+};
+
+#define SIG(off, n, m)        { off, n, m, 0 }
+#define SIG_MAX(off, n, m, x) { off, n, m, x }
+
+static const CodecDef CODECS[] = {
+    { "inverter_telemetry", 0x1F2, 8, unpack_inverter_telemetry, pack_inverter_telemetry,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 1, 0xFF), SIG(5, 1, 0xFF), SIG(6, 1, 0xFF) }, 5 },
+    { "battery_soc", 0x1DB, 8, unpack_battery_soc, pack_battery_soc,
+      { SIG(0, 1, 0xFE), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "battery_temp", 0x1DC, 8, unpack_battery_temp, pack_battery_temp,
+      { SIG(0, 1, 0xFF), SIG(1, 1, 0xFF), SIG(2, 1, 0xFF), SIG(3, 1, 0xFF) }, 4 },
+    { "vehicle_speed", 0x1D4, 2, unpack_vehicle_speed, pack_vehicle_speed,
+      { SIG(0, 2, 0xFFFF) }, 1 },
+    { "motor_rpm", 0x1DA, 3, unpack_motor_rpm, pack_motor_rpm,
+      { SIG(0, 2, 0xFFFF), SIG(2, 1, 0xFF) }, 2 },
+    { "charger_status", 0x390, 8, unpack_charger_status, pack_charger_status,
+      { SIG(0, 1, 0x01), SIG(1, 1, 0xFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF) }, 4 },
+    { "gps_position", 0x710, 8, unpack_gps_position, pack_gps_position,
+      { SIG(0, 4, 0xFFFFFFFF), SIG(4, 2, 0xFFFF), SIG(6, 1, 0xFF), SIG(7, 1, 0xFF) }, 4 },
+    { "gps_velocity", 0x711, 8, unpack_gps_velocity, pack_gps_velocity,
+      { SIG(0, 4, 0xFFFFFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 3 },
+    { "gps_time", 0x712, 7, unpack_gps_time, pack_gps_time,
+      { SIG(0, 2, 0xFFFF), SIG(2, 1, 0xFF), SIG(3, 1, 0xFF), SIG(4, 1, 0xFF), SIG(5, 1, 0xFF), SIG(6, 1, 0xFF) }, 6 },
+    { "body_temp", 0x720, 8, unpack_body_temp, pack_body_temp,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "body_voltage", 0x721, 6, unpack_body_voltage, pack_body_voltage,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF) }, 3 },
+#ifdef EMBOO_BATTERY
+    { "emboo_pack_status", 0x6B0, 8, unpack_emboo_pack_status, pack_emboo_pack_status,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 1, 0xFF) }, 4 },
+    { "emboo_pack_stats", 0x6B1, 8, unpack_emboo_pack_stats, pack_emboo_pack_stats,
+      { SIG(0, 2, 0xFFFF), SIG(2, 1, 0xFF), SIG(3, 2, 0xFFFF), SIG(5, 2, 0xFFFF) }, 4 },
+    { "emboo_status_flags", 0x6B2, 8, unpack_emboo_status_flags, pack_emboo_status_flags,
+      { SIG(0, 1, 0xFF), SIG(3, 1, 0xFF) }, 2 },
+    { "emboo_cell_voltage", 0x6B3, 8, unpack_emboo_cell_voltage, pack_emboo_cell_voltage,
+      { SIG_MAX(0, 1, 0xFF, 100), SIG(1, 2, 0xFFFF), SIG(3, 2, 0xFFFF), SIG(5, 2, 0xFFFF) }, 4 },
+    { "emboo_temperatures", 0x6B4, 8, unpack_emboo_temperatures, pack_emboo_temperatures,
+      { SIG(2, 1, 0xFF), SIG(3, 1, 0xFF), SIG(4, 1, 0xFF) }, 3 },
+    { "emboo_pack_summary", 0x351, 8, unpack_emboo_pack_summary, pack_emboo_pack_summary,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "emboo_pack_data1", 0x355, 6, unpack_emboo_pack_data1, pack_emboo_pack_data1,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF) }, 3 },
+    { "emboo_pack_data2", 0x356, 6, unpack_emboo_pack_data2, pack_emboo_pack_data2,
+      { SIG(0, 2, 0xFFFF), SIG(4, 2, 0xFFFF) }, 2 },
+#endif
+#ifdef ROAM_MOTOR
+    { "roam_motor_torque", 0x0AC, 4, unpack_roam_motor_torque, pack_roam_motor_torque,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF) }, 2 },
+    { "roam_motor_position", 0x0A5, 8, unpack_roam_motor_position, pack_roam_motor_position,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "roam_motor_voltage", 0x0A7, 8, unpack_roam_motor_voltage, pack_roam_motor_voltage,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "roam_motor_current", 0x0A6, 8, unpack_roam_motor_current, pack_roam_motor_current,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "roam_motor_temp1", 0x0A0, 8, unpack_roam_motor_temp1, pack_roam_motor_temp1,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "roam_motor_temp2", 0x0A1, 8, unpack_roam_motor_temp2, pack_roam_motor_temp2,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+    { "roam_motor_temp3", 0x0A2, 8, unpack_roam_motor_temp3, pack_roam_motor_temp3,
+      { SIG(0, 2, 0xFFFF), SIG(2, 2, 0xFFFF), SIG(4, 2, 0xFFFF), SIG(6, 2, 0xFFFF) }, 4 },
+#endif
+};
+
+static const size_t CODEC_COUNT = sizeof(CODECS) / sizeof(CODECS[0]);
+
+// Large enough for every *State struct in LeafCANMessages.h
+union AnyState {
+    uint8_t bytes[64];
+    double align;
+};
+
+// Deterministic xorshift so failures reproduce
+static uint32_t rng_state = 0x12345678;
+static uint32_t next_rand() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void write_raw(uint8_t* data, const SignalDef& sig, uint32_t raw) {
+    for (uint8_t b = 0; b < sig.bytes; b++) {
+        uint8_t m = (sig.mask >> (8 * b)) & 0xFF;
+        uint8_t v = (raw >> (8 * b)) & 0xFF;
+        data[sig.offset + b] = (data[sig.offset + b] & ~m) | (v & m);
+    }
+}
+
+// Byte-wise mask of every bit the codec owns
+static void codec_mask(const CodecDef& c, uint8_t* mask) {
+    memset(mask, 0, 8);
+    for (uint8_t i = 0; i < c.signal_count; i++) {
+        const SignalDef& sig = c.signals[i];
+        for (uint8_t b = 0; b < sig.bytes; b++) {
+            mask[sig.offset + b] |= (sig.mask >> (8 * b)) & 0xFF;
+        }
+    }
+}
+
+// Keep constrained signals (e.g. cell_id <= 100) inside their domain
+static void clamp_constrained(const CodecDef& c, uint8_t* data) {
+    for (uint8_t i = 0; i < c.signal_count; i++) {
+        const SignalDef& sig = c.signals[i];
+        if (sig.max_raw && sig.bytes == 1 && data[sig.offset] > sig.max_raw) {
+            data[sig.offset] = data[sig.offset] % (sig.max_raw + 1);
+        }
+    }
+}
+
+static bool round_trip_one(const CodecDef& c, const uint8_t* frame, const uint8_t* mask,
+                           uint8_t sig_index, uint32_t raw) {
+    AnyState state;
+    memset(&state, 0, sizeof(state));
+    c.unpack(frame, c.dlc, &state);
+
+    uint8_t out[8];
+    uint8_t len = 0;
+    c.pack(&state, out, &len);
+
+    if (len != c.dlc) {
+        printf("FAIL %-22s DLC %u, expected %u\n", c.name, len, c.dlc);
+        return false;
+    }
+    for (uint8_t b = 0; b < 8; b++) {
+        if ((frame[b] & mask[b]) != (out[b] & mask[b])) {
+            printf("FAIL %-22s signal %u raw 0x%X: byte %u in 0x%02X out 0x%02X\n",
+                   c.name, sig_index, raw, b, frame[b] & mask[b], out[b] & mask[b]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool check_codec(const CodecDef& c, uint32_t* frames_checked) {
+    uint8_t mask[8];
+    codec_mask(c, mask);
+
+    for (uint8_t i = 0; i < c.signal_count; i++) {
+        const SignalDef& sig = c.signals[i];
+        uint64_t full = (sig.bytes >= 4) ? 0x100000000ULL : (1ULL << (8 * sig.bytes));
+        uint64_t limit = sig.max_raw ? (uint64_t)sig.max_raw + 1 : full;
+        // 32-bit signals: 2^20 strided samples plus the extremes
+        uint64_t step = (limit > (1ULL << 20)) ? (limit >> 20) : 1;
+
+        for (uint64_t raw = 0; raw < limit + step; raw += step) {
+            uint32_t v = (uint32_t)((raw >= limit) ? limit - 1 : raw);
+            uint8_t frame[8];
+            for (uint8_t b = 0; b < 8; b++) frame[b] = next_rand() & 0xFF;
+            clamp_constrained(c, frame);
+            write_raw(frame, sig, v);
+
+            if (!round_trip_one(c, frame, mask, i, v)) return false;
+            (*frames_checked)++;
+            if (raw >= limit) break;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// REGISTRY CONSISTENCY
+// ============================================================================
+
+static int check_registry() {
+    int failures = 0;
+    size_t count = leafcan_message_count();
+    for (size_t i = 0; i < count; i++) {
+        const leafcan_message_t* m = leafcan_message_at(i);
+        if (i > 0 && leafcan_message_at(i - 1)->can_id >= m->can_id) {
+            printf("  FAIL registry not sorted at 0x%X\n", m->can_id);
+            failures++;
+        }
+        if (m->signal_count > LEAFCAN_MAX_SIGNALS || m->min_len > m->dlc) {
+            printf("  FAIL registry 0x%X: bad signal_count/min_len\n", m->can_id);
+            failures++;
+        }
+        for (uint8_t s = 0; s < m->signal_count; s++) {
+            const leafcan_signal_t& sig = m->signals[s];
+            if (sig.start_byte + sig.length > 8 || (sig.length != 1 && sig.length != 2 && sig.length != 4)) {
+                printf("  FAIL registry 0x%X.%s: bad location\n", m->can_id, sig.name);
+                failures++;
+            }
+        }
+    }
+    for (size_t i = 0; i < CODEC_COUNT; i++) {
+        const leafcan_message_t* m = leafcan_find(CODECS[i].can_id);
+        if (!m || m->dlc != CODECS[i].dlc) {
+            printf("  FAIL registry missing %s (0x%X) or DLC differs\n", CODECS[i].name, CODECS[i].can_id);
+            failures++;
+        }
+    }
+    printf("[registry] %zu messages, %d failing\n", count, failures);
+    return failures;
+}
+
+// ============================================================================
+// BULK ENCODE
+// ============================================================================
+
+// Bits of the payload (as a little-endian uint64) owned by any signal
+static uint64_t message_coverage(const leafcan_message_t* m) {
+    uint64_t cov = 0;
+    for (uint8_t s = 0; s < m->signal_count; s++) {
+        const leafcan_signal_t& sig = m->signals[s];
+        for (uint8_t b = 0; b < sig.length; b++) {
+            // Byte b of the raw value (LSB first) lands at start_byte + b, mirrored for BE
+            uint8_t pos = (sig.flags & LEAFCAN_SIG_BIG_ENDIAN) ? sig.start_byte + sig.length - 1 - b
+                                                             : sig.start_byte + b;
+            cov |= (uint64_t)((sig.mask >> (8 * b)) & 0xFF) << (8 * pos);
+        }
+    }
+    return cov;
+}
+
+// Random frames for one message plus their decoded values, column-major
+struct BulkInput {
+    std::vector<uint64_t> payloads;
+    std::vector<double> columns[LEAFCAN_MAX_SIGNALS];
+    std::vector<uint64_t> timestamps;
+    const double* column_ptrs[LEAFCAN_MAX_SIGNALS];
+};
+
+static void make_bulk_input(const leafcan_message_t* m, size_t n, BulkInput& in) {
+    uint64_t cov = message_coverage(m);
+    in.payloads.resize(n);
+    in.timestamps.resize(n);
+    for (uint8_t s = 0; s < LEAFCAN_MAX_SIGNALS; s++) {
+        in.columns[s].resize(s < m->signal_count ? n : 0);
+        in.column_ptrs[s] = in.columns[s].data();
+    }
+    for (size_t i = 0; i < n; i++) {
+        uint64_t p = ((uint64_t)next_rand() << 32 | next_rand()) & cov;
+        uint8_t data[8];
+        memcpy(data, &p, 8);
+        double values[LEAFCAN_MAX_SIGNALS];
+        leafcan_decode(m->can_id, data, 8, values, LEAFCAN_MAX_SIGNALS);
+        for (uint8_t s = 0; s < m->signal_count; s++) in.columns[s][i] = values[s];
+        in.payloads[i] = p;
+        in.timestamps[i] = i * 10000;   // 100 Hz
+    }
+}
+
+static int check_bulk() {
+    int failures = 0;
+    const size_t n = 4096;
+    std::vector<leafcan_frame_t> frames(n);
+    for (size_t m = 0; m < leafcan_message_count(); m++) {
+        const leafcan_message_t* msg = leafcan_message_at(m);
+        BulkInput in;
+        make_bulk_input(msg, n, in);
+        leafcan_encode_bulk(msg->can_id, in.column_ptrs, in.timestamps.data(), n, frames.data());
+
+        for (size_t i = 0; i < n; i++) {
+            uint64_t got;
+            memcpy(&got, frames[i].data, 8);
+            if (got != in.payloads[i] || frames[i].len != msg->dlc ||
+                frames[i].timestamp_us != in.timestamps[i]) {
+                printf("  FAIL bulk %s: frame %zu %016llX -> %016llX\n", msg->name, i,
+                       (unsigned long long)in.payloads[i], (unsigned long long)got);
+                failures++;
+                break;
+            }
+        }
+    }
+    printf("[bulk] %zu messages, %d failing\n", leafcan_message_count(), failures);
+    return failures;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+static volatile uint8_t sink;
+
+static double bench_bulk_ns(const leafcan_message_t* msg, size_t n, int repeats) {
+    BulkInput in;
+    make_bulk_input(msg, n, in);
+    std::vector<leafcan_frame_t> frames(n);
+
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        auto t0 = std::chrono::steady_clock::now();
+        leafcan_encode_bulk(msg->can_id, in.column_ptrs, in.timestamps.data(), n, frames.data());
+        auto t1 = std::chrono::steady_clock::now();
+        sink = frames[r & (n - 1)].data[r & 7];
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+static double bench_ns(const CodecDef& c, bool pack_side, uint32_t iterations) {
+    uint8_t frames[64][8];
+    for (int f = 0; f < 64; f++) {
+        for (int b = 0; b < 8; b++) frames[f][b] = next_rand() & 0xFF;
+        clamp_constrained(c, frames[f]);
+    }
+    AnyState states[64];
+    memset(states, 0, sizeof(states));
+    for (int f = 0; f < 64; f++) c.unpack(frames[f], c.dlc, &states[f]);
+
+    uint8_t out[8];
+    uint8_t len = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    if (pack_side) {
+        for (uint32_t n = 0; n < iterations; n++) {
+            c.pack(&states[n & 63], out, &len);
+            sink = out[n & 7];
+        }
+    } else {
+        for (uint32_t n = 0; n < iterations; n++) {
+            c.unpack(frames[n & 63], c.dlc, &states[n & 63]);
+            sink = states[n & 63].bytes[n & 7];
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+static std::map<std::string, double> load_baseline(const char* path) {
+    std::map<std::string, double> result;
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[bench] Cannot open baseline %s\n", path);
+        return result;
+    }
+    char key[96];
+    double ns;
+    while (fscanf(f, "%95s %lf", key, &ns) == 2) {
+        result[key] = ns;
+    }
+    fclose(f);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    bool check_only = false;
+    const char* save_path = nullptr;
+    const char* baseline_path = nullptr;
+    uint32_t iterations = 2000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--check")) check_only = true;
+        else if (!strcmp(argv[i], "--save") && i + 1 < argc) save_path = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc) baseline_path = argv[++i];
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--check] [--save file] [--baseline file] [--iterations n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // ---- Round-trip ----
+    int failures = 0;
+    uint32_t frames_checked = 0;
+    for (size_t i = 0; i < CODEC_COUNT; i++) {
+        if (!check_codec(CODECS[i], &frames_checked)) failures++;
+    }
+    printf("[roundtrip] %zu codecs, %u frames, %d failing\n", CODEC_COUNT, frames_checked, failures);
+    failures += check_registry();
+    failures += check_bulk();
+    if (check_only || failures) return failures ? 1 : 0;
+
+    // ---- Throughput ----
+    std::map<std::string, double> baseline;
+    if (baseline_path) baseline = load_baseline(baseline_path);
+    FILE* save = save_path ? fopen(save_path, "w") : nullptr;
+
+    int regressions = 0;
+    printf("\n%-22s %5s %12s %12s %12s\n", "codec", "id", "pack ns", "unpack ns", "Mframes/s");
+    for (size_t i = 0; i < CODEC_COUNT; i++) {
+        const CodecDef& c = CODECS[i];
+        double pack_ns = bench_ns(c, true, iterations);
+        double unpack_ns = bench_ns(c, false, iterations);
+        printf("%-22s 0x%03X %12.2f %12.2f %12.1f", c.name, c.can_id, pack_ns, unpack_ns,
+               1000.0 / (pack_ns + unpack_ns));
+
+        const struct { const char* side; double ns; } results[] = { { "pack", pack_ns }, { "unpack", unpack_ns } };
+        for (const auto& r : results) {
+            std::string key = std::string(c.name) + "." + r.side;
+            if (save) fprintf(save, "%s %.3f\n", key.c_str(), r.ns);
+            auto it = baseline.find(key);
+            if (it != baseline.end() && r.ns > it->second * 1.15) {
+                printf("  REGRESSION %s %.2f -> %.2f ns/frame", r.side, it->second, r.ns);
+                regressions++;
+            }
+        }
+        printf("\n");
+    }
+
+    // Bulk encoder: 64K-frame batches (working set ~2.5 MB), best of 5
+    printf("\n%-22s %10s %12s %12s\n", "bulk message", "id", "ns/frame", "Mframes/s");
+    for (size_t m = 0; m < leafcan_message_count(); m++) {
+        const leafcan_message_t* msg = leafcan_message_at(m);
+        double ns = bench_bulk_ns(msg, 65536, 5);
+        printf("%-22s 0x%08X %12.2f %12.1f", msg->name, msg->can_id, ns, 1000.0 / ns);
+
+        std::string key = std::string("bulk.") + msg->name;
+        if (save) fprintf(save, "%s %.3f\n", key.c_str(), ns);
+        auto it = baseline.find(key);
+        if (it != baseline.end() && ns > it->second * 1.15) {
+            printf("  REGRESSION %.2f -> %.2f ns/frame", it->second, ns);
+            regressions++;
+        }
+        printf("\n");
+    }
+    if (save) fclose(save);
+
+    if (baseline_path) {
+        printf("\n[bench] %d regression(s) vs %s\n", regressions, baseline_path);
+    }
+    return regressions ? 1 : 0;
+}
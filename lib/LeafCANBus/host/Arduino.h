@@ -0,0 +1,63 @@
+#ifndef LEAFCAN_HOST_ARDUINO_H
+#define LEAFCAN_HOST_ARDUINO_H
+
+// ============================================================================
+// Minimal Arduino core for host (Linux) builds of LeafCANBus
+// ============================================================================
+// Covers what LeafCANBus and the CAN side of the module sketches use:
+// millis()/micros() on CLOCK_MONOTONIC, delay(), and Serial on stdout.
+// Sensor drivers (TinyGPSPlus, HardwareSerial, Wire, ...) stay ESP32-only.
+// Put lib/LeafCANBus/host on the include path ahead of any real core.
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+inline uint64_t host_monotonic_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+// Like the ESP32 core: time since first use, wrapping at 32 bits
+inline uint32_t micros() {
+    static const uint64_t start = host_monotonic_us();
+    return (uint32_t)(host_monotonic_us() - start);
+}
+
+inline uint32_t millis() {
+    static const uint64_t start = host_monotonic_us();
+    return (uint32_t)((host_monotonic_us() - start) / 1000);
+}
+
+inline void delayMicroseconds(uint32_t us) {
+    struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, nullptr);
+}
+
+inline void delay(uint32_t ms) {
+    delayMicroseconds(ms * 1000);
+}
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+
+    int printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, fmt);
+        int n = vprintf(fmt, args);
+        va_end(args);
+        return n;
+    }
+
+    void print(const char* s) { fputs(s, stdout); }
+    void println(const char* s = "") { puts(s); }
+    void println(int v) { ::printf("%d\n", v); }
+};
+
+inline HostSerial Serial;
+
+#endif // LEAFCAN_HOST_ARDUINO_H
@@ -0,0 +1,134 @@
+#include "LeafCANBulk.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "LeafCANBulk assembles payloads as little-endian uint64 lanes"
+#endif
+
+// Frames are encoded in blocks so one block of payload lanes stays in L1
+#define BULK_BLOCK 256
+
+// ============================================================================
+// COLUMN ENCODERS
+// ============================================================================
+// One loop per (length, byte order) so the body is branch-free. Rounding
+// matches lroundf/llround in the pack_* functions: half away from zero.
+// Inputs are first clamped so the raw value stays inside int32 (the cast is
+// undefined beyond it; NaN takes the upper bound). Within that, values too
+// large for the signal wrap to its width like the pack_* casts do.
+
+// Plain shifts rather than compiler builtins (MSVC builds this for the
+// simulator); GCC/Clang still lower them to vector byte shuffles.
+template <int LENGTH, bool SWAP>
+static inline uint32_t place_raw(uint32_t raw) {
+    if (!SWAP || LENGTH == 1) return raw;
+    if (LENGTH == 2) return ((raw & 0xFF) << 8) | ((raw >> 8) & 0xFF);
+    return (raw << 24) | ((raw & 0xFF00) << 8) | ((raw >> 8) & 0xFF00) | (raw >> 24);
+}
+
+// Physical values that encode to raw_min .. raw_max. Clamping the input
+// rather than the raw value keeps the compares as max/min instructions (a
+// constant raw bound is one the compiler turns into branches).
+struct InputRange {
+    double lo, hi;
+};
+
+static inline InputRange input_range(const leafcan_signal_t* sig, double raw_min, double raw_max) {
+    double a = sig->offset + raw_min * sig->scale;
+    double b = sig->offset + raw_max * sig->scale;
+    return a < b ? InputRange{ a, b } : InputRange{ b, a };
+}
+
+static inline double clamp_input(double x, const InputRange& r) {
+    x = x < r.lo ? r.lo : x;
+    return x < r.hi ? x : r.hi;
+}
+
+// 1- and 2-byte signals: float math, same as pack_* (value / scale in float).
+// Clamped at raw +-1e9: float rounding stays well inside int32, and that is
+// far beyond any 1- or 2-byte value.
+template <int LENGTH, bool SWAP>
+static void encode_column_f32(const leafcan_signal_t* sig, const double* __restrict x,
+                              size_t n, uint64_t* __restrict payload) {
+    const InputRange range = input_range(sig, -1e9, 1e9);
+    const float scale = (float)sig->scale;
+    const float offset = (float)sig->offset;
+    const uint32_t shift = sig->shift;
+    const uint32_t mask = sig->mask;
+    const uint32_t bit = sig->start_byte * 8;
+
+    for (size_t i = 0; i < n; i++) {
+        float v = ((float)clamp_input(x[i], range) - offset) / scale;
+        uint32_t raw = (uint32_t)(int32_t)(v + copysignf(0.5f, v));
+        raw = (raw << shift) & mask;
+        payload[i] |= (uint64_t)place_raw<LENGTH, SWAP>(raw) << bit;
+    }
+}
+
+// 4-byte signals (GPS lat/lon at 1e-7 deg): float has too few mantissa bits.
+// Converts through int32 (all registered 4-byte signals are signed) since
+// SSE2/NEON have no vector double -> int64 conversion.
+template <bool SWAP>
+static void encode_column_f64(const leafcan_signal_t* sig, const double* __restrict x,
+                              size_t n, uint64_t* __restrict payload) {
+    const InputRange range = input_range(sig, -2147483648.0, 2147483647.0);
+    const double inv_scale = 1.0 / sig->scale;
+    const double offset = sig->offset;
+    const uint32_t shift = sig->shift;
+    const uint32_t mask = sig->mask;
+    const uint32_t bit = sig->start_byte * 8;
+
+    for (size_t i = 0; i < n; i++) {
+        double v = (clamp_input(x[i], range) - offset) * inv_scale;
+        uint32_t raw = (uint32_t)(int32_t)(v + copysign(0.5, v));
+        raw = (raw << shift) & mask;
+        payload[i] |= (uint64_t)place_raw<4, SWAP>(raw) << bit;
+    }
+}
+
+static void encode_column(const leafcan_signal_t* sig, const double* x, size_t n, uint64_t* payload) {
+    const bool be = (sig->flags & LEAFCAN_SIG_BIG_ENDIAN) != 0;
+    switch (sig->length) {
+        case 1: encode_column_f32<1, false>(sig, x, n, payload); break;
+        case 2: be ? encode_column_f32<2, true>(sig, x, n, payload)
+                   : encode_column_f32<2, false>(sig, x, n, payload); break;
+        case 4: be ? encode_column_f64<true>(sig, x, n, payload)
+                   : encode_column_f64<false>(sig, x, n, payload); break;
+        default: break;
+    }
+}
+
+// ============================================================================
+// BULK ENCODE
+// ============================================================================
+
+extern "C" int64_t leafcan_encode_bulk(uint32_t can_id, const double* const* signals,
+                                       const uint64_t* timestamps_us, size_t n,
+                                       leafcan_frame_t* frames) {
+    if (!signals || !frames) return LEAFCAN_ERR_ARGS;
+
+    const leafcan_message_t* msg = leafcan_find(can_id);
+    if (!msg) return LEAFCAN_ERR_UNKNOWN_ID;
+
+    uint64_t payload[BULK_BLOCK];
+
+    for (size_t base = 0; base < n; base += BULK_BLOCK) {
+        size_t count = (n - base < BULK_BLOCK) ? (n - base) : BULK_BLOCK;
+
+        memset(payload, 0, count * sizeof(uint64_t));
+        for (uint8_t s = 0; s < msg->signal_count; s++) {
+            if (signals[s]) encode_column(&msg->signals[s], signals[s] + base, count, payload);
+        }
+
+        leafcan_frame_t* out = frames + base;
+        for (size_t i = 0; i < count; i++) {
+            out[i].timestamp_us = timestamps_us ? timestamps_us[base + i] : 0;
+            out[i].can_id = can_id;
+            out[i].len = msg->dlc;
+            out[i].reserved[0] = out[i].reserved[1] = out[i].reserved[2] = 0;
+            memcpy(out[i].data, &payload[i], 8);
+        }
+    }
+    return (int64_t)n;
+}
@@ -0,0 +1,47 @@
+#ifndef LEAF_CAN_BULK_H
+#define LEAF_CAN_BULK_H
+
+// ============================================================================
+// BULK FRAME ENCODER (host: synthetic traffic, load tests, log generation)
+// ============================================================================
+// Encodes n frames of one registered message from structure-of-arrays
+// signal inputs in a single call. Layouts come from LeafCANRegistry, so
+// frames match what leafcan_decode() (and the unpack_* functions) expect.
+//
+// Signals are processed a column at a time into 64-bit payload lanes, which
+// keeps the scale/round/byte-swap loops branch-free so the compiler emits
+// SIMD for them (SSE2/AVX2 on x86, NEON on ARM) without intrinsics.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "LeafCANRegistry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t timestamp_us;
+    uint32_t can_id;
+    uint8_t len;
+    uint8_t reserved[3];
+    uint8_t data[8];
+} leafcan_frame_t;
+
+// signals[i] points to n physical values for the message's i-th registry
+// signal (leafcan_find(can_id)->signals[i]); a NULL column encodes as raw 0.
+// timestamps_us may be NULL (frames get timestamp 0).
+// Values are rounded half away from zero. Values whose raw form would not fit
+// int32 (and NaN) are clamped first; other out-of-range values wrap to the
+// signal width like the pack_* casts.
+// Returns n, or a LEAFCAN_ERR_* code.
+int64_t leafcan_encode_bulk(uint32_t can_id, const double* const* signals,
+                            const uint64_t* timestamps_us, size_t n,
+                            leafcan_frame_t* frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LEAF_CAN_BULK_H
@@ -1,160 +1,241 @@
 #include "LeafCANBus.h"
 
-// Static member initialization
-TaskHandle_t LeafCANBus::rx_task_handle = nullptr;
-QueueHandle_t LeafCANBus::rx_queue = nullptr;
-
-LeafCANBus::LeafCANBus() : rx_count(0), tx_count(0), error_count(0), initialized(false) {
-    // Initialize subscription array
-    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-        subscriptions[i].active = false;
-    }
+LeafCANBus::LeafCANBus() : rx_count(0), tx_count(0), error_count(0), port(nullptr),
+                           time_role(TIME_NONE), time_interval_us(0), time_due_us(0), time_seq(0),
+                           time_follow_up_due(false),
+                           filter(CAN_FILTER_ACCEPT_ALL), filter_dirty(false), initialized(false) {
+    memset(&direct_latency, 0, sizeof(direct_latency));
+    memset(&queued_latency, 0, sizeof(queued_latency));
 
     // Initialize publisher array
     for (int i = 0; i < MAX_PUBLISHERS; i++) {
         publishers[i].active = false;
     }
+    publish_heap_size = 0;
 }
 
 LeafCANBus::~LeafCANBus() {
     end();
 }
 
-bool LeafCANBus::begin(gpio_num_t tx_pin, gpio_num_t rx_pin) {
+#ifdef LEAFCAN_PLATFORM_ESP32
+bool LeafCANBus::begin(gpio_num_t tx_pin, gpio_num_t rx_pin, uint16_t rx_queue_len) {
+    CANPortConfig config;
+    config.tx_pin = tx_pin;
+    config.rx_pin = rx_pin;
+    config.rx_queue_len = rx_queue_len;
+    return beginPort(config);
+}
+#else
+bool LeafCANBus::begin(const char* interface, uint16_t rx_queue_len) {
+    CANPortConfig config;
+    config.interface = interface;
+    config.rx_queue_len = rx_queue_len;
+    return beginPort(config);
+}
+#endif
+
+bool LeafCANBus::beginPort(const CANPortConfig& config) {
     if (initialized) {
         Serial.println("[CAN] Already initialized");
         return false;
     }
 
-    // Configure TWAI timing (500 kbps)
-    twai_timing_config_t t_config = CAN_SPEED_500KBPS;
-
-    // Configure TWAI filter (accept all messages)
-    twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-
-    // Configure TWAI general settings
-    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(tx_pin, rx_pin, TWAI_MODE_NORMAL);
-    g_config.rx_queue_len = 20;  // Increase RX queue length
-
-    // Install TWAI driver
-    esp_err_t err = twai_driver_install(&g_config, &t_config, &f_config);
-    if (err != ESP_OK) {
-        Serial.printf("[CAN] Failed to install driver: %d\n", err);
+    port = can_port_open(&config);
+    if (!port) {
         return false;
     }
 
-    // Start TWAI driver
-    err = twai_start();
-    if (err != ESP_OK) {
-        Serial.printf("[CAN] Failed to start driver: %d\n", err);
-        twai_driver_uninstall();
+    // Subscriptions (and the time sync role) made before a restart still apply
+    filter = CAN_FILTER_ACCEPT_ALL;
+    filter_dirty = subscriptions.size() + direct_subscriptions.size() > 0 || time_role == TIME_FOLLOWER;
+    can_port_set_rx_handler(port, handleDirect, this);
+    if (time_role == TIME_MASTER) can_port_set_tx_stamp_id(port, CAN_ID_TIME_SYNC);
+    time_follow_up_due = false;
+
+    initialized = true;
+    return true;
+}
+
+bool LeafCANBus::subscribe(uint32_t can_id, can_unpack_callback_t unpack_fn, void* state_ptr) {
+    if (!initialized) {
+        Serial.println("[CAN] Not initialized");
         return false;
     }
 
-    // Create RX queue
-    rx_queue = xQueueCreate(20, sizeof(twai_message_t));
-    if (rx_queue == nullptr) {
-        Serial.println("[CAN] Failed to create RX queue");
-        twai_stop();
-        twai_driver_uninstall();
+    if (!unpack_fn || !state_ptr) {
+        Serial.println("[CAN] Subscription needs a callback and state");
         return false;
     }
 
-    // Create RX task
-    BaseType_t task_created = xTaskCreatePinnedToCore(
-        rx_task,
-        "can_rx_task",
-        4096,
-        this,
-        5,  // Priority
-        &rx_task_handle,
-        1   // Core 1
-    );
-
-    if (task_created != pdPASS) {
-        Serial.println("[CAN] Failed to create RX task");
-        vQueueDelete(rx_queue);
-        rx_queue = nullptr;
-        twai_stop();
-        twai_driver_uninstall();
+    if (!subscriptions.add(can_id, unpack_fn, state_ptr)) {
+        Serial.println("[CAN] No subscription slots available");
         return false;
     }
 
-    initialized = true;
-    Serial.printf("[CAN] Initialized on TX=%d, RX=%d\n", tx_pin, rx_pin);
+    Serial.printf("[CAN] Subscribed to 0x%03X\n", can_id);
+    filter_dirty = true;
     return true;
 }
 
-void LeafCANBus::rx_task(void* pvParameters) {
-    LeafCANBus* instance = (LeafCANBus*)pvParameters;
-    twai_message_t message;
+bool LeafCANBus::subscribeMask(uint32_t can_id, uint32_t mask, can_unpack_callback_t unpack_fn, void* state_ptr) {
+    if (!initialized) {
+        Serial.println("[CAN] Not initialized");
+        return false;
+    }
 
-    while (true) {
-        // Wait for message from TWAI driver
-        esp_err_t err = twai_receive(&message, pdMS_TO_TICKS(100));
-        if (err == ESP_OK) {
-            // Add to queue for processing in main loop
-            if (xQueueSend(rx_queue, &message, 0) != pdTRUE) {
-                instance->error_count++;
-            }
-        } else if (err == ESP_ERR_TIMEOUT) {
-            // No message received, continue
-            continue;
-        } else {
-            // Error receiving message
-            instance->error_count++;
-        }
+    if (!unpack_fn || !state_ptr) {
+        Serial.println("[CAN] Subscription needs a callback and state");
+        return false;
+    }
 
-        // Check for bus-off state and attempt recovery
-        twai_status_info_t status;
-        if (twai_get_status_info(&status) == ESP_OK) {
-            if (status.state == TWAI_STATE_BUS_OFF) {
-                Serial.println("[CAN] Bus-off detected, attempting recovery...");
-                twai_initiate_recovery();
-                vTaskDelay(pdMS_TO_TICKS(100));
-            }
-        }
+    if (!subscriptions.addMask(can_id, mask, unpack_fn, state_ptr)) {
+        Serial.println("[CAN] No subscription slots available");
+        return false;
     }
+
+    Serial.printf("[CAN] Subscribed to 0x%03X mask 0x%03X\n", can_id & mask, mask);
+    filter_dirty = true;
+    return true;
 }
 
-bool LeafCANBus::subscribe(uint32_t can_id, can_unpack_callback_t unpack_fn, void* state_ptr) {
+bool LeafCANBus::subscribeDirect(uint32_t can_id, can_unpack_callback_t unpack_fn, LeafCANStateBase& state) {
     if (!initialized) {
         Serial.println("[CAN] Not initialized");
         return false;
     }
 
-    // Find empty slot
-    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-        if (!subscriptions[i].active) {
-            subscriptions[i].can_id = can_id;
-            subscriptions[i].unpack_fn = unpack_fn;
-            subscriptions[i].state_ptr = state_ptr;
-            subscriptions[i].active = true;
-            Serial.printf("[CAN] Subscribed to 0x%03X\n", can_id);
-            return true;
-        }
+    if (!unpack_fn) {
+        Serial.println("[CAN] Subscription needs a callback and state");
+        return false;
     }
 
-    Serial.println("[CAN] No subscription slots available");
-    return false;
+    // Keep the RX task out of the index while it changes
+    can_port_set_rx_handler(port, nullptr, nullptr);
+    uint16_t slot = direct_subscriptions.size();
+    bool added = slot < MAX_DIRECT_SUBSCRIPTIONS &&
+                 direct_subscriptions.add(can_id, unpackDirect, &direct_bindings[slot]);
+    if (added) {
+        direct_bindings[slot].unpack_fn = unpack_fn;
+        direct_bindings[slot].state = &state;
+    }
+    can_port_set_rx_handler(port, handleDirect, this);
+
+    if (!added) {
+        Serial.println("[CAN] No direct subscription slots available");
+        return false;
+    }
+
+    Serial.printf("[CAN] Subscribed to 0x%03X (direct)\n", can_id);
+    filter_dirty = true;
+    return true;
+}
+
+void LeafCANBus::unpackDirect(const uint8_t* data, uint8_t len, void* binding) {
+    DirectBinding* b = (DirectBinding*)binding;
+    b->unpack_fn(data, len, b->state->beginWrite());
+    b->state->endWrite();
+}
+
+bool LeafCANBus::handleDirect(const CANFrame* frame, void* context) {
+    LeafCANBus* bus = (LeafCANBus*)context;
+    if (bus->direct_subscriptions.dispatch(frame->id, frame->data, frame->len) == 0) {
+        return false;
+    }
+
+    uint32_t latency = micros() - frame->timestamp_us;
+    CANLatencyStats& stats = bus->direct_latency;
+    stats.total_us += latency;
+    if (latency > stats.max_us) stats.max_us = latency;
+    stats.frames++;
+    return true;
+}
+
+CANPortStats LeafCANBus::getPortStats() const {
+    CANPortStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (port) can_port_get_stats(port, &stats);
+    return stats;
+}
+
+CANBusHealth LeafCANBus::getBusHealth() const {
+    CANBusHealth health;
+    memset(&health, 0, sizeof(health));
+    if (port) can_port_get_health(port, &health);
+    return health;
+}
+
+CANLatencyStats LeafCANBus::getLatencyStats(bool direct) const {
+    if (!direct || !port) return direct ? direct_latency : queued_latency;
+    // handleDirect() updates these under the handler lock
+    can_port_lock_rx_handler(port);
+    CANLatencyStats stats = direct_latency;
+    can_port_unlock_rx_handler(port);
+    return stats;
+}
+
+CANTxStats LeafCANBus::getTxStats() const {
+    CANTxStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (port) can_port_get_tx_stats(port, &stats);
+    return stats;
 }
 
 bool LeafCANBus::publish(uint32_t can_id, uint32_t interval_ms, can_pack_callback_t pack_fn, void* state_ptr) {
+    return addPublisher(can_id, interval_ms, 0, pack_fn, state_ptr, nullptr);
+}
+
+bool LeafCANBus::publishOnChange(uint32_t can_id, uint32_t check_ms, uint32_t heartbeat_ms,
+                                 can_pack_callback_t pack_fn, void* state_ptr,
+                                 can_change_callback_t change_fn) {
+    return addPublisher(can_id, check_ms, heartbeat_ms, pack_fn, state_ptr, change_fn);
+}
+
+bool LeafCANBus::addPublisher(uint32_t can_id, uint32_t interval_ms, uint32_t heartbeat_ms,
+                              can_pack_callback_t pack_fn, void* state_ptr, can_change_callback_t change_fn) {
     if (!initialized) {
         Serial.println("[CAN] Not initialized");
         return false;
     }
 
+    if (!pack_fn || !state_ptr) {
+        Serial.println("[CAN] Publisher needs a callback and state");
+        return false;
+    }
+
+    // An interval of 0 used to mean "every process()"; 1 ms is the closest deadline
+    if (interval_ms == 0) interval_ms = 1;
+
+    // The heartbeat is checked on the interval grid
+    if (heartbeat_ms != 0 && heartbeat_ms < interval_ms) heartbeat_ms = interval_ms;
+
     // Find empty slot
     for (int i = 0; i < MAX_PUBLISHERS; i++) {
         if (!publishers[i].active) {
+            uint32_t now = micros();
+            uint32_t phase = choosePhase(interval_ms, now);
+
             publishers[i].can_id = can_id;
             publishers[i].pack_fn = pack_fn;
             publishers[i].state_ptr = state_ptr;
             publishers[i].interval_ms = interval_ms;
             publishers[i].last_publish_ms = 0;
+            publishers[i].due_us = now + phase * 1000;
+            publishers[i].heartbeat_ms = heartbeat_ms;
+            publishers[i].change_fn = change_fn;
+            publishers[i].last_len = 0;
+            publishers[i].last_sent_us = 0;
+            memset(&publishers[i].stats, 0, sizeof(publishers[i].stats));
+            publishers[i].stats.phase_ms = phase;
             publishers[i].active = true;
-            Serial.printf("[CAN] Publisher added for 0x%03X (interval: %u ms)\n", can_id, interval_ms);
+            heapPush(i);
+            if (heartbeat_ms) {
+                Serial.printf("[CAN] On-change publisher added for 0x%03X (check: %u ms, heartbeat: %u ms, phase: %u ms)\n",
+                              can_id, interval_ms, heartbeat_ms, phase);
+            } else {
+                Serial.printf("[CAN] Publisher added for 0x%03X (interval: %u ms, phase: %u ms)\n",
+                              can_id, interval_ms, phase);
+            }
             return true;
         }
     }
@@ -163,7 +244,112 @@ bool LeafCANBus::publish(uint32_t can_id, uint32_t interval_ms, can_pack_callbac
     return false;
 }
 
-bool LeafCANBus::send(uint32_t can_id, const uint8_t* data, uint8_t len) {
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+uint32_t LeafCANBus::choosePhase(uint32_t interval_ms, uint32_t now_us) const {
+    // Two periodic schedules with intervals A and B come as close as their
+    // offsets modulo gcd(A, B); pick the offset whose closest approach to any
+    // existing publisher is largest (ties: earliest)
+    uint32_t step = interval_ms >= 64 ? interval_ms / 64 : 1;
+    uint32_t best_phase = 0;
+    int64_t best_gap = -1;
+
+    for (uint32_t phase = 0; phase < interval_ms; phase += step) {
+        int64_t gap = INT64_MAX;
+        for (uint8_t h = 0; h < publish_heap_size; h++) {
+            const Publisher& p = publishers[publish_heap[h]];
+            int64_t g = (int64_t)gcd(interval_ms, p.interval_ms) * 1000;
+            int64_t d = ((int64_t)phase * 1000 - (int32_t)(p.due_us - now_us)) % g;
+            if (d < 0) d += g;
+            if (g - d < d) d = g - d;
+            if (d < gap) gap = d;
+        }
+        if (gap > best_gap) {
+            best_gap = gap;
+            best_phase = phase;
+        }
+        if (publish_heap_size == 0) break;
+    }
+    return best_phase;
+}
+
+bool LeafCANBus::dueBefore(uint8_t a, uint8_t b) const {
+    return (int32_t)(publishers[a].due_us - publishers[b].due_us) < 0;
+}
+
+void LeafCANBus::heapPush(uint8_t index) {
+    uint8_t i = publish_heap_size++;
+    publish_heap[i] = index;
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!dueBefore(publish_heap[i], publish_heap[parent])) break;
+        uint8_t t = publish_heap[i];
+        publish_heap[i] = publish_heap[parent];
+        publish_heap[parent] = t;
+        i = parent;
+    }
+}
+
+uint8_t LeafCANBus::heapPop() {
+    uint8_t top = publish_heap[0];
+    publish_heap[0] = publish_heap[--publish_heap_size];
+    uint8_t i = 0;
+    while (true) {
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = i;
+        if (left < publish_heap_size && dueBefore(publish_heap[left], publish_heap[smallest])) smallest = left;
+        if (right < publish_heap_size && dueBefore(publish_heap[right], publish_heap[smallest])) smallest = right;
+        if (smallest == i) break;
+        uint8_t t = publish_heap[i];
+        publish_heap[i] = publish_heap[smallest];
+        publish_heap[smallest] = t;
+        i = smallest;
+    }
+    return top;
+}
+
+uint32_t LeafCANBus::usUntilNextPublish() const {
+    if (publish_heap_size == 0) return UINT32_MAX;
+    int32_t wait = (int32_t)(publishers[publish_heap[0]].due_us - micros());
+    return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void LeafCANBus::waitForNextPublish(uint32_t max_wait_ms) {
+    uint32_t wait_us = usUntilNextPublish();
+    if (wait_us > max_wait_ms * 1000) wait_us = max_wait_ms * 1000;
+
+    // Sleep whole ticks, then spin the sub-millisecond remainder
+    if (wait_us >= 1000) delay(wait_us / 1000);
+    if (wait_us % 1000) delayMicroseconds(wait_us % 1000);
+}
+
+uint32_t LeafCANBus::getSuppressedCount() const {
+    uint32_t total = 0;
+    for (int i = 0; i < MAX_PUBLISHERS; i++) {
+        if (publishers[i].active) total += publishers[i].stats.suppressed;
+    }
+    return total;
+}
+
+bool LeafCANBus::getPublisherStats(uint32_t can_id, PublisherStats* stats) const {
+    for (int i = 0; i < MAX_PUBLISHERS; i++) {
+        if (publishers[i].active && publishers[i].can_id == can_id) {
+            *stats = publishers[i].stats;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LeafCANBus::send(uint32_t can_id, const uint8_t* data, uint8_t len, uint32_t max_age_ms) {
     if (!initialized) {
         return false;
     }
@@ -173,14 +359,16 @@ bool LeafCANBus::send(uint32_t can_id, const uint8_t* data, uint8_t len) {
         return false;
     }
 
-    twai_message_t message;
-    message.identifier = can_id;
-    message.data_length_code = len;
-    message.flags = TWAI_MSG_FLAG_NONE;
-    memcpy(message.data, data, len);
+    CANFrame frame;
+    frame.id = can_id;
+    frame.len = len;
+    frame.extended = can_id > 0x7FF;
+    frame.timestamp_us = 0;     // Stamped by the receiving port
+    memcpy(frame.data, data, len);
 
-    esp_err_t err = twai_transmit(&message, pdMS_TO_TICKS(10));
-    if (err == ESP_OK) {
+    // Never blocks: the port sends it once the bus is free, by priority
+    uint32_t deadline_us = max_age_ms ? micros() + max_age_ms * 1000 : 0;
+    if (can_port_queue(port, &frame, deadline_us, max_age_ms != 0)) {
         tx_count++;
         return true;
     } else {
@@ -189,74 +377,244 @@ bool LeafCANBus::send(uint32_t can_id, const uint8_t* data, uint8_t len) {
     }
 }
 
-void LeafCANBus::processRxMessage(const twai_message_t& message) {
-    rx_count++;
+void LeafCANBus::applyFilter() {
+    filter_dirty = false;
 
-    // Check subscriptions
-    for (int i = 0; i < MAX_SUBSCRIPTIONS; i++) {
-        if (subscriptions[i].active && subscriptions[i].can_id == message.identifier) {
-            if (subscriptions[i].unpack_fn && subscriptions[i].state_ptr) {
-                subscriptions[i].unpack_fn(message.data, message.data_length_code, subscriptions[i].state_ptr);
-            }
-        }
+    CANFilterRule rules[MAX_SUBSCRIPTIONS + MAX_DIRECT_SUBSCRIPTIONS + 1];
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < subscriptions.size(); i++, count++) {
+        const auto& entry = subscriptions.entry(i);
+        rules[count].id = entry.can_id;
+        rules[count].mask = entry.mask;
+        rules[count].extended = entry.can_id > 0x7FF;
+    }
+    for (uint16_t i = 0; i < direct_subscriptions.size(); i++, count++) {
+        const auto& entry = direct_subscriptions.entry(i);
+        rules[count].id = entry.can_id;
+        rules[count].mask = entry.mask;
+        rules[count].extended = entry.can_id > 0x7FF;
+    }
+    if (time_role == TIME_FOLLOWER) {
+        rules[count].id = CAN_ID_TIME_SYNC;     // Sync + follow-up
+        rules[count].mask = 0x7FE;
+        rules[count].extended = false;
+        count++;
+    }
+
+    CANFilter next = can_filter_compute(rules, count);
+    if (next.acceptance_code == filter.acceptance_code &&
+        next.acceptance_mask == filter.acceptance_mask &&
+        next.single_filter == filter.single_filter) {
+        return;
+    }
+
+    if (can_port_set_filter(port, &next)) {
+        filter = next;
+        Serial.printf("[CAN] Filter %s code=0x%08X mask=0x%08X (%.1f%% of 11-bit IDs)\n",
+                      filter.single_filter ? "single" : "dual",
+                      (unsigned)filter.acceptance_code, (unsigned)filter.acceptance_mask,
+                      can_filter_coverage(&filter, false) * 100.0f);
     }
 }
 
-void LeafCANBus::processPublishers() {
-    uint32_t now = millis();
+void LeafCANBus::processRxMessage(const CANFrame& frame) {
+    rx_count++;
 
-    for (int i = 0; i < MAX_PUBLISHERS; i++) {
-        if (!publishers[i].active) continue;
+    if (time_role == TIME_FOLLOWER) handleTimeFrame(frame);
 
-        // Check if it's time to publish
-        if (now - publishers[i].last_publish_ms >= publishers[i].interval_ms) {
-            uint8_t data[8];
-            uint8_t len = 0;
+    // Run this ID's callback chain (plus any matching mask subscriptions)
+    if (subscriptions.dispatch(frame.id, frame.data, frame.len) > 0) {
+        uint32_t latency = micros() - frame.timestamp_us;
+        queued_latency.total_us += latency;
+        if (latency > queued_latency.max_us) queued_latency.max_us = latency;
+        queued_latency.frames++;
+    }
+}
 
-            // Pack data
-            if (publishers[i].pack_fn && publishers[i].state_ptr) {
-                publishers[i].pack_fn(publishers[i].state_ptr, data, &len);
+void LeafCANBus::processPublishers() {
+    // Each publisher that is due goes out once per call, earliest deadline
+    // first; a failed send is retried on the next call
+    uint8_t due[MAX_PUBLISHERS];
+    uint8_t due_count = 0;
+    uint32_t now = micros();
+    while (publish_heap_size > 0 && (int32_t)(publishers[publish_heap[0]].due_us - now) <= 0) {
+        due[due_count++] = heapPop();
+    }
 
-                // Send message
-                if (send(publishers[i].can_id, data, len)) {
-                    publishers[i].last_publish_ms = now;
+    for (uint8_t k = 0; k < due_count; k++) {
+        Publisher& pub = publishers[due[k]];
+        uint8_t data[8];
+        uint8_t len = 0;
+
+        // Pack data
+        if (pub.pack_fn && pub.state_ptr) {
+            pub.pack_fn(pub.state_ptr, data, &len);
+            uint32_t sent_at = micros();
+            uint32_t late = sent_at - pub.due_us;
+            uint32_t interval_us = pub.interval_ms * 1000;
+
+            // On-change: skip this deadline unless the payload moved or the
+            // heartbeat is due (the first frame always goes out). The heartbeat
+            // may fire half a check early so jitter can't delay it a whole check.
+            bool changed = true;
+            bool skip = false;
+            if (pub.heartbeat_ms && pub.stats.sent > 0) {
+                changed = len != pub.last_len ||
+                          (pub.change_fn ? pub.change_fn(pub.last_data, data, len)
+                                         : memcmp(pub.last_data, data, len) != 0);
+                skip = !changed && sent_at - pub.last_sent_us < pub.heartbeat_ms * 1000 - interval_us / 2;
+            }
+            if (skip) pub.stats.suppressed++;
+
+            // Send message; a frame still queued when the next one is due is stale
+            uint32_t max_age_ms = pub.heartbeat_ms ? pub.heartbeat_ms : pub.interval_ms;
+            if (skip || send(pub.can_id, data, len, max_age_ms)) {
+                if (!skip) {
+                    if (!changed) pub.stats.heartbeats++;
+                    pub.last_publish_ms = sent_at / 1000;
+                    pub.last_sent_us = sent_at;
+                    memcpy(pub.last_data, data, len);
+                    pub.last_len = len;
+                    pub.stats.sent++;
+                    pub.stats.jitter_total_us += late;
+                    if (late > pub.stats.jitter_max_us) pub.stats.jitter_max_us = late;
                 }
+
+                // Stay on the phase grid; whole intervals overslept are missed
+                uint32_t skipped = late / interval_us;
+                pub.stats.missed += skipped;
+                pub.due_us += (skipped + 1) * interval_us;
             }
         }
+        heapPush(due[k]);
+    }
+}
+
+// ============================================================================
+// TIME SYNC
+// ============================================================================
+
+// Sync and follow-up go stale after half an interval; at least 1 ms, since
+// send() takes 0 as "no deadline"
+static uint32_t time_frame_max_age_ms(uint32_t interval_us) {
+    uint32_t max_age_ms = interval_us / 2000;
+    return max_age_ms ? max_age_ms : 1;
+}
+
+bool LeafCANBus::beginTimeMaster(uint32_t interval_ms) {
+    if (!initialized) {
+        Serial.println("[CAN] Not initialized");
+        return false;
+    }
+
+    if (interval_ms == 0) interval_ms = 1;
+    time_role = TIME_MASTER;
+    time_interval_us = interval_ms * 1000;
+    time_due_us = micros();
+    time_follow_up_due = false;
+    can_port_set_tx_stamp_id(port, CAN_ID_TIME_SYNC);
+    Serial.printf("[CAN] Time sync master, every %u ms\n", (unsigned)interval_ms);
+    return true;
+}
+
+bool LeafCANBus::followTimeSync() {
+    if (!initialized) {
+        Serial.println("[CAN] Not initialized");
+        return false;
+    }
+
+    if (time_role == TIME_MASTER) can_port_set_tx_stamp_id(port, 0);
+    time_role = TIME_FOLLOWER;
+    time_sync.reset();
+    filter_dirty = true;
+    Serial.println("[CAN] Following time sync");
+    return true;
+}
+
+bool LeafCANBus::isTimeSynced() const {
+    if (time_role == TIME_MASTER) return true;
+    return time_role == TIME_FOLLOWER && time_sync.synced(millis());
+}
+
+CANTimeSyncStats LeafCANBus::getTimeSyncStats() const {
+    CANTimeSyncStats stats;
+    time_sync.snapshot(&stats, millis());
+    if (time_role == TIME_MASTER) stats.synced = true;
+    return stats;
+}
+
+uint64_t LeafCANBus::syncedMicros() {
+    uint64_t local = clock.extend(micros());
+    return time_role == TIME_FOLLOWER ? time_sync.toMaster(local) : local;
+}
+
+void LeafCANBus::processTimeMaster() {
+    uint32_t now = micros();
+    uint64_t now64 = clock.extend(now);
+
+    // Follow-up once the sync has left, with the time it did
+    uint32_t stamp;
+    if (time_follow_up_due && can_port_tx_stamp(port, &stamp)) {
+        uint8_t data[8];
+        can_time_follow_up_pack(time_seq, LeafCANClock64::before(stamp, now, now64), data);
+        send(CAN_ID_TIME_FOLLOW_UP, data, sizeof(data), time_frame_max_age_ms(time_interval_us));
+        time_follow_up_due = false;
+        time_seq++;
+    }
+
+    if ((int32_t)(time_due_us - now) > 0) return;
+
+    // A sync that never left (dropped, bus-off) gets no follow-up; its
+    // stamp must not be paired with the next one either
+    if (time_follow_up_due) time_seq++;
+    can_port_tx_stamp(port, &stamp);
+
+    uint8_t seq = time_seq;
+    time_follow_up_due = send(CAN_ID_TIME_SYNC, &seq, 1, time_frame_max_age_ms(time_interval_us));
+    time_due_us += time_interval_us;
+    if ((int32_t)(time_due_us - now) <= 0) time_due_us = now + time_interval_us;
+}
+
+void LeafCANBus::handleTimeFrame(const CANFrame& frame) {
+    if (frame.id == CAN_ID_TIME_SYNC && frame.len >= 1) {
+        // Pair the port's RX stamp with the master time in the follow-up
+        uint32_t now = micros();
+        uint64_t rx_us = LeafCANClock64::before(frame.timestamp_us, now, clock.extend(now));
+        time_sync.onSync(frame.data[0], rx_us);
+    } else if (frame.id == CAN_ID_TIME_FOLLOW_UP && frame.len >= 8) {
+        time_sync.onFollowUp(frame.data[0], can_time_follow_up_unpack(frame.data), millis());
     }
 }
 
 void LeafCANBus::process() {
     if (!initialized) return;
 
+    if (filter_dirty) {
+        applyFilter();
+    }
+
     // Process RX queue
-    twai_message_t message;
-    while (xQueueReceive(rx_queue, &message, 0) == pdTRUE) {
-        processRxMessage(message);
+    CANFrame frame;
+    while (can_port_receive(port, &frame)) {
+        processRxMessage(frame);
     }
 
     // Process publishers
     processPublishers();
+
+    if (time_role == TIME_MASTER) {
+        processTimeMaster();
+    } else {
+        clock.extend(micros());     // Keep the 64-bit clock across micros() wraps
+    }
 }
 
 void LeafCANBus::end() {
     if (!initialized) return;
 
-    // Delete RX task
-    if (rx_task_handle != nullptr) {
-        vTaskDelete(rx_task_handle);
-        rx_task_handle = nullptr;
-    }
-
-    // Delete RX queue
-    if (rx_queue != nullptr) {
-        vQueueDelete(rx_queue);
-        rx_queue = nullptr;
-    }
-
-    // Stop and uninstall TWAI driver
-    twai_stop();
-    twai_driver_uninstall();
+    // Stop RX task/thread and uninstall the driver
+    can_port_close(port);
+    port = nullptr;
 
     initialized = false;
     Serial.println("[CAN] Stopped");
@@ -1,32 +1,59 @@
 #ifndef LEAF_CAN_BUS_H
 #define LEAF_CAN_BUS_H
 
-#include <Arduino.h>
-#include "driver/twai.h"
+#include <Arduino.h>             // Host builds: lib/LeafCANBus/host/Arduino.h
+#include "LeafCANPort.h"
 #include "LeafCANMessages.h"
+#include "LeafCANSubscriptions.h"
+#include "LeafCANFilter.h"
+#include "LeafCANState.h"
+#include "LeafCANHealth.h"
+#include "LeafCANTimeSync.h"
 
 // Maximum number of subscriptions and publishers
-#define MAX_SUBSCRIPTIONS 16
+// (override MAX_SUBSCRIPTIONS in build_flags; each costs ~36 bytes of RAM on ESP32)
+#ifndef MAX_SUBSCRIPTIONS
+#define MAX_SUBSCRIPTIONS 64
+#endif
+#ifndef MAX_DIRECT_SUBSCRIPTIONS
+#define MAX_DIRECT_SUBSCRIPTIONS 16
+#endif
 #define MAX_PUBLISHERS 8
 
 // CAN bus configuration
+#ifdef LEAFCAN_PLATFORM_ESP32
+#include "driver/twai.h"
 #define CAN_SPEED_500KBPS TWAI_TIMING_CONFIG_500KBITS()
 #define CAN_TX_GPIO_NUM GPIO_NUM_5
 #define CAN_RX_GPIO_NUM GPIO_NUM_4
+#else
+#define CAN_DEFAULT_INTERFACE "vcan0"
+#endif
 
-// Subscription callback type
-typedef void (*can_unpack_callback_t)(const uint8_t* data, uint8_t len, void* state);
+// Frame-to-state latency: port receive timestamp -> unpack callback done
+typedef struct {
+    uint32_t frames;
+    uint32_t max_us;
+    uint64_t total_us;      // Mean = total_us / frames
+} CANLatencyStats;
 
 // Publisher pack callback type
 typedef void (*can_pack_callback_t)(const void* state, uint8_t* data, uint8_t* len);
 
-// Subscription entry
+// On-change publisher deadband: true when `data` differs enough from the
+// last transmitted payload `sent` to be worth a frame (same length)
+typedef bool (*can_change_callback_t)(const uint8_t* sent, const uint8_t* data, uint8_t len);
+
+// Publisher timing statistics
 typedef struct {
-    uint32_t can_id;
-    can_unpack_callback_t unpack_fn;
-    void* state_ptr;
-    bool active;
-} Subscription;
+    uint32_t phase_ms;          // Offset assigned by publish() to spread bus load
+    uint32_t sent;
+    uint32_t missed;            // Deadlines skipped: process() ran a whole interval late
+    uint32_t jitter_max_us;     // Send time - deadline
+    uint64_t jitter_total_us;   // Mean = jitter_total_us / sent
+    uint32_t suppressed;        // On-change: deadlines skipped, payload unchanged
+    uint32_t heartbeats;        // On-change: sent unchanged after heartbeat_ms of silence
+} PublisherStats;
 
 // Publisher entry
 typedef struct {
@@ -35,6 +62,13 @@ typedef struct {
     void* state_ptr;
     uint32_t interval_ms;
     uint32_t last_publish_ms;
+    uint32_t due_us;            // Next deadline (micros())
+    uint32_t heartbeat_ms;      // 0 = send every interval; else on change or after this much silence
+    can_change_callback_t change_fn;    // NULL = any payload difference
+    uint8_t last_data[8];       // Last transmitted payload
+    uint8_t last_len;
+    uint32_t last_sent_us;
+    PublisherStats stats;
     bool active;
 } Publisher;
 
@@ -43,52 +77,169 @@ public:
     LeafCANBus();
     ~LeafCANBus();
 
+#ifdef LEAFCAN_PLATFORM_ESP32
     // Initialize CAN bus with custom pins (optional)
-    bool begin(gpio_num_t tx_pin = CAN_TX_GPIO_NUM, gpio_num_t rx_pin = CAN_RX_GPIO_NUM);
-
-    // Subscribe to a CAN ID
+    bool begin(gpio_num_t tx_pin = CAN_TX_GPIO_NUM, gpio_num_t rx_pin = CAN_RX_GPIO_NUM,
+               uint16_t rx_queue_len = CAN_PORT_RX_QUEUE_LEN);
+#else
+    // Initialize on a SocketCAN interface ("can0", "vcan0") or CAN_PORT_LOOPBACK
+    bool begin(const char* interface = CAN_DEFAULT_INTERFACE,
+               uint16_t rx_queue_len = CAN_PORT_RX_QUEUE_LEN);
+#endif
+
+    // Subscribe to a CAN ID (several callbacks per ID are allowed)
     bool subscribe(uint32_t can_id, can_unpack_callback_t unpack_fn, void* state_ptr);
 
-    // Publish a CAN message periodically
+    // Subscribe to every ID with (id & mask) == (can_id & mask)
+    // (a mask within 0x7FF selects standard IDs only)
+    bool subscribeMask(uint32_t can_id, uint32_t mask, can_unpack_callback_t unpack_fn, void* state_ptr);
+
+    // Unpack in the RX task as frames arrive (no queue, no wait for process());
+    // read the result anywhere with state.read(). Frames of this ID are not
+    // delivered to subscribe() callbacks. unpack_fn must be quick, and on ESP32
+    // it runs on the RX task's stack (CAN_PORT_RX_TASK_STACK, see LeafCANPort.h).
+    bool subscribeDirect(uint32_t can_id, can_unpack_callback_t unpack_fn, LeafCANStateBase& state);
+
+    // Publish a CAN message periodically. Each publisher gets a phase offset
+    // that keeps its deadlines away from the other publishers' deadlines.
     bool publish(uint32_t can_id, uint32_t interval_ms, can_pack_callback_t pack_fn, void* state_ptr);
 
-    // Send a CAN message immediately (ad-hoc)
-    bool send(uint32_t can_id, const uint8_t* data, uint8_t len);
+    // Publish only when the payload changes: packed every check_ms and sent
+    // when change_fn (or, with NULL, any byte difference against the last
+    // transmitted frame) says so, and at least every heartbeat_ms regardless
+    bool publishOnChange(uint32_t can_id, uint32_t check_ms, uint32_t heartbeat_ms,
+                         can_pack_callback_t pack_fn, void* state_ptr,
+                         can_change_callback_t change_fn = nullptr);
+
+    // Send a CAN message (ad-hoc). Never blocks: the frame joins the TX
+    // priority queue (lower ID first); with max_age_ms it is dropped if the
+    // bus stays busy that long. False when the queue is full of higher-priority frames.
+    bool send(uint32_t can_id, const uint8_t* data, uint8_t len, uint32_t max_age_ms = 0);
 
     // Process CAN bus (call in loop())
     void process();
 
+    // Time until the earliest publisher deadline (UINT32_MAX with none)
+    uint32_t usUntilNextPublish() const;
+
+    // Sleep until the next publisher deadline, but at most max_wait_ms
+    // (call in loop() instead of delay() so publishers go out on time)
+    void waitForNextPublish(uint32_t max_wait_ms);
+
+    // Timing of the publisher for can_id; false if there is none
+    bool getPublisherStats(uint32_t can_id, PublisherStats* stats) const;
+
     // Stop CAN bus
     void end();
 
     // Get statistics
-    uint32_t getRxCount() const { return rx_count; }
-    uint32_t getTxCount() const { return tx_count; }
-    uint32_t getErrorCount() const { return error_count; }
+    uint32_t getRxCount() const { return rx_count + getLatencyStats(true).frames; }
+    uint32_t getTxCount() const { return tx_count; }      // Frames queued by send()
+    uint32_t getSuppressedCount() const;    // Frames on-change publishers did not need to send
+    uint32_t getErrorCount() const { return error_count + (port ? can_port_rx_errors(port) : 0); }
+
+    // Frames the acceptance filter kept out (estimated on ESP32, see LeafCANPort.h)
+    uint32_t getFilteredCount() const { return port ? can_port_rx_filtered(port) : 0; }
+    const CANFilter& getFilter() const { return filter; }
+
+    // Latency of subscribeDirect() (RX task) vs. subscribe() (queue + process())
+    CANLatencyStats getLatencyStats(bool direct) const;
+    CANPortStats getPortStats() const;
+
+    // TX queue depth, drops and queue-to-bus latency
+    CANTxStats getTxStats() const;
+    uint16_t getTxQueueFree() const { return port ? can_port_tx_free(port) : 0; }
+
+    // Bus state (error-active ... bus-off), time spent in each, alert counters
+    CANBusHealth getBusHealth() const;
+
+    // Time sync (LeafCANTimeSync.h). One node per bus is the master and
+    // sends sync + follow-up every interval_ms from process(); the others
+    // call followTimeSync() and syncedMicros() reads the master's clock.
+    bool beginTimeMaster(uint32_t interval_ms = CAN_TIME_SYNC_INTERVAL_MS);
+    bool followTimeSync();
+    bool isTimeSynced() const;
+    CANTimeSyncStats getTimeSyncStats() const;
+
+    // Master clock in us (own clock on the master and until synced).
+    // Call from the loop task, like process().
+    uint64_t syncedMicros();
+
+    // Age of an origin timestamp (low 32 bits of the sender's syncedMicros()
+    // when it sampled the data) carried in a frame
+    uint32_t originAgeUs(uint32_t origin_us) { return (uint32_t)syncedMicros() - origin_us; }
 
 private:
-    // RX task handle
-    static TaskHandle_t rx_task_handle;
-    static QueueHandle_t rx_queue;
+    // Start the platform port (driver + RX task/thread)
+    bool beginPort(const CANPortConfig& config);
 
-    // RX task function
-    static void rx_task(void* pvParameters);
+    // Narrow the acceptance filter to the current subscriptions
+    void applyFilter();
 
     // Process received message
-    void processRxMessage(const twai_message_t& message);
+    void processRxMessage(const CANFrame& frame);
+
+    // RX task fast path (port RX handler)
+    static bool handleDirect(const CANFrame* frame, void* context);
+    static void unpackDirect(const uint8_t* data, uint8_t len, void* binding);
 
     // Process publishers (periodic sending)
     void processPublishers();
 
+    // Time sync: master sends, followers take sync/follow-up frames
+    void processTimeMaster();
+    void handleTimeFrame(const CANFrame& frame);
+
+    // Register a publisher (heartbeat_ms 0 = periodic)
+    bool addPublisher(uint32_t can_id, uint32_t interval_ms, uint32_t heartbeat_ms,
+                      can_pack_callback_t pack_fn, void* state_ptr, can_change_callback_t change_fn);
+
+    // Phase offset for a new publisher, maximizing distance to existing deadlines
+    uint32_t choosePhase(uint32_t interval_ms, uint32_t now_us) const;
+
+    // Min-heap of publisher indices ordered by due_us
+    void heapPush(uint8_t index);
+    uint8_t heapPop();
+    bool dueBefore(uint8_t a, uint8_t b) const;
+
     // Subscriptions and publishers
-    Subscription subscriptions[MAX_SUBSCRIPTIONS];
+    LeafCANSubscriptionIndex<MAX_SUBSCRIPTIONS> subscriptions;
     Publisher publishers[MAX_PUBLISHERS];
+    uint8_t publish_heap[MAX_PUBLISHERS];
+    uint8_t publish_heap_size;
+
+    // Direct subscriptions: index entries point at bindings
+    struct DirectBinding {
+        can_unpack_callback_t unpack_fn;
+        LeafCANStateBase* state;
+    };
+    LeafCANSubscriptionIndex<MAX_DIRECT_SUBSCRIPTIONS> direct_subscriptions;
+    DirectBinding direct_bindings[MAX_DIRECT_SUBSCRIPTIONS];
 
     // Statistics
+    CANLatencyStats direct_latency;     // RX task, under the port's handler lock
+    CANLatencyStats queued_latency;
     uint32_t rx_count;
     uint32_t tx_count;
     uint32_t error_count;
 
+    // Platform backend (LeafCANPort_esp32.cpp / LeafCANPort_linux.cpp)
+    CANPort* port;
+
+    // Time sync
+    enum TimeRole { TIME_NONE, TIME_MASTER, TIME_FOLLOWER };
+    TimeRole time_role;
+    LeafCANClock64 clock;
+    LeafCANTimeSync time_sync;
+    uint32_t time_interval_us;
+    uint32_t time_due_us;
+    uint8_t time_seq;
+    bool time_follow_up_due;    // Sync queued, waiting for its TX stamp
+
+    // Acceptance filter; recomputed in process() after subscriptions change
+    CANFilter filter;
+    bool filter_dirty;
+
     // Initialization flag
     bool initialized;
 };
@@ -0,0 +1,172 @@
+#include "LeafCANFilter.h"
+
+// Dual mode is searched over sorted splits of up to this many rules;
+// larger sets fall back to single mode
+#define CAN_FILTER_MAX_RULES 128
+
+// ============================================================================
+// CODE/MASK MERGE
+// ============================================================================
+
+// A set of IDs: x matches when (x ^ code) & ~dont_care == 0
+typedef struct {
+    uint32_t code;
+    uint32_t dont_care;
+} Pattern;
+
+// Widen `acc` just enough to also cover `p` (bits that differ become don't care)
+static void merge(Pattern* acc, const Pattern& p, bool first) {
+    if (first) {
+        *acc = p;
+        return;
+    }
+    acc->dont_care |= p.dont_care | (acc->code ^ p.code);
+    acc->code &= ~acc->dont_care;
+}
+
+// Single mode: standard IDs sit in 31:21, extended IDs in 31:3
+static Pattern single_pattern(const CANFilterRule& r) {
+    Pattern p;
+    if (r.extended) {
+        uint32_t care = (r.mask & 0x1FFFFFFF) << 3;
+        p.code = (r.id << 3) & care;
+        p.dont_care = ~care;
+    } else {
+        uint32_t care = (r.mask & 0x7FF) << 21;
+        p.code = (r.id << 21) & care;
+        p.dont_care = ~care;
+    }
+    return p;
+}
+
+// Dual mode, one 16-bit filter: standard IDs in 15:5, extended ID[28:13]
+static Pattern dual_pattern(const CANFilterRule& r) {
+    Pattern p;
+    uint32_t care = r.extended ? (r.mask >> 13) & 0xFFFF : (r.mask & 0x7FF) << 5;
+    uint32_t code = r.extended ? (r.id >> 13) & 0xFFFF : (r.id & 0x7FF) << 5;
+    p.code = code & care;
+    p.dont_care = ~care & 0xFFFF;
+    return p;
+}
+
+static int popcount(uint32_t x) {
+    return __builtin_popcount(x);
+}
+
+// ============================================================================
+// COVERAGE (score used to pick between candidate filters)
+// ============================================================================
+
+static float pow2(int bits) {
+    float f = 1.0f;
+    for (int i = 0; i < bits; i++) f *= 2.0f;
+    for (int i = 0; i > bits; i--) f *= 0.5f;
+    return f;
+}
+
+float can_filter_coverage(const CANFilter* filter, bool extended) {
+    uint32_t dc = filter->acceptance_mask;
+    if (filter->single_filter) {
+        return extended ? pow2(popcount(dc & 0xFFFFFFF8) - 29)
+                        : pow2(popcount(dc & 0xFFE00000) - 11);
+    }
+
+    // Two filters: a frame passes if either does (sum is an upper bound)
+    float total = 0.0f;
+    for (int shift = 16; shift >= 0; shift -= 16) {
+        uint32_t half = (dc >> shift) & 0xFFFF;
+        total += extended ? pow2(popcount(half) - 16) : pow2(popcount(half & 0xFFE0) - 11);
+    }
+    return total > 1.0f ? 1.0f : total;
+}
+
+static float score(const CANFilter* filter) {
+    return can_filter_coverage(filter, false) + can_filter_coverage(filter, true);
+}
+
+// ============================================================================
+// COMPUTE
+// ============================================================================
+
+CANFilter can_filter_compute(const CANFilterRule* rules, size_t count) {
+    CANFilter best = CAN_FILTER_ACCEPT_ALL;
+    if (count == 0) return best;
+
+    // Single filter over everything
+    Pattern all;
+    for (size_t i = 0; i < count; i++) merge(&all, single_pattern(rules[i]), i == 0);
+    best.acceptance_code = all.code;
+    best.acceptance_mask = all.dont_care;
+    best.single_filter = true;
+    if (count < 2 || count > CAN_FILTER_MAX_RULES) return best;
+
+    // Dual: sort by 16-bit pattern (IDs sharing high bits end up adjacent),
+    // then try every split point into filter 1 / filter 2
+    Pattern sorted[CAN_FILTER_MAX_RULES];
+    for (size_t i = 0; i < count; i++) {
+        Pattern p = dual_pattern(rules[i]);
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1].code > p.code; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = p;
+    }
+
+    // suffix[i] = merge of sorted[i..count)
+    Pattern suffix[CAN_FILTER_MAX_RULES];
+    for (size_t i = count; i-- > 0;) {
+        suffix[i] = sorted[i];
+        if (i + 1 < count) merge(&suffix[i], suffix[i + 1], false);
+    }
+
+    float best_score = score(&best);
+    Pattern prefix;
+    for (size_t split = 1; split < count; split++) {
+        merge(&prefix, sorted[split - 1], split == 1);
+
+        // Filter 2's low nibble doubles as filter 1's data[0] bits: never compared
+        CANFilter dual;
+        dual.acceptance_code = (prefix.code << 16) | (suffix[split].code & 0xFFF0);
+        dual.acceptance_mask = (prefix.dont_care << 16) | suffix[split].dont_care | 0xF;
+        dual.single_filter = false;
+
+        float s = score(&dual);
+        if (s < best_score) {
+            best = dual;
+            best_score = s;
+        }
+    }
+    return best;
+}
+
+// ============================================================================
+// ACCEPT (controller emulation)
+// ============================================================================
+
+bool can_filter_accepts(const CANFilter* filter, const CANFrame* frame) {
+    uint32_t code = filter->acceptance_code;
+    uint32_t care = ~filter->acceptance_mask;
+    uint8_t d0 = frame->len > 0 ? frame->data[0] : 0;
+    uint8_t d1 = frame->len > 1 ? frame->data[1] : 0;
+
+    if (filter->single_filter) {
+        uint32_t word;
+        if (frame->extended) {
+            word = frame->id << 3;
+        } else {
+            word = (frame->id << 21) | ((uint32_t)d0 << 8) | d1;
+            care &= ~0x000F0000u;   // Unused bits
+        }
+        return ((word ^ code) & care) == 0;
+    }
+
+    if (frame->extended) {
+        uint32_t high = (frame->id >> 13) & 0xFFFF;
+        uint32_t word = (high << 16) | high;
+        uint32_t diff = (word ^ code) & care;
+        return (diff & 0xFFFF0000) == 0 || (diff & 0x0000FFFF) == 0;
+    }
+
+    uint32_t word1 = (frame->id << 21) | ((uint32_t)(d0 >> 4) << 16) | (d0 & 0xF);
+    uint32_t word2 = frame->id << 5;
+    return ((word1 ^ code) & care & 0xFFFF000F) == 0 ||
+           ((word2 ^ code) & care & 0x0000FFF0) == 0;
+}
@@ -0,0 +1,36 @@
+#ifndef LEAF_CAN_FILTER_H
+#define LEAF_CAN_FILTER_H
+
+// ============================================================================
+// ACCEPTANCE FILTER (TWAI / SJA1000 code + mask)
+// ============================================================================
+// Computes the tightest TWAI acceptance filter that still passes every
+// subscribed ID, and emulates the controller's accept decision so the math
+// can be checked on the host (and so the Linux port filters like hardware).
+//
+// Register layout (mask bit 1 = don't care):
+//   single, standard:  31:21 ID, 20 RTR, 19:16 unused, 15:8 data[0], 7:0 data[1]
+//   single, extended:  31:3  ID, 2 RTR
+//   dual,   standard:  filter 1 = 31:21 ID, 20 RTR, 19:16 + 3:0 data[0]
+//                      filter 2 = 15:5  ID, 4 RTR
+//   dual,   extended:  filter 1 = 31:16 ID[28:13], filter 2 = 15:0 ID[28:13]
+
+#include "LeafCANPort.h"
+
+// One subscription as seen by the filter: IDs with (x & mask) == (id & mask)
+typedef struct {
+    uint32_t id;
+    uint32_t mask;          // 0x7FF / 0x1FFFFFFF for an exact ID
+    bool extended;          // 29-bit ID space
+} CANFilterRule;
+
+// Tightest single- or dual-mode filter passing every rule; count 0 -> accept all
+CANFilter can_filter_compute(const CANFilterRule* rules, size_t count);
+
+// Controller decision for one frame (RTR frames are not used on this bus)
+bool can_filter_accepts(const CANFilter* filter, const CANFrame* frame);
+
+// Fraction of the 11-bit (or 29-bit) ID space the filter lets through
+float can_filter_coverage(const CANFilter* filter, bool extended);
+
+#endif // LEAF_CAN_FILTER_H
@@ -0,0 +1,130 @@
+#ifndef LEAF_CAN_HEALTH_H
+#define LEAF_CAN_HEALTH_H
+
+// ============================================================================
+// BUS HEALTH (error state tracking + bus-off recovery backoff)
+// ============================================================================
+// The port feeds it events as the controller reports them (TWAI alerts,
+// SocketCAN error frames) and asks recoveryDue() when to start a bus-off
+// recovery. The first recovery waits CAN_PORT_RECOVERY_MIN_MS; a bus-off
+// within CAN_PORT_RECOVERY_STABLE_MS of the last recovery doubles the wait,
+// up to CAN_PORT_RECOVERY_MAX_MS, so a shorted or misconfigured bus is not
+// hammered with recovery sequences.
+//
+// Time is passed in (millis()) so the host bench can drive it directly.
+// No locking: the owner serializes calls.
+
+#include "LeafCANPort.h"
+#include <string.h>
+
+static inline const char* can_bus_state_name(CANBusState state) {
+    switch (state) {
+        case CAN_BUS_ERROR_ACTIVE:  return "error-active";
+        case CAN_BUS_ERROR_WARNING: return "error-warning";
+        case CAN_BUS_ERROR_PASSIVE: return "error-passive";
+        case CAN_BUS_OFF:           return "bus-off";
+        case CAN_BUS_RECOVERING:    return "recovering";
+        default:                    return "?";
+    }
+}
+
+class LeafCANHealth {
+public:
+    LeafCANHealth() { reset(0); }
+
+    void reset(uint32_t now_ms) {
+        memset(&health, 0, sizeof(health));
+        health.state = CAN_BUS_ERROR_ACTIVE;
+        health.backoff_ms = CAN_PORT_RECOVERY_MIN_MS;
+        since_ms = now_ms;
+        recovered_ms = 0;
+        has_recovered = false;
+    }
+
+    CANBusState state() const { return health.state; }
+
+    // Count an event that never changes the state (per-frame, no clock read)
+    void count(CANBusEvent event) { health.events[event]++; }
+
+    // Count the event and follow the state change it implies; true if the state changed
+    bool onEvent(CANBusEvent event, uint32_t now_ms) {
+        health.events[event]++;
+        CANBusState before = health.state;
+
+        switch (event) {
+            case CAN_EVENT_ERROR_WARNING:
+                if (health.state == CAN_BUS_ERROR_ACTIVE) enter(CAN_BUS_ERROR_WARNING, now_ms);
+                break;
+            case CAN_EVENT_ERROR_PASSIVE:
+                if (health.state <= CAN_BUS_ERROR_WARNING) enter(CAN_BUS_ERROR_PASSIVE, now_ms);
+                break;
+            case CAN_EVENT_ERROR_ACTIVE:
+                if (health.state <= CAN_BUS_ERROR_PASSIVE) enter(CAN_BUS_ERROR_ACTIVE, now_ms);
+                break;
+            case CAN_EVENT_BUS_OFF:
+                if (health.state == CAN_BUS_OFF) break;
+                if (has_recovered && now_ms - recovered_ms < CAN_PORT_RECOVERY_STABLE_MS) {
+                    health.backoff_ms *= 2;
+                    if (health.backoff_ms > CAN_PORT_RECOVERY_MAX_MS) health.backoff_ms = CAN_PORT_RECOVERY_MAX_MS;
+                } else {
+                    health.backoff_ms = CAN_PORT_RECOVERY_MIN_MS;
+                }
+                enter(CAN_BUS_OFF, now_ms);
+                break;
+            case CAN_EVENT_BUS_RECOVERED:
+                if (health.state < CAN_BUS_OFF) break;
+                health.recoveries++;
+                recovered_ms = now_ms;
+                has_recovered = true;
+                enter(CAN_BUS_ERROR_ACTIVE, now_ms);
+                break;
+            default:
+                break;
+        }
+        return health.state != before;
+    }
+
+    // The port reinstalled the controller (driver restart): the new one is
+    // error-active whatever state the old one was in, including bus-off or
+    // mid-recovery. Counters and the backoff history are kept.
+    void onRestart(uint32_t now_ms) {
+        health.events[CAN_EVENT_ERROR_ACTIVE]++;
+        if (health.state != CAN_BUS_ERROR_ACTIVE) enter(CAN_BUS_ERROR_ACTIVE, now_ms);
+    }
+
+    // True once the backoff after a bus-off has elapsed; the caller then
+    // starts the controller's recovery (state becomes CAN_BUS_RECOVERING)
+    bool recoveryDue(uint32_t now_ms) {
+        if (health.state != CAN_BUS_OFF || now_ms - since_ms < health.backoff_ms) return false;
+        health.recovery_attempts++;
+        enter(CAN_BUS_RECOVERING, now_ms);
+        return true;
+    }
+
+    // How long the port may block before recoveryDue() needs asking again
+    uint32_t msUntilRecovery(uint32_t now_ms) const {
+        if (health.state != CAN_BUS_OFF) return UINT32_MAX;
+        uint32_t elapsed = now_ms - since_ms;
+        return elapsed >= health.backoff_ms ? 0 : health.backoff_ms - elapsed;
+    }
+
+    void snapshot(CANBusHealth* out, uint32_t now_ms) const {
+        *out = health;
+        out->state_ms = now_ms - since_ms;
+        out->dwell_ms[health.state] += out->state_ms;
+    }
+
+private:
+    void enter(CANBusState state, uint32_t now_ms) {
+        health.dwell_ms[health.state] += now_ms - since_ms;
+        since_ms = now_ms;
+        health.state = state;
+    }
+
+    CANBusHealth health;
+    uint32_t since_ms;          // Entered the current state
+    uint32_t recovered_ms;      // Last completed recovery
+    bool has_recovered;
+};
+
+#endif // LEAF_CAN_HEALTH_H
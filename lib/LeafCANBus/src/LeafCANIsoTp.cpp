@@ -0,0 +1,271 @@
+#include "LeafCANIsoTp.h"
+
+// Protocol control information (high nibble of byte 0)
+#define PCI_SINGLE       0x0
+#define PCI_FIRST        0x1
+#define PCI_CONSECUTIVE  0x2
+#define PCI_FLOW_CONTROL 0x3
+
+#define FC_CONTINUE 0x0
+#define FC_WAIT     0x1
+#define FC_OVERFLOW 0x2
+
+LeafCANIsoTp::LeafCANIsoTp() : bus(nullptr), tx_state(TX_IDLE), tx_data(nullptr), tx_len(0),
+                               rx_buffer(nullptr), rx_size(0), rx_callback(nullptr),
+                               rx_context(nullptr), rx_active(false) {
+    memset(&config, 0, sizeof(config));
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool LeafCANIsoTp::begin(LeafCANBus& can_bus, const IsoTpConfig& cfg) {
+    bus = &can_bus;
+    config = cfg;
+    if (!bus->subscribe(config.rx_id, onFrame, this)) return false;
+    Serial.printf("[ISOTP] TX 0x%03X, RX 0x%03X, BS %u, STmin 0x%02X\n",
+                  config.tx_id, config.rx_id, config.block_size, config.st_min);
+    return true;
+}
+
+void LeafCANIsoTp::setReceiveBuffer(uint8_t* buffer, uint32_t size, isotp_rx_callback_t callback, void* context) {
+    rx_buffer = buffer;
+    rx_size = size;
+    rx_callback = callback;
+    rx_context = context;
+    rx_active = false;
+}
+
+uint32_t LeafCANIsoTp::stMinToUs(uint8_t raw) {
+    if (raw <= 0x7F) return raw * 1000u;
+    if (raw >= 0xF1 && raw <= 0xF9) return (raw - 0xF0) * 100u;
+    return 127000;  // Reserved values: treat as the maximum (ISO 15765-2)
+}
+
+// ============================================================================
+// SEND
+// ============================================================================
+
+bool LeafCANIsoTp::sendFrame(const uint8_t* payload, uint8_t len) {
+    uint8_t frame[8];
+    memcpy(frame, payload, len);
+    if (config.padding != ISOTP_NO_PADDING && len < 8) {
+        memset(frame + len, (uint8_t)config.padding, 8 - len);
+        len = 8;
+    }
+    if (!bus->send(config.tx_id, frame, len)) return false;
+    stats.frames_sent++;
+    return true;
+}
+
+void LeafCANIsoTp::sendFlowControl(uint8_t status) {
+    uint8_t fc[3] = { (uint8_t)(PCI_FLOW_CONTROL << 4 | status), config.block_size, config.st_min };
+    sendFrame(fc, sizeof(fc));
+}
+
+bool LeafCANIsoTp::send(const uint8_t* data, uint32_t len) {
+    if (!bus || tx_state != TX_IDLE || len == 0) return false;
+
+    uint8_t frame[8];
+    if (len <= 7) {
+        frame[0] = PCI_SINGLE << 4 | len;
+        memcpy(frame + 1, data, len);
+        if (!sendFrame(frame, 1 + len)) return false;
+        stats.messages_sent++;
+        return true;
+    }
+
+    uint8_t header;
+    if (len <= ISOTP_MAX_12BIT_LEN) {
+        frame[0] = PCI_FIRST << 4 | len >> 8;
+        frame[1] = len & 0xFF;
+        header = 2;
+    } else {
+        frame[0] = PCI_FIRST << 4;
+        frame[1] = 0;
+        frame[2] = len >> 24;
+        frame[3] = len >> 16;
+        frame[4] = len >> 8;
+        frame[5] = len;
+        header = 6;
+    }
+    memcpy(frame + header, data, 8 - header);
+    if (!sendFrame(frame, 8)) return false;
+
+    tx_data = data;
+    tx_len = len;
+    tx_offset = 8 - header;
+    tx_seq = 1;
+    tx_waits = 0;
+    tx_timer_ms = millis();
+    tx_state = TX_WAIT_FC;
+    return true;
+}
+
+void LeafCANIsoTp::pumpTx() {
+    while (tx_state == TX_SENDING) {
+        uint32_t now = micros();
+        if (tx_st_min_us && now - tx_last_us < tx_st_min_us) return;
+
+        // Leave the rest for the next process() rather than overfill the TX queue
+        if (bus->getTxQueueFree() == 0) return;
+
+        uint8_t frame[8];
+        uint32_t n = tx_len - tx_offset < 7 ? tx_len - tx_offset : 7;
+        frame[0] = PCI_CONSECUTIVE << 4 | tx_seq;
+        memcpy(frame + 1, tx_data + tx_offset, n);
+        if (!sendFrame(frame, 1 + n)) return;
+
+        tx_offset += n;
+        tx_seq = (tx_seq + 1) & 0xF;
+        tx_last_us = now;
+
+        if (tx_offset >= tx_len) {
+            stats.messages_sent++;
+            tx_state = TX_IDLE;
+        } else if (tx_block_size && --tx_block_left == 0) {
+            tx_timer_ms = millis();
+            tx_state = TX_WAIT_FC;
+        }
+    }
+}
+
+void LeafCANIsoTp::handleFlowControl(const uint8_t* data, uint8_t len) {
+    if (tx_state != TX_WAIT_FC || len < 3) return;
+
+    switch (data[0] & 0xF) {
+        case FC_CONTINUE:
+            tx_block_size = data[1];
+            tx_block_left = data[1];
+            tx_st_min_us = stMinToUs(data[2]);
+            tx_last_us = micros() - tx_st_min_us;
+            tx_waits = 0;
+            tx_state = TX_SENDING;
+            pumpTx();
+            break;
+        case FC_WAIT:
+            stats.wait_frames++;
+            tx_timer_ms = millis();
+            if (++tx_waits > ISOTP_MAX_WAIT_FRAMES) {
+                stats.timeouts++;
+                tx_state = TX_IDLE;
+            }
+            break;
+        default:
+            stats.overflows++;
+            tx_state = TX_IDLE;
+            break;
+    }
+}
+
+// ============================================================================
+// RECEIVE
+// ============================================================================
+
+void LeafCANIsoTp::onFrame(const uint8_t* data, uint8_t len, void* self) {
+    LeafCANIsoTp* tp = (LeafCANIsoTp*)self;
+    if (len == 0) return;
+    tp->stats.frames_received++;
+
+    switch (data[0] >> 4) {
+        case PCI_SINGLE:       tp->handleSingle(data, len); break;
+        case PCI_FIRST:        tp->handleFirst(data, len); break;
+        case PCI_CONSECUTIVE:  tp->handleConsecutive(data, len); break;
+        case PCI_FLOW_CONTROL: tp->handleFlowControl(data, len); break;
+        default: break;
+    }
+}
+
+void LeafCANIsoTp::handleSingle(const uint8_t* data, uint8_t len) {
+    uint8_t n = data[0] & 0xF;
+    if (n == 0 || n > len - 1) return;
+
+    // A new message ends the one in progress
+    if (rx_active) {
+        stats.sequence_errors++;
+        rx_active = false;
+    }
+    if (!rx_buffer || n > rx_size) {
+        stats.overflows++;
+        return;
+    }
+
+    memcpy(rx_buffer, data + 1, n);
+    stats.messages_received++;
+    if (rx_callback) rx_callback(rx_buffer, n, rx_context);
+}
+
+void LeafCANIsoTp::handleFirst(const uint8_t* data, uint8_t len) {
+    if (len < 8) return;
+
+    uint32_t msg_len = (uint32_t)(data[0] & 0xF) << 8 | data[1];
+    uint8_t header = 2;
+    if (msg_len == 0) {
+        msg_len = (uint32_t)data[2] << 24 | (uint32_t)data[3] << 16 | (uint32_t)data[4] << 8 | data[5];
+        header = 6;
+    }
+    if (msg_len < 8) return;
+
+    if (rx_active) {
+        stats.sequence_errors++;
+        rx_active = false;
+    }
+    if (!rx_buffer || msg_len > rx_size) {
+        stats.overflows++;
+        sendFlowControl(FC_OVERFLOW);
+        return;
+    }
+
+    memcpy(rx_buffer, data + header, 8 - header);
+    rx_len = msg_len;
+    rx_offset = 8 - header;
+    rx_seq = 1;
+    rx_block_left = config.block_size;
+    rx_timer_ms = millis();
+    rx_active = true;
+    sendFlowControl(FC_CONTINUE);
+}
+
+void LeafCANIsoTp::handleConsecutive(const uint8_t* data, uint8_t len) {
+    if (!rx_active) return;
+    if ((data[0] & 0xF) != rx_seq) {
+        stats.sequence_errors++;
+        rx_active = false;
+        return;
+    }
+
+    uint32_t n = rx_len - rx_offset < 7 ? rx_len - rx_offset : 7;
+    if (len < 1 + n) {
+        stats.sequence_errors++;
+        rx_active = false;
+        return;
+    }
+    memcpy(rx_buffer + rx_offset, data + 1, n);
+    rx_offset += n;
+    rx_seq = (rx_seq + 1) & 0xF;
+    rx_timer_ms = millis();
+
+    if (rx_offset >= rx_len) {
+        rx_active = false;
+        stats.messages_received++;
+        if (rx_callback) rx_callback(rx_buffer, rx_len, rx_context);
+    } else if (config.block_size && --rx_block_left == 0) {
+        rx_block_left = config.block_size;
+        sendFlowControl(FC_CONTINUE);
+    }
+}
+
+// ============================================================================
+// PROCESS
+// ============================================================================
+
+void LeafCANIsoTp::process() {
+    uint32_t now = millis();
+    if (tx_state == TX_WAIT_FC && now - tx_timer_ms > ISOTP_FC_TIMEOUT_MS) {
+        stats.timeouts++;
+        tx_state = TX_IDLE;
+    }
+    if (rx_active && now - rx_timer_ms > ISOTP_CF_TIMEOUT_MS) {
+        stats.timeouts++;
+        rx_active = false;
+    }
+    pumpTx();
+}
@@ -0,0 +1,122 @@
+#ifndef LEAF_CAN_ISOTP_H
+#define LEAF_CAN_ISOTP_H
+
+// ============================================================================
+// ISO-TP (ISO 15765-2) TRANSPORT OVER LeafCANBus
+// ============================================================================
+// Carries messages larger than 8 bytes (cell tables, config blobs, dumps)
+// between two nodes on a pair of CAN IDs, normal addressing, classic CAN:
+//
+//   SF  0x0L + up to 7 bytes            (L = length)
+//   FF  0x1L LL + 6 bytes               (12-bit length, up to 4095)
+//       0x10 00 LLLLLLLL + 2 bytes      (32-bit length, beyond 4095)
+//   CF  0x2N + 7 bytes                  (N = sequence, 1..15, 0, 1, ...)
+//   FC  0x3S BS STmin                   (S: 0 continue, 1 wait, 2 overflow)
+//
+// Frames are sent without padding unless a padding byte is configured, the
+// same as a Linux CAN_ISOTP socket with default options, which this
+// interoperates with (tx_id/rx_id swapped on the other side).
+//
+// Zero-copy: received payload is written straight into the caller's buffer
+// (no reassembly copy) and handed to the callback there; send() transmits
+// from the caller's buffer, which must stay untouched until txBusy() is false.
+//
+// Frames arrive through a LeafCANBus subscription (so in process()); call
+// isotp.process() in loop() as well to pace consecutive frames and time out.
+
+#include "LeafCANBus.h"
+
+#define ISOTP_FC_TIMEOUT_MS   1000  // N_Bs: sender waiting for flow control
+#define ISOTP_CF_TIMEOUT_MS   1000  // N_Cr: receiver waiting for the next consecutive frame
+#define ISOTP_MAX_WAIT_FRAMES 10    // FC WAIT frames accepted in a row
+#define ISOTP_MAX_12BIT_LEN   4095
+#define ISOTP_NO_PADDING      -1
+
+// Complete message, in the buffer given to setReceiveBuffer()
+typedef void (*isotp_rx_callback_t)(uint8_t* data, uint32_t len, void* context);
+
+typedef struct {
+    uint32_t tx_id;         // Our frames (data and flow control)
+    uint32_t rx_id;         // Peer's frames
+    uint8_t block_size;     // Consecutive frames the peer may send per FC (0 = all)
+    uint8_t st_min;         // Gap we ask the peer for: 0x00-0x7F ms, 0xF1-0xF9 100-900 us
+    int16_t padding;        // Fill byte for short frames, or ISOTP_NO_PADDING
+} IsoTpConfig;
+
+typedef struct {
+    uint32_t messages_sent;
+    uint32_t messages_received;
+    uint32_t frames_sent;
+    uint32_t frames_received;
+    uint32_t wait_frames;       // FC WAIT received
+    uint32_t timeouts;          // N_Bs / N_Cr expired, or too many WAITs
+    uint32_t overflows;         // Message larger than the buffer (either side)
+    uint32_t sequence_errors;   // Out-of-order CF, or a new message interrupting one
+} IsoTpStats;
+
+class LeafCANIsoTp {
+public:
+    LeafCANIsoTp();
+
+    // Subscribe to config.rx_id on an initialized bus
+    bool begin(LeafCANBus& bus, const IsoTpConfig& config);
+
+    // Where incoming messages are assembled; larger messages are refused
+    // with FC overflow. The buffer is reused for the next message once the
+    // callback returns.
+    void setReceiveBuffer(uint8_t* buffer, uint32_t size, isotp_rx_callback_t callback, void* context);
+
+    // Start sending a message; false while the previous one is in progress
+    bool send(const uint8_t* data, uint32_t len);
+
+    // Pace consecutive frames (STmin, TX queue room) and check timeouts
+    void process();
+
+    bool txBusy() const { return tx_state != TX_IDLE; }
+    const IsoTpStats& getStats() const { return stats; }
+
+private:
+    enum TxState { TX_IDLE, TX_WAIT_FC, TX_SENDING };
+
+    static void onFrame(const uint8_t* data, uint8_t len, void* self);
+    void handleSingle(const uint8_t* data, uint8_t len);
+    void handleFirst(const uint8_t* data, uint8_t len);
+    void handleConsecutive(const uint8_t* data, uint8_t len);
+    void handleFlowControl(const uint8_t* data, uint8_t len);
+
+    bool sendFrame(const uint8_t* payload, uint8_t len);
+    void sendFlowControl(uint8_t status);
+    void pumpTx();
+    static uint32_t stMinToUs(uint8_t raw);
+
+    LeafCANBus* bus;
+    IsoTpConfig config;
+    IsoTpStats stats;
+
+    // Sender
+    TxState tx_state;
+    const uint8_t* tx_data;
+    uint32_t tx_len;
+    uint32_t tx_offset;
+    uint8_t tx_seq;
+    uint8_t tx_block_size;      // From the peer's FC
+    uint8_t tx_block_left;
+    uint32_t tx_st_min_us;
+    uint32_t tx_last_us;        // Last CF sent
+    uint32_t tx_timer_ms;       // Started waiting for FC
+    uint8_t tx_waits;
+
+    // Receiver
+    uint8_t* rx_buffer;
+    uint32_t rx_size;
+    isotp_rx_callback_t rx_callback;
+    void* rx_context;
+    bool rx_active;
+    uint32_t rx_len;
+    uint32_t rx_offset;
+    uint8_t rx_seq;
+    uint8_t rx_block_left;
+    uint32_t rx_timer_ms;       // Last frame of the message in progress
+};
+
+#endif // LEAF_CAN_ISOTP_H
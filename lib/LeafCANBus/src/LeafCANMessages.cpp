@@ -1,5 +1,6 @@
 #include "LeafCANMessages.h"
 #include <string.h>
+#include <math.h>
 
 // ============================================================================
 // HELPER FUNCTIONS
@@ -22,6 +23,34 @@ static void int16_to_bytes(int16_t value, uint8_t* data, uint8_t offset) {
     uint16_to_bytes((uint16_t)value, data, offset);
 }
 
+static int32_t bytes_to_int32(const uint8_t* data, uint8_t offset) {
+    return (int32_t)((uint32_t)data[offset] | ((uint32_t)data[offset + 1] << 8) |
+                     ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24));
+}
+
+static void int32_to_bytes(int32_t value, uint8_t* data, uint8_t offset) {
+    uint32_t v = (uint32_t)value;
+    data[offset] = v & 0xFF;
+    data[offset + 1] = (v >> 8) & 0xFF;
+    data[offset + 2] = (v >> 16) & 0xFF;
+    data[offset + 3] = (v >> 24) & 0xFF;
+}
+
+// Physical value -> raw signal. Rounds to nearest instead of truncating so that
+// unpack followed by pack reproduces the original raw value (e.g. raw 15 decodes
+// to 15 * 0.01f, which divides back to just under 15 and would truncate to 14).
+static uint16_t scale_to_uint16(float value, float scale) {
+    return (uint16_t)lroundf(value / scale);
+}
+
+static int16_t scale_to_int16(float value, float scale) {
+    return (int16_t)lroundf(value / scale);
+}
+
+static uint8_t scale_to_uint8(float value, float scale) {
+    return (uint8_t)lroundf(value / scale);
+}
+
 // ============================================================================
 // INVERTER TELEMETRY (0x1F2)
 // ============================================================================
@@ -42,8 +71,8 @@ void pack_inverter_telemetry(const void* state, uint8_t* data, uint8_t* len) {
     const InverterState* s = (const InverterState*)state;
 
     memset(data, 0, 8);
-    uint16_to_bytes((uint16_t)(s->voltage / 0.5f), data, 0);
-    int16_to_bytes((int16_t)(s->current / 0.1f), data, 2);
+    uint16_to_bytes(scale_to_uint16(s->voltage, 0.5f), data, 0);
+    int16_to_bytes(scale_to_int16(s->current, 0.1f), data, 2);
     data[4] = (uint8_t)(s->temp_inverter + 40);
     data[5] = (uint8_t)(s->temp_motor + 40);
     data[6] = s->status_flags;
@@ -71,8 +100,8 @@ void pack_battery_soc(const void* state, uint8_t* data, uint8_t* len) {
     memset(data, 0, 8);
     data[0] = (s->soc_percent & 0x7F) << 1;
     uint16_to_bytes(s->gids, data, 2);
-    uint16_to_bytes((uint16_t)(s->pack_voltage / 0.5f), data, 4);
-    int16_to_bytes((int16_t)(s->pack_current / 0.1f), data, 6);
+    uint16_to_bytes(scale_to_uint16(s->pack_voltage, 0.5f), data, 4);
+    int16_to_bytes(scale_to_int16(s->pack_current, 0.1f), data, 6);
     *len = 8;
 }
 
@@ -99,7 +128,7 @@ void pack_battery_temp(const void* state, uint8_t* data, uint8_t* len) {
     data[1] = (uint8_t)(s->temp_min + 40);
     data[2] = (uint8_t)(s->temp_avg + 40);
     data[3] = s->sensor_count;
-    *len = 4;
+    *len = 8;
 }
 
 // ============================================================================
@@ -119,7 +148,7 @@ void pack_vehicle_speed(const void* state, uint8_t* data, uint8_t* len) {
     const VehicleSpeedState* s = (const VehicleSpeedState*)state;
 
     memset(data, 0, 8);
-    uint16_to_bytes((uint16_t)(s->speed_kmh / 0.01f), data, 0);
+    uint16_to_bytes(scale_to_uint16(s->speed_kmh, 0.01f), data, 0);
     *len = 2;
 }
 
@@ -165,8 +194,8 @@ void pack_charger_status(const void* state, uint8_t* data, uint8_t* len) {
 
     memset(data, 0, 8);
     data[0] = s->charging ? 0x01 : 0x00;
-    data[1] = (uint8_t)(s->charge_current / 0.5f);
-    uint16_to_bytes((uint16_t)(s->charge_voltage / 0.1f), data, 2);
+    data[1] = scale_to_uint8(s->charge_current, 0.5f);
+    uint16_to_bytes(scale_to_uint16(s->charge_voltage, 0.1f), data, 2);
     uint16_to_bytes(s->charge_time, data, 4);
     *len = 8;
 }
@@ -180,9 +209,7 @@ void unpack_gps_position(const uint8_t* data, uint8_t len, void* state) {
     GPSPositionState* s = (GPSPositionState*)state;
 
     // Latitude: 4 bytes, scaled by 1e7
-    int32_t lat_raw = (int32_t)data[0] | ((int32_t)data[1] << 8) |
-                      ((int32_t)data[2] << 16) | ((int32_t)data[3] << 24);
-    s->latitude = (double)lat_raw / 1e7;
+    s->latitude = (double)bytes_to_int32(data, 0) / 1e7;
 
     // Altitude/satellites/fix packed in remaining bytes
     s->altitude = (int16_t)bytes_to_int16(data, 4);
@@ -196,14 +223,10 @@ void pack_gps_position(const void* state, uint8_t* data, uint8_t* len) {
 
     memset(data, 0, 8);
 
-    // Latitude: 4 bytes, scaled by 1e7
-    int32_t lat_raw = (int32_t)(s->latitude * 1e7);
-    data[0] = lat_raw & 0xFF;
-    data[1] = (lat_raw >> 8) & 0xFF;
-    data[2] = (lat_raw >> 16) & 0xFF;
-    data[3] = (lat_raw >> 24) & 0xFF;
+    // Latitude: 4 bytes, scaled by 1e7 (longitude travels in 0x711)
+    int32_to_bytes((int32_t)llround(s->latitude * 1e7), data, 0);
 
-    int16_to_bytes((int16_t)s->altitude, data, 4);
+    int16_to_bytes((int16_t)lroundf(s->altitude), data, 4);
     data[6] = s->satellites;
     data[7] = s->fix_quality;
     *len = 8;
@@ -217,9 +240,9 @@ void unpack_gps_velocity(const uint8_t* data, uint8_t len, void* state) {
     if (len < 8 || !state) return;
     GPSVelocityState* s = (GPSVelocityState*)state;
 
-    // Longitude: 4 bytes, scaled by 1e7 (shared with position logically, but sent here)
-    int32_t lon_raw = (int32_t)data[0] | ((int32_t)data[1] << 8) |
-                      ((int32_t)data[2] << 16) | ((int32_t)data[3] << 24);
+    // Longitude: 4 bytes, scaled by 1e7 (0x710 has no room left after latitude)
+    s->longitude = (double)bytes_to_int32(data, 0) / 1e7;
+
     // Speed and heading
     s->speed_kmh = bytes_to_uint16(data, 4) * 0.01f;
     s->heading = bytes_to_uint16(data, 6) * 0.01f;
@@ -230,11 +253,9 @@ void pack_gps_velocity(const void* state, uint8_t* data, uint8_t* len) {
     const GPSVelocityState* s = (const GPSVelocityState*)state;
 
     memset(data, 0, 8);
-
-    // Note: In a real implementation, you'd pass longitude from GPS state
-    // For now, we'll pack speed and heading
-    uint16_to_bytes((uint16_t)(s->speed_kmh / 0.01f), data, 4);
-    uint16_to_bytes((uint16_t)(s->heading / 0.01f), data, 6);
+    int32_to_bytes((int32_t)llround(s->longitude * 1e7), data, 0);
+    uint16_to_bytes(scale_to_uint16(s->speed_kmh, 0.01f), data, 4);
+    uint16_to_bytes(scale_to_uint16(s->heading, 0.01f), data, 6);
     *len = 8;
 }
 
@@ -294,6 +315,15 @@ void pack_body_temp(const void* state, uint8_t* data, uint8_t* len) {
     *len = 8;
 }
 
+bool body_temp_changed(const uint8_t* sent, const uint8_t* data, uint8_t len) {
+    if (len < 8) return true;
+    for (uint8_t offset = 0; offset < 8; offset += 2) {
+        int32_t delta = bytes_to_int16(data, offset) - bytes_to_int16(sent, offset);
+        if (delta >= BODY_TEMP_DEADBAND || delta <= -BODY_TEMP_DEADBAND) return true;
+    }
+    return false;
+}
+
 // ============================================================================
 // BODY VOLTAGE MONITORING (0x721)
 // ============================================================================
@@ -312,9 +342,9 @@ void pack_body_voltage(const void* state, uint8_t* data, uint8_t* len) {
     const BodyVoltageState* s = (const BodyVoltageState*)state;
 
     memset(data, 0, 8);
-    uint16_to_bytes((uint16_t)(s->voltage_12v / 0.01f), data, 0);
-    uint16_to_bytes((uint16_t)(s->voltage_5v / 0.01f), data, 2);
-    uint16_to_bytes((uint16_t)(s->current_12v / 0.01f), data, 4);
+    uint16_to_bytes(scale_to_uint16(s->voltage_12v, 0.01f), data, 0);
+    uint16_to_bytes(scale_to_uint16(s->voltage_5v, 0.01f), data, 2);
+    uint16_to_bytes(scale_to_uint16(s->current_12v, 0.01f), data, 4);
     *len = 6;
 }
 
@@ -368,10 +398,10 @@ void pack_emboo_pack_status(const void* state, uint8_t* data, uint8_t* len) {
     const EmbooPackStatus* s = (const EmbooPackStatus*)state;
 
     memset(data, 0, 8);
-    int16_to_bytes_be((int16_t)(s->pack_current / 0.1f), data, 0);
-    uint16_to_bytes_be((uint16_t)(s->pack_voltage / 0.1f), data, 2);
-    uint16_to_bytes_be((uint16_t)(s->pack_amphours / 0.1f), data, 4);
-    data[6] = (uint8_t)(s->pack_soc / 0.5f);
+    int16_to_bytes_be(scale_to_int16(s->pack_current, 0.1f), data, 0);
+    uint16_to_bytes_be(scale_to_uint16(s->pack_voltage, 0.1f), data, 2);
+    uint16_to_bytes_be(scale_to_uint16(s->pack_amphours, 0.1f), data, 4);
+    data[6] = scale_to_uint8(s->pack_soc, 0.5f);
     *len = 8;
 }
 
@@ -403,8 +433,8 @@ void pack_emboo_pack_stats(const void* state, uint8_t* data, uint8_t* len) {
     memset(data, 0, 8);
     uint16_to_bytes_be(s->relay_state, data, 0);
     data[2] = (uint8_t)s->high_temp;
-    uint16_to_bytes_be((uint16_t)(s->input_voltage / 0.1f), data, 3);
-    uint16_to_bytes_be((uint16_t)(s->summed_voltage / 0.01f), data, 5);
+    uint16_to_bytes_be(scale_to_uint16(s->input_voltage, 0.1f), data, 3);
+    uint16_to_bytes_be(scale_to_uint16(s->summed_voltage, 0.01f), data, 5);
     *len = 8;
 }
 
@@ -462,13 +492,13 @@ void pack_emboo_cell_voltage(const void* state, uint8_t* data, uint8_t* len) {
 
     memset(data, 0, 8);
     data[0] = s->cell_id;
-    uint16_to_bytes_be((uint16_t)(s->cell_voltage / 0.0001f), data, 1);
+    uint16_to_bytes_be(scale_to_uint16(s->cell_voltage, 0.0001f), data, 1);
 
-    uint16_t resistance_raw = (uint16_t)(s->cell_resistance / 0.01f) & 0x7FFF;
+    uint16_t resistance_raw = scale_to_uint16(s->cell_resistance, 0.01f) & 0x7FFF;
     if (s->cell_balancing) resistance_raw |= 0x8000;
     uint16_to_bytes_be(resistance_raw, data, 3);
 
-    uint16_to_bytes_be((uint16_t)(s->cell_open_voltage / 0.0001f), data, 5);
+    uint16_to_bytes_be(scale_to_uint16(s->cell_open_voltage, 0.0001f), data, 5);
     *len = 8;
 }
 
@@ -516,10 +546,10 @@ void pack_emboo_pack_summary(const void* state, uint8_t* data, uint8_t* len) {
     const EmbooPackSummary* s = (const EmbooPackSummary*)state;
 
     memset(data, 0, 8);
-    uint16_to_bytes((uint16_t)(s->max_pack_voltage / 0.1f), data, 0);
-    uint16_to_bytes((uint16_t)(s->pack_ccl / 0.1f), data, 2);
-    uint16_to_bytes((uint16_t)(s->pack_dcl / 0.1f), data, 4);
-    uint16_to_bytes((uint16_t)(s->min_pack_voltage / 0.1f), data, 6);
+    uint16_to_bytes(scale_to_uint16(s->max_pack_voltage, 0.1f), data, 0);
+    uint16_to_bytes(scale_to_uint16(s->pack_ccl, 0.1f), data, 2);
+    uint16_to_bytes(scale_to_uint16(s->pack_dcl, 0.1f), data, 4);
+    uint16_to_bytes(scale_to_uint16(s->min_pack_voltage, 0.1f), data, 6);
     *len = 8;
 }
 
@@ -544,7 +574,7 @@ void pack_emboo_pack_data1(const void* state, uint8_t* data, uint8_t* len) {
     memset(data, 0, 8);
     uint16_to_bytes(s->pack_soc_int, data, 0);
     uint16_to_bytes(s->pack_health, data, 2);
-    uint16_to_bytes((uint16_t)(s->pack_soc_decimal / 0.1f), data, 4);
+    uint16_to_bytes(scale_to_uint16(s->pack_soc_decimal, 0.1f), data, 4);
     *len = 6;
 }
 
@@ -568,8 +598,8 @@ void pack_emboo_pack_data2(const void* state, uint8_t* data, uint8_t* len) {
     const EmbooPackData2* s = (const EmbooPackData2*)state;
 
     memset(data, 0, 8);
-    uint16_to_bytes((uint16_t)(s->pack_summed_voltage / 0.01f), data, 0);
-    uint16_to_bytes((uint16_t)(s->high_temp / 0.1f), data, 4);
+    uint16_to_bytes(scale_to_uint16(s->pack_summed_voltage, 0.01f), data, 0);
+    uint16_to_bytes(scale_to_uint16(s->high_temp, 0.1f), data, 4);
     *len = 6;
 }
 
@@ -84,6 +84,8 @@
 #endif
 
 // Custom ESP32 module CAN IDs (0x700+ range) - common to both battery and motor types
+#define CAN_ID_TIME_SYNC            0x700  // Time sync master: sync (see LeafCANTimeSync.h)
+#define CAN_ID_TIME_FOLLOW_UP       0x701  // Time sync master: TX time of the last sync
 #define CAN_ID_GPS_POSITION         0x710  // GPS latitude, longitude
 #define CAN_ID_GPS_VELOCITY         0x711  // GPS speed, heading
 #define CAN_ID_GPS_TIME             0x712  // GPS date/time
@@ -172,6 +174,7 @@ typedef struct {
 
 // GPS velocity data
 typedef struct {
+    double longitude;       // Longitude (decimal degrees), carried in 0x711 bytes 0-3
     float speed_kmh;        // Ground speed (km/h)
     float heading;          // Course over ground (degrees)
     float pdop;             // Position dilution of precision
@@ -410,6 +413,11 @@ void pack_gps_time(const void* state, uint8_t* data, uint8_t* len);
 void unpack_body_temp(const uint8_t* data, uint8_t len, void* state);
 void pack_body_temp(const void* state, uint8_t* data, uint8_t* len);
 
+// Deadband for LeafCANBus::publishOnChange(): true once any sensor moved
+// BODY_TEMP_DEADBAND (°C * 10) away from the last transmitted frame
+#define BODY_TEMP_DEADBAND 5
+bool body_temp_changed(const uint8_t* sent, const uint8_t* data, uint8_t len);
+
 // Body voltage monitoring
 void unpack_body_voltage(const uint8_t* data, uint8_t len, void* state);
 void pack_body_voltage(const void* state, uint8_t* data, uint8_t* len);
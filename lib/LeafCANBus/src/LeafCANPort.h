@@ -0,0 +1,192 @@
+#ifndef LEAF_CAN_PORT_H
+#define LEAF_CAN_PORT_H
+
+// ============================================================================
+// CAN PORT (platform backend for LeafCANBus)
+// ============================================================================
+// ESP32:  TWAI driver, FreeRTOS RX task + queue     (LeafCANPort_esp32.cpp)
+// Linux:  SocketCAN (can0/vcan0) or an in-process loopback bus, pthread RX
+//         thread + ring buffer                      (LeafCANPort_linux.cpp)
+//
+// A port owns the driver and the RX queue; LeafCANBus only sees CANFrame.
+// An optional RX handler runs in the RX task/thread for each frame before it
+// is queued, so latency-critical state can skip the queue and process().
+//
+// Transmit goes through a priority queue (LeafCANTxQueue.h) that the port
+// drains whenever the controller is free: on ESP32 from the TWAI TX alerts
+// (RX task), on Linux right away or from a TX thread while the socket is busy.
+//
+// Bus state (error-active/passive, bus-off and its recovery) is tracked per
+// port from the controller's own reports; see LeafCANHealth.h.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+  #define LEAFCAN_PLATFORM_ESP32 1
+  #include "driver/gpio.h"
+#elif defined(__linux__)
+  #define LEAFCAN_PLATFORM_LINUX 1
+#else
+  #error "LeafCANBus: no CAN port for this platform"
+#endif
+
+#define CAN_PORT_RX_QUEUE_LEN 20
+#define CAN_PORT_TX_QUEUE_LEN 32
+#define CAN_PORT_FILTER_SETTLE_MS 1000
+
+// ESP32 RX task stack in bytes. RX handlers run on it, including every
+// subscribeDirect() unpack callback; override in build_flags for deep ones.
+#ifndef CAN_PORT_RX_TASK_STACK
+#define CAN_PORT_RX_TASK_STACK 8192
+#endif
+
+// Bus-off recovery backoff (LeafCANHealth.h): the wait doubles for each
+// bus-off that follows a recovery within CAN_PORT_RECOVERY_STABLE_MS
+#define CAN_PORT_RECOVERY_MIN_MS 100
+#define CAN_PORT_RECOVERY_MAX_MS 5000
+#define CAN_PORT_RECOVERY_STABLE_MS 10000
+
+// Linux only: frames go to every other port opened on this name in the same
+// process (vcan semantics, no kernel CAN support needed)
+#define CAN_PORT_LOOPBACK "loopback"
+
+typedef struct {
+    uint32_t id;
+    uint8_t len;
+    bool extended;          // 29-bit identifier
+    uint8_t data[8];
+    uint32_t timestamp_us;  // micros() when the RX task/thread received it
+} CANFrame;
+
+typedef struct {
+    uint32_t frames;            // Accepted by the filter and read from the driver
+    uint32_t handled;           // Consumed by the RX handler (never queued)
+    uint32_t queue_overflows;   // Dropped: RX queue full
+    uint32_t driver_overflows;  // Lost before the RX task saw them (controller/driver/socket)
+} CANPortStats;
+
+typedef struct {
+    uint32_t queued;            // Accepted by can_port_queue()
+    uint32_t sent;              // Handed to the controller (ESP32: acknowledged on the bus)
+    uint32_t failed;            // Controller gave up (bus errors, bus-off)
+    uint32_t expired;           // Dropped: deadline passed while waiting
+    uint32_t dropped;           // Dropped: queue full of higher-priority frames
+    uint16_t depth;             // Frames waiting now
+    uint16_t max_depth;
+    uint32_t latency_max_us;    // can_port_queue() -> sent
+    uint64_t latency_total_us;  // Mean = latency_total_us / sent
+} CANTxStats;
+
+// Controller error state (ISO 11898 fault confinement) plus recovery
+typedef enum {
+    CAN_BUS_ERROR_ACTIVE,
+    CAN_BUS_ERROR_WARNING,      // An error counter is above 96
+    CAN_BUS_ERROR_PASSIVE,      // An error counter is above 127
+    CAN_BUS_OFF,                // TX error counter above 255, waiting out the backoff
+    CAN_BUS_RECOVERING,         // Recovery started, waiting for 128 x 11 recessive bits
+    CAN_BUS_STATE_COUNT
+} CANBusState;
+
+// What the port saw (TWAI alerts on ESP32, SocketCAN error frames on Linux)
+typedef enum {
+    CAN_EVENT_RX_DATA,
+    CAN_EVENT_RX_QUEUE_FULL,    // Driver/controller dropped received frames
+    CAN_EVENT_TX_FAILED,
+    CAN_EVENT_BUS_ERROR,
+    CAN_EVENT_ERROR_WARNING,
+    CAN_EVENT_ERROR_PASSIVE,
+    CAN_EVENT_ERROR_ACTIVE,
+    CAN_EVENT_BUS_OFF,
+    CAN_EVENT_BUS_RECOVERED,
+    CAN_EVENT_COUNT
+} CANBusEvent;
+
+typedef struct {
+    CANBusState state;
+    uint32_t state_ms;                          // Time in the current state
+    uint32_t dwell_ms[CAN_BUS_STATE_COUNT];     // Total time per state, incl. current
+    uint32_t events[CAN_EVENT_COUNT];
+    uint32_t recovery_attempts;
+    uint32_t recoveries;
+    uint32_t backoff_ms;                        // Wait before the next recovery attempt
+} CANBusHealth;
+
+// Runs in the RX task/thread (on ESP32 with CAN_PORT_RX_TASK_STACK bytes of
+// stack); return true when the frame needs no queueing.
+// On the loopback bus it runs on the sending thread once the send call has
+// released its locks, so a handler may send too.
+typedef bool (*can_port_rx_handler_t)(const CANFrame* frame, void* context);
+
+// Acceptance filter, same fields as twai_filter_config_t (see LeafCANFilter.h)
+typedef struct {
+    uint32_t acceptance_code;
+    uint32_t acceptance_mask;   // 1 = don't care
+    bool single_filter;
+} CANFilter;
+
+#define CAN_FILTER_ACCEPT_ALL { 0, 0xFFFFFFFF, true }
+
+typedef struct {
+#ifdef LEAFCAN_PLATFORM_ESP32
+    gpio_num_t tx_pin;
+    gpio_num_t rx_pin;
+#else
+    const char* interface;  // "can0", "vcan0", ... or CAN_PORT_LOOPBACK
+#endif
+    uint16_t rx_queue_len;  // Frames buffered between RX thread and process()
+                            // (on ESP32 also the TWAI driver's queue depth)
+} CANPortConfig;
+
+struct CANPort;
+
+// Install the driver and start receiving. NULL on failure (reason is logged).
+CANPort* can_port_open(const CANPortConfig* config);
+void can_port_close(CANPort* port);
+
+// Pop one received frame without blocking
+bool can_port_receive(CANPort* port, CANFrame* frame);
+
+// Add a frame to the TX priority queue without blocking. With has_deadline,
+// the frame is dropped if it has not been sent by deadline_us (micros()).
+// False when the queue is full of higher-priority frames.
+bool can_port_queue(CANPort* port, const CANFrame* frame, uint32_t deadline_us, bool has_deadline);
+
+void can_port_get_tx_stats(const CANPort* port, CANTxStats* stats);
+
+// Frames can_port_queue() can take before it starts evicting
+uint16_t can_port_tx_free(const CANPort* port);
+
+// Transmit timestamps for one identifier (the time sync frame), 0 = off.
+// ESP32: micros() at its TX_SUCCESS alert; Linux: when it was written to the
+// socket or loopback bus. can_port_tx_stamp() returns the latest one once.
+void can_port_set_tx_stamp_id(CANPort* port, uint32_t id);
+bool can_port_tx_stamp(CANPort* port, uint32_t* timestamp_us);
+
+// Receive-side errors counted by the RX thread (driver errors + queue overflows)
+uint32_t can_port_rx_errors(const CANPort* port);
+
+// Replace the acceptance filter. ESP32 must reinstall the driver for this, so
+// the RX task applies it once the port has been open CAN_PORT_FILTER_SETTLE_MS
+// (the unfiltered bus rate measured until then feeds can_port_rx_filtered()).
+bool can_port_set_filter(CANPort* port, const CANFilter* filter);
+
+// Install (or clear, with NULL) the RX handler. Returns once no call to the
+// previous handler is still running, so its data can be changed safely.
+void can_port_set_rx_handler(CANPort* port, can_port_rx_handler_t handler, void* context);
+
+// Hold off RX handler calls, e.g. to copy data the handler updates
+void can_port_lock_rx_handler(CANPort* port);
+void can_port_unlock_rx_handler(CANPort* port);
+
+void can_port_get_stats(const CANPort* port, CANPortStats* stats);
+
+// Bus state, per-state dwell times and event counters
+void can_port_get_health(const CANPort* port, CANBusHealth* health);
+
+// Frames the acceptance filter kept away from the RX queue. Exact on Linux
+// (filtered in software); estimated on ESP32, where the controller does not
+// count rejected frames.
+uint32_t can_port_rx_filtered(const CANPort* port);
+
+#endif // LEAF_CAN_PORT_H
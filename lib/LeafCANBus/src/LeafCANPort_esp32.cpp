@@ -0,0 +1,541 @@
+#include "LeafCANPort.h"
+#include "LeafCANTxQueue.h"
+#include "LeafCANHealth.h"
+
+#ifdef LEAFCAN_PLATFORM_ESP32
+
+#include <Arduino.h>
+#include "driver/twai.h"
+
+struct CANPort {
+    TaskHandle_t rx_task_handle;
+    QueueHandle_t rx_queue;
+    volatile uint32_t rx_errors;
+    CANPortStats stats;
+    uint32_t missed_base;           // rx_missed_count of earlier driver installs
+
+    // RX handler, called on the RX task under handler_lock
+    SemaphoreHandle_t handler_lock;
+    can_port_rx_handler_t rx_handler;
+    void* rx_context;
+
+    // Driver settings, kept for reinstalling with a new filter
+    gpio_num_t tx_pin;
+    gpio_num_t rx_pin;
+    uint16_t rx_queue_len;
+
+    // Filter handoff from the main loop to the RX task (under filter_mux)
+    CANFilter pending_filter;
+    volatile bool filter_pending;
+    bool filter_open;               // Driver currently accepts everything
+
+    // Bus rate seen with the filter open vs. frames received since it closed
+    uint32_t opened_ms;
+    uint32_t open_frames;
+    uint32_t open_ms;
+    uint32_t closed_ms;
+    uint32_t closed_frames;
+
+    // TX priority queue (under tx_lock). The driver holds at most one frame
+    // (tx_in_flight); the RX task hands over the next one on the TX alerts.
+    SemaphoreHandle_t tx_lock;
+    LeafCANTxQueue tx_queue;
+    CANTxStats tx_stats;
+    CANTxEntry tx_in_flight;
+    bool tx_busy;
+    uint32_t tx_stamp_id;           // can_port_set_tx_stamp_id()
+    uint32_t tx_stamp_us;
+    bool tx_stamped;
+
+    // Error state and recovery backoff (under health_mux)
+    LeafCANHealth health;
+};
+
+// The TWAI driver is a singleton, so is its port
+static CANPort esp32_port;
+static bool esp32_port_open = false;
+static portMUX_TYPE filter_mux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE health_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Controller FIFO overrun alert (newer ESP-IDF only)
+#ifdef TWAI_ALERT_RX_FIFO_OVERRUN
+  #define CAN_PORT_ALERT_FIFO_OVERRUN TWAI_ALERT_RX_FIFO_OVERRUN
+#else
+  #define CAN_PORT_ALERT_FIFO_OVERRUN 0
+#endif
+
+// Everything the RX task reacts to; it blocks in twai_read_alerts() only
+#define CAN_PORT_ALERTS (TWAI_ALERT_RX_DATA | TWAI_ALERT_RX_QUEUE_FULL | CAN_PORT_ALERT_FIFO_OVERRUN | \
+                         TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE |          \
+                         TWAI_ALERT_BUS_ERROR | TWAI_ALERT_ABOVE_ERR_WARN | TWAI_ALERT_BELOW_ERR_WARN | \
+                         TWAI_ALERT_ERR_PASS | TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_BUS_OFF |          \
+                         TWAI_ALERT_BUS_RECOVERED)
+
+static esp_err_t driver_start(CANPort* port, const CANFilter* filter) {
+    // Configure TWAI timing (500 kbps)
+    twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
+
+    // Configure TWAI acceptance filter
+    twai_filter_config_t f_config;
+    f_config.acceptance_code = filter->acceptance_code;
+    f_config.acceptance_mask = filter->acceptance_mask;
+    f_config.single_filter = filter->single_filter;
+
+    // Configure TWAI general settings
+    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(port->tx_pin, port->rx_pin, TWAI_MODE_NORMAL);
+    g_config.rx_queue_len = port->rx_queue_len;
+
+    // One frame at a time in the driver, so LeafCANTxQueue decides the order
+    g_config.tx_queue_len = 1;
+    g_config.alerts_enabled = CAN_PORT_ALERTS;
+
+    // Install TWAI driver
+    esp_err_t err = twai_driver_install(&g_config, &t_config, &f_config);
+    if (err != ESP_OK) {
+        Serial.printf("[CAN] Failed to install driver: %d\n", err);
+        return err;
+    }
+
+    // Start TWAI driver
+    err = twai_start();
+    if (err != ESP_OK) {
+        Serial.printf("[CAN] Failed to start driver: %d\n", err);
+        twai_driver_uninstall();
+    }
+    return err;
+}
+
+// ============================================================================
+// TX
+// ============================================================================
+
+// Hand the next queued frame to the driver if it is idle (caller holds tx_lock)
+static void tx_start_next(CANPort* port) {
+    if (port->tx_busy) return;
+
+    CANTxEntry entry;
+    if (!port->tx_queue.pop(&entry, micros(), &port->tx_stats.expired)) {
+        port->tx_stats.depth = 0;
+        return;
+    }
+
+    twai_message_t message;
+    message.identifier = entry.frame.id;
+    message.data_length_code = entry.frame.len;
+    message.flags = entry.frame.extended ? TWAI_MSG_FLAG_EXTD : TWAI_MSG_FLAG_NONE;
+    memcpy(message.data, entry.frame.data, entry.frame.len);
+
+    if (twai_transmit(&message, 0) == ESP_OK) {
+        port->tx_in_flight = entry;
+        port->tx_busy = true;
+    } else {
+        // Driver stopped (filter reinstall, bus-off): the RX task retries
+        port->tx_queue.requeue(entry);
+    }
+    port->tx_stats.depth = port->tx_queue.size();
+}
+
+// TX alerts: account for the frame in the driver, then hand over the next
+static void tx_on_alerts(CANPort* port, uint32_t alerts) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    if (port->tx_busy && (alerts & TWAI_ALERT_TX_SUCCESS)) {
+        uint32_t now = micros();
+        uint32_t latency = now - port->tx_in_flight.queued_us;
+        if (port->tx_stamp_id && port->tx_in_flight.frame.id == port->tx_stamp_id) {
+            port->tx_stamp_us = now;
+            port->tx_stamped = true;
+        }
+        port->tx_stats.sent++;
+        port->tx_stats.latency_total_us += latency;
+        if (latency > port->tx_stats.latency_max_us) port->tx_stats.latency_max_us = latency;
+        port->tx_busy = false;
+    } else if (port->tx_busy && (alerts & (TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE | TWAI_ALERT_BUS_OFF))) {
+        port->tx_stats.failed++;
+        port->tx_busy = false;
+    }
+
+    // Also without TX alerts: picks up frames a stopped driver refused
+    tx_start_next(port);
+    xSemaphoreGive(port->tx_lock);
+}
+
+// ============================================================================
+// RX TASK (frames, TX completion and bus state, all from TWAI alerts)
+// ============================================================================
+
+// Runs on the RX task, the only task that waits on the driver. tx_lock is
+// held from twai_stop() until the new driver runs, so no task can reach
+// twai_transmit() while the driver is torn down; sends queue meanwhile.
+// Frames in flight during the reinstall are lost.
+static void apply_pending_filter(CANPort* port) {
+    CANFilter filter;
+    portENTER_CRITICAL(&filter_mux);
+    filter = port->pending_filter;
+    port->filter_pending = false;
+    portEXIT_CRITICAL(&filter_mux);
+
+    // The controller's missed-frame counter restarts with the driver
+    port->missed_base = port->stats.driver_overflows;
+
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    twai_stop();
+    twai_driver_uninstall();
+    esp_err_t err = driver_start(port, &filter);
+    if (err != ESP_OK) {
+        // Fall back to the open filter rather than going deaf
+        CANFilter accept_all = CAN_FILTER_ACCEPT_ALL;
+        filter = accept_all;
+        err = driver_start(port, &filter);
+    }
+
+    // A frame that was in the old driver is lost with it
+    if (port->tx_busy) {
+        port->tx_stats.failed++;
+        port->tx_busy = false;
+    }
+    if (err == ESP_OK) tx_start_next(port);
+    xSemaphoreGive(port->tx_lock);
+
+    // A fresh driver starts error-active, even if the old one was bus-off
+    // (otherwise recoveryDue() would start a recovery on a running controller)
+    portENTER_CRITICAL(&health_mux);
+    port->health.onRestart(millis());
+    portEXIT_CRITICAL(&health_mux);
+
+    if (err != ESP_OK) {
+        port->rx_errors++;
+        return;
+    }
+
+    bool accepts_all = filter.acceptance_mask == 0xFFFFFFFF;
+    uint32_t now = millis();
+    if (port->filter_open && !accepts_all) {
+        port->open_ms += now - port->opened_ms;
+        port->closed_ms = now;
+        port->closed_frames = 0;
+    } else if (!port->filter_open && accepts_all) {
+        port->opened_ms = now;
+    }
+    port->filter_open = accepts_all;
+}
+
+// Pop everything the driver has queued (one RX_DATA alert covers many frames)
+static void rx_drain(CANPort* port) {
+    twai_message_t message;
+    while (twai_receive(&message, 0) == ESP_OK) {
+        if (port->filter_open) port->open_frames++;
+        else port->closed_frames++;
+        port->stats.frames++;
+
+        CANFrame frame;
+        frame.id = message.identifier;
+        frame.len = message.data_length_code;
+        frame.extended = message.extd;
+        memcpy(frame.data, message.data, sizeof(frame.data));
+        frame.timestamp_us = micros();
+
+        // Fast path: handled right here, no queue and no wait for loop()
+        xSemaphoreTake(port->handler_lock, portMAX_DELAY);
+        bool handled = port->rx_handler && port->rx_handler(&frame, port->rx_context);
+        xSemaphoreGive(port->handler_lock);
+
+        if (handled) {
+            port->stats.handled++;
+        } else if (xQueueSend(port->rx_queue, &frame, 0) != pdTRUE) {
+            // Add to queue for processing in main loop
+            port->stats.queue_overflows++;
+            port->rx_errors++;
+        }
+    }
+}
+
+// Alert -> health event, in the order the controller passes through them
+static const struct {
+    uint32_t alert;
+    CANBusEvent event;
+} health_alerts[] = {
+    { TWAI_ALERT_RX_DATA,        CAN_EVENT_RX_DATA },
+    { TWAI_ALERT_RX_QUEUE_FULL,  CAN_EVENT_RX_QUEUE_FULL },
+    { CAN_PORT_ALERT_FIFO_OVERRUN, CAN_EVENT_RX_QUEUE_FULL },
+    { TWAI_ALERT_TX_FAILED,      CAN_EVENT_TX_FAILED },
+    { TWAI_ALERT_BUS_ERROR,      CAN_EVENT_BUS_ERROR },
+    { TWAI_ALERT_BELOW_ERR_WARN, CAN_EVENT_ERROR_ACTIVE },
+    { TWAI_ALERT_ERR_ACTIVE,     CAN_EVENT_ERROR_ACTIVE },
+    { TWAI_ALERT_ABOVE_ERR_WARN, CAN_EVENT_ERROR_WARNING },
+    { TWAI_ALERT_ERR_PASS,       CAN_EVENT_ERROR_PASSIVE },
+    { TWAI_ALERT_BUS_OFF,        CAN_EVENT_BUS_OFF },
+    { TWAI_ALERT_BUS_RECOVERED,  CAN_EVENT_BUS_RECOVERED },
+};
+
+static void health_on_alerts(CANPort* port, uint32_t alerts) {
+    uint32_t now = millis();
+    bool changed = false;
+    portENTER_CRITICAL(&health_mux);
+    for (size_t i = 0; i < sizeof(health_alerts) / sizeof(health_alerts[0]); i++) {
+        if (alerts & health_alerts[i].alert) changed |= port->health.onEvent(health_alerts[i].event, now);
+    }
+    CANBusState state = port->health.state();
+    uint32_t backoff = port->health.msUntilRecovery(now);
+    portEXIT_CRITICAL(&health_mux);
+
+    // After recovery the controller is stopped until restarted
+    if (alerts & TWAI_ALERT_BUS_RECOVERED) twai_start();
+
+    if (!changed) return;
+    if (state == CAN_BUS_OFF) {
+        Serial.printf("[CAN] Bus-off, recovery in %u ms\n", backoff);
+    } else {
+        Serial.printf("[CAN] Bus %s\n", can_bus_state_name(state));
+    }
+}
+
+static void rx_task(void* pvParameters) {
+    CANPort* port = (CANPort*)pvParameters;
+
+    while (true) {
+        // Keep the filter open long enough to measure the unfiltered bus rate
+        if (port->filter_pending &&
+            (!port->filter_open || millis() - port->opened_ms >= CAN_PORT_FILTER_SETTLE_MS)) {
+            apply_pending_filter(port);
+        }
+
+        // Bus-off: wake up when the backoff has elapsed
+        portENTER_CRITICAL(&health_mux);
+        uint32_t wait_ms = port->health.msUntilRecovery(millis());
+        bool recover = port->health.recoveryDue(millis());
+        portEXIT_CRITICAL(&health_mux);
+        if (recover) {
+            Serial.println("[CAN] Starting bus-off recovery");
+            twai_initiate_recovery();
+        }
+        if (wait_ms > 100) wait_ms = 100;
+
+        // One blocking point for frames, TX completion and bus state
+        uint32_t alerts = 0;
+        esp_err_t err = twai_read_alerts(&alerts, pdMS_TO_TICKS(wait_ms));
+        if (err != ESP_OK && err != ESP_ERR_TIMEOUT) {
+            port->rx_errors++;
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        if (alerts & (TWAI_ALERT_RX_DATA | TWAI_ALERT_RX_QUEUE_FULL)) rx_drain(port);
+
+        // Status is only read when the controller reports lost frames
+        if (alerts & (TWAI_ALERT_RX_QUEUE_FULL | CAN_PORT_ALERT_FIFO_OVERRUN)) {
+            twai_status_info_t status;
+            if (twai_get_status_info(&status) == ESP_OK) {
+                port->stats.driver_overflows = port->missed_base + status.rx_missed_count;
+            }
+        }
+
+        if (alerts) health_on_alerts(port, alerts);
+        tx_on_alerts(port, alerts);
+    }
+}
+
+CANPort* can_port_open(const CANPortConfig* config) {
+    if (esp32_port_open) {
+        Serial.println("[CAN] Already initialized");
+        return nullptr;
+    }
+
+    CANPort* port = &esp32_port;
+    port->tx_pin = config->tx_pin;
+    port->rx_pin = config->rx_pin;
+    port->rx_queue_len = config->rx_queue_len;
+
+    // Start with every frame accepted (LeafCANBus narrows it once subscribed)
+    CANFilter accept_all = CAN_FILTER_ACCEPT_ALL;
+    if (driver_start(port, &accept_all) != ESP_OK) {
+        return nullptr;
+    }
+
+    port->rx_errors = 0;
+    memset(&port->stats, 0, sizeof(port->stats));
+    port->missed_base = 0;
+    port->rx_handler = nullptr;
+    port->rx_context = nullptr;
+    port->filter_pending = false;
+    port->filter_open = true;
+    port->opened_ms = millis();
+    port->open_frames = 0;
+    port->open_ms = 0;
+    port->closed_ms = 0;
+    port->closed_frames = 0;
+    port->tx_queue.clear();
+    memset(&port->tx_stats, 0, sizeof(port->tx_stats));
+    port->tx_busy = false;
+    port->tx_stamp_id = 0;
+    port->tx_stamped = false;
+    port->health.reset(millis());
+
+    // Create RX queue and the handler/TX locks
+    port->rx_queue = xQueueCreate(config->rx_queue_len, sizeof(CANFrame));
+    port->handler_lock = xSemaphoreCreateMutex();
+    port->tx_lock = xSemaphoreCreateMutex();
+    if (port->rx_queue == nullptr || port->handler_lock == nullptr || port->tx_lock == nullptr) {
+        Serial.println("[CAN] Failed to create RX queue");
+        if (port->rx_queue) vQueueDelete(port->rx_queue);
+        if (port->handler_lock) vSemaphoreDelete(port->handler_lock);
+        if (port->tx_lock) vSemaphoreDelete(port->tx_lock);
+        port->rx_queue = nullptr;
+        port->handler_lock = nullptr;
+        port->tx_lock = nullptr;
+        twai_stop();
+        twai_driver_uninstall();
+        return nullptr;
+    }
+
+    // Create RX task
+    BaseType_t task_created = xTaskCreatePinnedToCore(
+        rx_task,
+        "can_rx_task",
+        CAN_PORT_RX_TASK_STACK,
+        port,
+        5,  // Priority
+        &port->rx_task_handle,
+        1   // Core 1
+    );
+
+    if (task_created != pdPASS) {
+        Serial.println("[CAN] Failed to create RX task");
+        vQueueDelete(port->rx_queue);
+        vSemaphoreDelete(port->handler_lock);
+        vSemaphoreDelete(port->tx_lock);
+        port->rx_queue = nullptr;
+        port->handler_lock = nullptr;
+        port->tx_lock = nullptr;
+        twai_stop();
+        twai_driver_uninstall();
+        return nullptr;
+    }
+
+    esp32_port_open = true;
+    Serial.printf("[CAN] Initialized on TX=%d, RX=%d\n", config->tx_pin, config->rx_pin);
+    return port;
+}
+
+void can_port_close(CANPort* port) {
+    if (!port || !esp32_port_open) return;
+
+    // Delete RX task
+    if (port->rx_task_handle != nullptr) {
+        vTaskDelete(port->rx_task_handle);
+        port->rx_task_handle = nullptr;
+    }
+
+    // Delete RX queue
+    if (port->rx_queue != nullptr) {
+        vQueueDelete(port->rx_queue);
+        port->rx_queue = nullptr;
+    }
+    if (port->handler_lock != nullptr) {
+        vSemaphoreDelete(port->handler_lock);
+        port->handler_lock = nullptr;
+    }
+    if (port->tx_lock != nullptr) {
+        vSemaphoreDelete(port->tx_lock);
+        port->tx_lock = nullptr;
+    }
+
+    // Stop and uninstall TWAI driver
+    twai_stop();
+    twai_driver_uninstall();
+    esp32_port_open = false;
+}
+
+bool can_port_receive(CANPort* port, CANFrame* frame) {
+    return xQueueReceive(port->rx_queue, frame, 0) == pdTRUE;
+}
+
+bool can_port_queue(CANPort* port, const CANFrame* frame, uint32_t deadline_us, bool has_deadline) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    bool evicted;
+    bool ok = port->tx_queue.push(*frame, micros(), deadline_us, has_deadline, &evicted);
+    if (ok) port->tx_stats.queued++;
+    if (!ok || evicted) port->tx_stats.dropped++;
+    if (port->tx_queue.size() > port->tx_stats.max_depth) port->tx_stats.max_depth = port->tx_queue.size();
+
+    // Idle controller: start right away instead of waiting for an alert
+    tx_start_next(port);
+    xSemaphoreGive(port->tx_lock);
+    return ok;
+}
+
+void can_port_get_tx_stats(const CANPort* port, CANTxStats* stats) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    *stats = port->tx_stats;
+    xSemaphoreGive(port->tx_lock);
+}
+
+uint16_t can_port_tx_free(const CANPort* port) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    uint16_t free_slots = CAN_PORT_TX_QUEUE_LEN - port->tx_queue.size();
+    xSemaphoreGive(port->tx_lock);
+    return free_slots;
+}
+
+void can_port_set_tx_stamp_id(CANPort* port, uint32_t id) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    port->tx_stamp_id = id;
+    port->tx_stamped = false;
+    xSemaphoreGive(port->tx_lock);
+}
+
+bool can_port_tx_stamp(CANPort* port, uint32_t* timestamp_us) {
+    xSemaphoreTake(port->tx_lock, portMAX_DELAY);
+    bool stamped = port->tx_stamped;
+    if (stamped) *timestamp_us = port->tx_stamp_us;
+    port->tx_stamped = false;
+    xSemaphoreGive(port->tx_lock);
+    return stamped;
+}
+
+uint32_t can_port_rx_errors(const CANPort* port) {
+    return port->rx_errors;
+}
+
+bool can_port_set_filter(CANPort* port, const CANFilter* filter) {
+    portENTER_CRITICAL(&filter_mux);
+    port->pending_filter = *filter;
+    port->filter_pending = true;
+    portEXIT_CRITICAL(&filter_mux);
+    return true;
+}
+
+void can_port_set_rx_handler(CANPort* port, can_port_rx_handler_t handler, void* context) {
+    // Waits for an in-flight handler call on the RX task to finish
+    xSemaphoreTake(port->handler_lock, portMAX_DELAY);
+    port->rx_handler = handler;
+    port->rx_context = context;
+    xSemaphoreGive(port->handler_lock);
+}
+
+void can_port_lock_rx_handler(CANPort* port) {
+    xSemaphoreTake(port->handler_lock, portMAX_DELAY);
+}
+
+void can_port_unlock_rx_handler(CANPort* port) {
+    xSemaphoreGive(port->handler_lock);
+}
+
+void can_port_get_stats(const CANPort* port, CANPortStats* stats) {
+    *stats = port->stats;
+}
+
+void can_port_get_health(const CANPort* port, CANBusHealth* health) {
+    portENTER_CRITICAL(&health_mux);
+    port->health.snapshot(health, millis());
+    portEXIT_CRITICAL(&health_mux);
+}
+
+uint32_t can_port_rx_filtered(const CANPort* port) {
+    if (port->filter_open || port->open_ms == 0) return 0;
+
+    // Frames the open filter would have let through since it closed
+    uint64_t expected = (uint64_t)port->open_frames * (millis() - port->closed_ms) / port->open_ms;
+    return expected > port->closed_frames ? (uint32_t)(expected - port->closed_frames) : 0;
+}
+
+#endif // LEAFCAN_PLATFORM_ESP32
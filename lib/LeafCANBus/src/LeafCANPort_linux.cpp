@@ -0,0 +1,586 @@
+#include "LeafCANPort.h"
+#include "LeafCANFilter.h"
+#include "LeafCANTxQueue.h"
+#include "LeafCANHealth.h"
+#include <Arduino.h>            // micros() (host/Arduino.h)
+
+#ifdef LEAFCAN_PLATFORM_LINUX
+
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+
+// ============================================================================
+// RX RING (RX thread / loopback senders -> process())
+// ============================================================================
+
+struct CANPort {
+    int fd;                     // SocketCAN socket, -1 for loopback
+    bool loopback;
+    std::atomic<bool> running{false};
+    pthread_t rx_thread;
+
+    pthread_mutex_t lock;
+    CANFrame* ring;
+    uint16_t capacity;
+    uint16_t head;              // Next slot to pop
+    uint16_t count;
+    uint32_t rx_errors;
+    CANPortStats stats;
+
+    CANFilter filter;           // Applied in software, as the controller would
+    uint32_t rx_filtered;
+    LeafCANHealth health;       // From SocketCAN error frames (loopback: always active)
+
+    // RX handler, called on the RX thread (loopback: the sender's thread)
+    pthread_mutex_t handler_lock;
+    can_port_rx_handler_t rx_handler;
+    void* rx_context;
+
+    // TX priority queue, drained by the sender (loopback, writable socket)
+    // or by the TX thread once the socket has room again
+    pthread_mutex_t tx_lock;
+    pthread_cond_t tx_wake;
+    pthread_t tx_thread;
+    LeafCANTxQueue tx_queue;
+    CANTxStats tx_stats;
+    uint32_t tx_stamp_id;       // can_port_set_tx_stamp_id()
+    uint32_t tx_stamp_us;
+    bool tx_stamped;
+
+    CANPort* next_loopback;     // Loopback bus membership
+};
+
+// Filter -> RX handler -> ring, like the ESP32 RX task
+static void port_deliver(CANPort* port, const CANFrame* frame) {
+    pthread_mutex_lock(&port->lock);
+    bool accepted = can_filter_accepts(&port->filter, frame);
+    if (accepted) {
+        port->stats.frames++;
+        port->health.count(CAN_EVENT_RX_DATA);
+    } else {
+        port->rx_filtered++;
+    }
+    pthread_mutex_unlock(&port->lock);
+    if (!accepted) return;
+
+    pthread_mutex_lock(&port->handler_lock);
+    bool handled = port->rx_handler && port->rx_handler(frame, port->rx_context);
+    pthread_mutex_unlock(&port->handler_lock);
+
+    pthread_mutex_lock(&port->lock);
+    if (handled) {
+        port->stats.handled++;
+    } else if (port->count < port->capacity) {
+        port->ring[(port->head + port->count) % port->capacity] = *frame;
+        port->count++;
+    } else {
+        port->stats.queue_overflows++;
+        port->rx_errors++;
+    }
+    pthread_mutex_unlock(&port->lock);
+}
+
+// ============================================================================
+// LOOPBACK BUS
+// ============================================================================
+
+static pthread_mutex_t loopback_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t loopback_idle = PTHREAD_COND_INITIALIZER;
+static CANPort* loopback_ports = nullptr;
+static int loopback_delivering = 0;     // Flushes running outside loopback_lock
+
+// Frames this thread has sent and not yet delivered. Filled under the
+// sender's tx_lock, delivered by loopback_flush() once it is released, so
+// RX handlers run with no port or bus lock held and may send themselves.
+struct LoopbackFrame {
+    CANPort* sender;
+    CANFrame frame;
+};
+static thread_local std::vector<LoopbackFrame> loopback_pending;
+static thread_local std::vector<CANPort*> loopback_targets;
+static thread_local bool loopback_flushing = false;
+
+static void loopback_attach(CANPort* port) {
+    pthread_mutex_lock(&loopback_lock);
+    port->next_loopback = loopback_ports;
+    loopback_ports = port;
+    pthread_mutex_unlock(&loopback_lock);
+}
+
+// Unlinks the port, then waits for deliveries that may still reach it
+static void loopback_detach(CANPort* port) {
+    pthread_mutex_lock(&loopback_lock);
+    for (CANPort** p = &loopback_ports; *p; p = &(*p)->next_loopback) {
+        if (*p == port) {
+            *p = port->next_loopback;
+            break;
+        }
+    }
+    while (loopback_delivering > 0) pthread_cond_wait(&loopback_idle, &loopback_lock);
+    pthread_mutex_unlock(&loopback_lock);
+}
+
+// Like vcan: every other port on the bus receives the frame, the sender does
+// not. Only queued here; the sending API call delivers it before returning.
+static void loopback_send(CANPort* sender, const CANFrame* frame) {
+    LoopbackFrame sent = { sender, *frame };
+    sent.frame.timestamp_us = micros();
+    loopback_pending.push_back(sent);
+}
+
+// Deliver this thread's sent frames (caller holds no port lock). Frames that
+// RX handlers send from here are appended and go out in the same loop.
+static void loopback_flush() {
+    if (loopback_flushing || loopback_pending.empty()) return;
+    loopback_flushing = true;
+
+    for (size_t i = 0; i < loopback_pending.size(); i++) {
+        LoopbackFrame sent = loopback_pending[i];   // Copy: handlers may append
+
+        loopback_targets.clear();
+        pthread_mutex_lock(&loopback_lock);
+        for (CANPort* p = loopback_ports; p; p = p->next_loopback) {
+            if (p != sent.sender) loopback_targets.push_back(p);
+        }
+        loopback_delivering++;
+        pthread_mutex_unlock(&loopback_lock);
+
+        for (CANPort* p : loopback_targets) port_deliver(p, &sent.frame);
+
+        pthread_mutex_lock(&loopback_lock);
+        if (--loopback_delivering == 0) pthread_cond_broadcast(&loopback_idle);
+        pthread_mutex_unlock(&loopback_lock);
+    }
+    loopback_pending.clear();
+    loopback_flushing = false;
+}
+
+// ============================================================================
+// SOCKETCAN
+// ============================================================================
+
+// Error frames -> health events. Recovery is the kernel's (ip link set canX
+// type can restart-ms N), so bus-off ends with CAN_ERR_RESTARTED.
+static void socketcan_error_frame(CANPort* port, const struct can_frame& raw) {
+    uint32_t now = millis();
+    uint8_t ctrl = raw.data[1];
+    pthread_mutex_lock(&port->lock);
+    if (raw.can_id & CAN_ERR_TX_TIMEOUT) port->health.onEvent(CAN_EVENT_TX_FAILED, now);
+    if (raw.can_id & (CAN_ERR_PROT | CAN_ERR_ACK | CAN_ERR_BUSERROR)) port->health.onEvent(CAN_EVENT_BUS_ERROR, now);
+    if (raw.can_id & CAN_ERR_CRTL) {
+        if (ctrl & (CAN_ERR_CRTL_RX_OVERFLOW | CAN_ERR_CRTL_TX_OVERFLOW)) port->health.onEvent(CAN_EVENT_RX_QUEUE_FULL, now);
+        if (ctrl & CAN_ERR_CRTL_ACTIVE) port->health.onEvent(CAN_EVENT_ERROR_ACTIVE, now);
+        if (ctrl & (CAN_ERR_CRTL_RX_WARNING | CAN_ERR_CRTL_TX_WARNING)) port->health.onEvent(CAN_EVENT_ERROR_WARNING, now);
+        if (ctrl & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE)) port->health.onEvent(CAN_EVENT_ERROR_PASSIVE, now);
+    }
+    if (raw.can_id & CAN_ERR_BUSOFF) port->health.onEvent(CAN_EVENT_BUS_OFF, now);
+    if (raw.can_id & CAN_ERR_RESTARTED) port->health.onEvent(CAN_EVENT_BUS_RECOVERED, now);
+    pthread_mutex_unlock(&port->lock);
+}
+
+static void* rx_thread_main(void* arg) {
+    CANPort* port = (CANPort*)arg;
+    struct pollfd pfd = { port->fd, POLLIN, 0 };
+
+    struct can_frame raw;
+    struct iovec iov = { &raw, sizeof(raw) };
+    char control[CMSG_SPACE(sizeof(uint32_t))];
+
+    while (port->running) {
+        // Short poll timeout so can_port_close() can stop the thread
+        int ready = poll(&pfd, 1, 100);
+        if (ready <= 0) continue;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(port->fd, &msg, 0);
+        uint32_t now_us = micros();
+        if (n != (ssize_t)sizeof(raw)) {
+            pthread_mutex_lock(&port->lock);
+            port->rx_errors++;
+            pthread_mutex_unlock(&port->lock);
+            continue;
+        }
+
+        // Frames the socket dropped because its receive buffer was full
+        for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                uint32_t dropped;
+                memcpy(&dropped, CMSG_DATA(c), sizeof(dropped));
+                pthread_mutex_lock(&port->lock);
+                if (dropped != port->stats.driver_overflows) {
+                    port->health.onEvent(CAN_EVENT_RX_QUEUE_FULL, millis());
+                }
+                port->stats.driver_overflows = dropped;
+                pthread_mutex_unlock(&port->lock);
+            }
+        }
+        if (raw.can_id & CAN_ERR_FLAG) {
+            socketcan_error_frame(port, raw);
+            continue;
+        }
+        if (raw.can_id & CAN_RTR_FLAG) continue;
+
+        CANFrame frame;
+        frame.extended = (raw.can_id & CAN_EFF_FLAG) != 0;
+        frame.id = raw.can_id & (frame.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+        frame.len = raw.can_dlc > 8 ? 8 : raw.can_dlc;
+        memcpy(frame.data, raw.data, sizeof(frame.data));
+        frame.timestamp_us = now_us;
+        port_deliver(port, &frame);
+    }
+    return nullptr;
+}
+
+static int socketcan_open(const char* interface) {
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        printf("[CAN] socket(PF_CAN) failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface, IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        printf("[CAN] Interface %s not found: %s\n", interface, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    // Report socket receive-buffer drops with each frame (driver_overflows)
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+
+    // Controller state changes and errors arrive as error frames
+    can_err_mask_t err_mask = CAN_ERR_TX_TIMEOUT | CAN_ERR_CRTL | CAN_ERR_PROT | CAN_ERR_ACK |
+                              CAN_ERR_BUSOFF | CAN_ERR_BUSERROR | CAN_ERR_RESTARTED;
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &err_mask, sizeof(err_mask));
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        printf("[CAN] bind(%s) failed: %s\n", interface, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool socketcan_write(int fd, const CANFrame* frame) {
+    struct can_frame raw;
+    memset(&raw, 0, sizeof(raw));
+    raw.can_id = frame->extended ? (frame->id | CAN_EFF_FLAG) : frame->id;
+    raw.can_dlc = frame->len;
+    memcpy(raw.data, frame->data, frame->len);
+    return write(fd, &raw, sizeof(raw)) == (ssize_t)sizeof(raw);
+}
+
+// ============================================================================
+// TX QUEUE DRAIN
+// ============================================================================
+
+typedef enum { TX_SENT, TX_BUSY, TX_FAILED } TxResult;
+
+static void tx_stamp(CANPort* port, const CANFrame* frame, uint32_t now_us) {
+    if (port->tx_stamp_id && frame->id == port->tx_stamp_id) {
+        port->tx_stamp_us = now_us;
+        port->tx_stamped = true;
+    }
+}
+
+// One frame to the bus if it has room (caller holds tx_lock)
+static TxResult tx_write(CANPort* port, const CANFrame* frame) {
+    if (port->loopback) {
+        tx_stamp(port, frame, micros());
+        loopback_send(port, frame);
+        return TX_SENT;
+    }
+
+    struct pollfd pfd = { port->fd, POLLOUT, 0 };
+    if (poll(&pfd, 1, 0) <= 0) return TX_BUSY;
+    uint32_t now_us = micros();
+    if (socketcan_write(port->fd, frame)) {
+        tx_stamp(port, frame, now_us);
+        return TX_SENT;
+    }
+
+    // Qdisc full despite POLLOUT: retry from the TX thread
+    if (errno == ENOBUFS || errno == EAGAIN) return TX_BUSY;
+    port->tx_stats.failed++;
+    pthread_mutex_lock(&port->lock);
+    port->health.onEvent(CAN_EVENT_TX_FAILED, millis());
+    pthread_mutex_unlock(&port->lock);
+    return TX_FAILED;
+}
+
+// A frame reached the bus (caller holds tx_lock)
+static void tx_sent(CANPort* port, uint32_t queued_us) {
+    uint32_t latency = micros() - queued_us;
+    port->tx_stats.sent++;
+    port->tx_stats.latency_total_us += latency;
+    if (latency > port->tx_stats.latency_max_us) port->tx_stats.latency_max_us = latency;
+}
+
+// Send queued frames while the bus takes them (caller holds tx_lock)
+static void tx_drain(CANPort* port) {
+    CANTxEntry entry;
+    while (port->tx_queue.pop(&entry, micros(), &port->tx_stats.expired)) {
+        TxResult result = tx_write(port, &entry.frame);
+        if (result == TX_BUSY) {
+            port->tx_queue.requeue(entry);
+            break;
+        }
+        if (result == TX_FAILED) continue;
+        tx_sent(port, entry.queued_us);
+    }
+    port->tx_stats.depth = port->tx_queue.size();
+}
+
+static void* tx_thread_main(void* arg) {
+    CANPort* port = (CANPort*)arg;
+    struct pollfd pfd = { port->fd, POLLOUT, 0 };
+
+    while (port->running) {
+        pthread_mutex_lock(&port->tx_lock);
+        if (port->tx_queue.size() == 0) {
+            // can_port_queue() signals when it leaves frames behind
+            struct timespec until;
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += 100 * 1000000L;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&port->tx_wake, &port->tx_lock, &until);
+        }
+        bool pending = port->tx_queue.size() > 0;
+        pthread_mutex_unlock(&port->tx_lock);
+        if (!pending) continue;
+
+        // Wait for room in the socket's TX queue, then drain
+        if (poll(&pfd, 1, 100) <= 0) continue;
+        pthread_mutex_lock(&port->tx_lock);
+        tx_drain(port);
+        pthread_mutex_unlock(&port->tx_lock);
+    }
+    return nullptr;
+}
+
+// ============================================================================
+// PORT API
+// ============================================================================
+
+CANPort* can_port_open(const CANPortConfig* config) {
+    const char* interface = config->interface ? config->interface : CAN_PORT_LOOPBACK;
+
+    CANPort* port = new CANPort();
+    port->fd = -1;
+    port->loopback = strcmp(interface, CAN_PORT_LOOPBACK) == 0;
+    port->capacity = config->rx_queue_len ? config->rx_queue_len : CAN_PORT_RX_QUEUE_LEN;
+    port->ring = new CANFrame[port->capacity];
+    port->filter = CAN_FILTER_ACCEPT_ALL;
+    port->health.reset(millis());
+    pthread_mutex_init(&port->lock, nullptr);
+    pthread_mutex_init(&port->handler_lock, nullptr);
+    pthread_mutex_init(&port->tx_lock, nullptr);
+    pthread_cond_init(&port->tx_wake, nullptr);
+    memset(&port->tx_stats, 0, sizeof(port->tx_stats));
+    port->tx_stamp_id = 0;
+    port->tx_stamped = false;
+
+    if (port->loopback) {
+        loopback_attach(port);
+    } else {
+        port->fd = socketcan_open(interface);
+        if (port->fd < 0) {
+            can_port_close(port);
+            return nullptr;
+        }
+        port->running = true;
+        if (pthread_create(&port->rx_thread, nullptr, rx_thread_main, port) != 0) {
+            printf("[CAN] Failed to create RX thread\n");
+            port->running = false;
+            can_port_close(port);
+            return nullptr;
+        }
+        if (pthread_create(&port->tx_thread, nullptr, tx_thread_main, port) != 0) {
+            printf("[CAN] Failed to create TX thread\n");
+            port->running = false;
+            pthread_join(port->rx_thread, nullptr);
+            can_port_close(port);
+            return nullptr;
+        }
+    }
+
+    printf("[CAN] Initialized on %s\n", interface);
+    return port;
+}
+
+void can_port_close(CANPort* port) {
+    if (!port) return;
+
+    if (port->loopback) {
+        loopback_detach(port);
+    } else if (port->running) {
+        port->running = false;
+        pthread_mutex_lock(&port->tx_lock);
+        pthread_cond_signal(&port->tx_wake);
+        pthread_mutex_unlock(&port->tx_lock);
+        pthread_join(port->rx_thread, nullptr);
+        pthread_join(port->tx_thread, nullptr);
+    }
+    if (port->fd >= 0) close(port->fd);
+
+    pthread_mutex_destroy(&port->lock);
+    pthread_mutex_destroy(&port->handler_lock);
+    pthread_mutex_destroy(&port->tx_lock);
+    pthread_cond_destroy(&port->tx_wake);
+    delete[] port->ring;
+    delete port;
+}
+
+bool can_port_receive(CANPort* port, CANFrame* frame) {
+    pthread_mutex_lock(&port->lock);
+    bool ok = port->count > 0;
+    if (ok) {
+        *frame = port->ring[port->head];
+        port->head = (port->head + 1) % port->capacity;
+        port->count--;
+    }
+    pthread_mutex_unlock(&port->lock);
+    return ok;
+}
+
+bool can_port_queue(CANPort* port, const CANFrame* frame, uint32_t deadline_us, bool has_deadline) {
+    pthread_mutex_lock(&port->tx_lock);
+
+    // Nothing waiting and the bus has room: straight out, no queueing. Counted
+    // like a frame that passed through the queue at depth 1.
+    if (port->tx_queue.size() == 0) {
+        uint32_t queued_us = micros();
+        TxResult result = tx_write(port, frame);
+        if (result == TX_SENT) {
+            port->tx_stats.queued++;
+            if (port->tx_stats.max_depth < 1) port->tx_stats.max_depth = 1;
+            tx_sent(port, queued_us);
+        }
+        if (result != TX_BUSY) {
+            pthread_mutex_unlock(&port->tx_lock);
+            loopback_flush();
+            return result == TX_SENT;       // TX_FAILED: counted in tx_write()
+        }
+    }
+
+    bool evicted;
+    bool ok = port->tx_queue.push(*frame, micros(), deadline_us, has_deadline, &evicted);
+    if (ok) port->tx_stats.queued++;
+    if (!ok || evicted) port->tx_stats.dropped++;
+    if (port->tx_queue.size() > port->tx_stats.max_depth) port->tx_stats.max_depth = port->tx_queue.size();
+
+    // Send now if the bus has room; the TX thread takes whatever is left
+    tx_drain(port);
+    if (port->tx_queue.size() > 0) pthread_cond_signal(&port->tx_wake);
+    pthread_mutex_unlock(&port->tx_lock);
+    loopback_flush();
+    return ok;
+}
+
+void can_port_get_health(const CANPort* port, CANBusHealth* health) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->lock));
+    port->health.snapshot(health, millis());
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->lock));
+}
+
+void can_port_get_tx_stats(const CANPort* port, CANTxStats* stats) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->tx_lock));
+    *stats = port->tx_stats;
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->tx_lock));
+}
+
+uint16_t can_port_tx_free(const CANPort* port) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->tx_lock));
+    uint16_t free_slots = CAN_PORT_TX_QUEUE_LEN - port->tx_queue.size();
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->tx_lock));
+    return free_slots;
+}
+
+void can_port_set_tx_stamp_id(CANPort* port, uint32_t id) {
+    pthread_mutex_lock(&port->tx_lock);
+    port->tx_stamp_id = id;
+    port->tx_stamped = false;
+    pthread_mutex_unlock(&port->tx_lock);
+}
+
+bool can_port_tx_stamp(CANPort* port, uint32_t* timestamp_us) {
+    pthread_mutex_lock(&port->tx_lock);
+    bool stamped = port->tx_stamped;
+    if (stamped) *timestamp_us = port->tx_stamp_us;
+    port->tx_stamped = false;
+    pthread_mutex_unlock(&port->tx_lock);
+    return stamped;
+}
+
+uint32_t can_port_rx_errors(const CANPort* port) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->lock));
+    uint32_t errors = port->rx_errors;
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->lock));
+    return errors;
+}
+
+bool can_port_set_filter(CANPort* port, const CANFilter* filter) {
+    pthread_mutex_lock(&port->lock);
+    port->filter = *filter;
+    pthread_mutex_unlock(&port->lock);
+    return true;
+}
+
+void can_port_set_rx_handler(CANPort* port, can_port_rx_handler_t handler, void* context) {
+    pthread_mutex_lock(&port->handler_lock);
+    port->rx_handler = handler;
+    port->rx_context = context;
+    pthread_mutex_unlock(&port->handler_lock);
+}
+
+void can_port_lock_rx_handler(CANPort* port) {
+    pthread_mutex_lock(&port->handler_lock);
+}
+
+void can_port_unlock_rx_handler(CANPort* port) {
+    pthread_mutex_unlock(&port->handler_lock);
+}
+
+void can_port_get_stats(const CANPort* port, CANPortStats* stats) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->lock));
+    *stats = port->stats;
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->lock));
+}
+
+uint32_t can_port_rx_filtered(const CANPort* port) {
+    pthread_mutex_lock(const_cast<pthread_mutex_t*>(&port->lock));
+    uint32_t filtered = port->rx_filtered;
+    pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&port->lock));
+    return filtered;
+}
+
+#endif // LEAFCAN_PLATFORM_LINUX
@@ -0,0 +1,377 @@
+#include "LeafCANRegistry.h"
+
+// ============================================================================
+// SIGNAL TABLES
+// ============================================================================
+// Each table mirrors the matching unpack_* function in LeafCANMessages.cpp.
+// Field order: name, unit, start_byte, length, flags, shift, mask, scale, offset
+
+#define LE      0
+#define BE      LEAFCAN_SIG_BIG_ENDIAN
+#define S       LEAFCAN_SIG_SIGNED
+#define SBE     (LEAFCAN_SIG_SIGNED | LEAFCAN_SIG_BIG_ENDIAN)
+
+#define COUNT(a) ((uint8_t)(sizeof(a) / sizeof((a)[0])))
+
+#ifdef ROAM_MOTOR
+// ROAM motor temperatures #1 (0x0A0)
+static const leafcan_signal_t SIG_ROAM_TEMP1[] = {
+    { "temp_igbt_a",        "degC", 0, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_igbt_b",        "degC", 2, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_igbt_c",        "degC", 4, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_gate_driver",   "degC", 6, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+};
+
+// ROAM motor temperatures #2 (0x0A1)
+static const leafcan_signal_t SIG_ROAM_TEMP2[] = {
+    { "temp_control_board", "degC", 0, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_rtd1",          "degC", 2, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_rtd2",          "degC", 4, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_rtd3",          "degC", 6, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+};
+
+// ROAM motor temperatures #3 (0x0A2)
+static const leafcan_signal_t SIG_ROAM_TEMP3[] = {
+    { "temp_rtd4",          "degC", 0, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_rtd5",          "degC", 2, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "temp_stator",        "degC", 4, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "torque_shudder",     "",     6, 2, S, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+// ROAM motor position (0x0A5)
+static const leafcan_signal_t SIG_ROAM_POSITION[] = {
+    { "position_angle",     "deg",  0, 2, BE,  0, 0xFFFF, 1.0, 0.0 },
+    { "rpm",                "rpm",  2, 2, S,   0, 0xFFFF, 1.0, 0.0 },
+    { "electrical_freq",    "Hz",   4, 2, BE,  0, 0xFFFF, 1.0, 0.0 },
+    { "delta_resolver",     "deg",  6, 2, SBE, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+// ROAM motor current (0x0A6)
+static const leafcan_signal_t SIG_ROAM_CURRENT[] = {
+    { "current_phase_a",    "A",    0, 2, SBE, 0, 0xFFFF, 1.0, 0.0 },
+    { "current_phase_b",    "A",    2, 2, SBE, 0, 0xFFFF, 1.0, 0.0 },
+    { "current_phase_c",    "A",    4, 2, SBE, 0, 0xFFFF, 1.0, 0.0 },
+    { "current_dc_bus",     "A",    6, 2, SBE, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+// ROAM motor voltage (0x0A7)
+static const leafcan_signal_t SIG_ROAM_VOLTAGE[] = {
+    { "voltage_dc_bus",     "V",    0, 2, BE, 0, 0xFFFF, 1.0, 0.0 },
+    { "voltage_output",     "V",    2, 2, BE, 0, 0xFFFF, 1.0, 0.0 },
+    { "voltage_vab_vd",     "V",    4, 2, BE, 0, 0xFFFF, 1.0, 0.0 },
+    { "voltage_vbc_vq",     "V",    6, 2, BE, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+// ROAM motor torque (0x0AC)
+static const leafcan_signal_t SIG_ROAM_TORQUE[] = {
+    { "torque_request",     "Nm",   0, 2, S, 0, 0xFFFF, 1.0, 0.0 },
+    { "torque_actual",      "Nm",   2, 2, S, 0, 0xFFFF, 1.0, 0.0 },
+};
+#endif // ROAM_MOTOR
+
+// Vehicle speed (0x1D4)
+static const leafcan_signal_t SIG_VEHICLE_SPEED[] = {
+    { "speed_kmh",          "km/h", 0, 2, LE, 0, 0xFFFF, 0.01, 0.0 },
+};
+
+// Motor RPM (0x1DA)
+static const leafcan_signal_t SIG_MOTOR_RPM[] = {
+    { "rpm",                "rpm",  0, 2, S,  0, 0xFFFF, 1.0, 0.0 },
+    { "direction",          "",     2, 1, LE, 0, 0xFF,   1.0, 0.0 },
+};
+
+// Battery SOC (0x1DB)
+static const leafcan_signal_t SIG_BATTERY_SOC[] = {
+    { "soc_percent",        "%",    0, 1, LE, 1, 0xFE,   1.0, 0.0 },
+    { "gids",               "",     2, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+    { "voltage",            "V",    4, 2, LE, 0, 0xFFFF, 0.5, 0.0 },
+    { "current",            "A",    6, 2, S,  0, 0xFFFF, 0.1, 0.0 },
+};
+
+// Battery temperature (0x1DC)
+static const leafcan_signal_t SIG_BATTERY_TEMP[] = {
+    { "temp_max",           "degC", 0, 1, S,  0, 0xFF, 1.0, -40.0 },
+    { "temp_min",           "degC", 1, 1, S,  0, 0xFF, 1.0, -40.0 },
+    { "temp_avg",           "degC", 2, 1, S,  0, 0xFF, 1.0, -40.0 },
+    { "temp_sensor_count",  "",     3, 1, LE, 0, 0xFF, 1.0, 0.0 },
+};
+
+// Inverter telemetry (0x1F2)
+static const leafcan_signal_t SIG_INVERTER[] = {
+    { "voltage",            "V",    0, 2, LE, 0, 0xFFFF, 0.5, 0.0 },
+    { "current",            "A",    2, 2, S,  0, 0xFFFF, 0.1, 0.0 },
+    { "temp_inverter",      "degC", 4, 1, LE, 0, 0xFF,   1.0, -40.0 },
+    { "temp_motor",         "degC", 5, 1, LE, 0, 0xFF,   1.0, -40.0 },
+    { "status_flags",       "",     6, 1, LE, 0, 0xFF,   1.0, 0.0 },
+};
+
+// Victron / EMBOO pack limits (0x351)
+static const leafcan_signal_t SIG_PACK_LIMITS[] = {
+    { "charge_voltage",     "V",    0, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "charge_current_limit", "A",  2, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "discharge_current_limit", "A", 4, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "discharge_voltage",  "V",    6, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+};
+
+// Victron / EMBOO SOC and SOH (0x355)
+static const leafcan_signal_t SIG_PACK_SOC[] = {
+    { "soc_percent",        "%",    0, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+    { "soh_percent",        "%",    2, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+    { "soc_decimal",        "%",    4, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+};
+
+// Victron / EMBOO pack measurements (0x356)
+static const leafcan_signal_t SIG_PACK_MEASUREMENTS[] = {
+    { "voltage",            "V",    0, 2, LE, 0, 0xFFFF, 0.01, 0.0 },
+    { "current",            "A",    2, 2, S,  0, 0xFFFF, 0.1,  0.0 },
+    { "temperature",        "degC", 4, 2, LE, 0, 0xFFFF, 0.1,  0.0 },
+};
+
+// Victron battery characteristics (0x35F)
+static const leafcan_signal_t SIG_PACK_INFO[] = {
+    { "cell_type",          "",     0, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "cell_quantity",      "",     1, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "firmware_major",     "",     2, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "firmware_minor",     "",     3, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "capacity",           "Ah",   4, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+    { "manufacturer_id",    "",     6, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+// Victron cell module extrema (0x370)
+static const leafcan_signal_t SIG_CELL_EXTREMA[] = {
+    { "cell_temp_max",      "degC", 0, 2, LE, 0, 0xFFFF, 1.0,   0.0 },
+    { "cell_temp_min",      "degC", 2, 2, LE, 0, 0xFFFF, 1.0,   0.0 },
+    { "cell_voltage_max",   "V",    4, 2, LE, 0, 0xFFFF, 0.001, 0.0 },
+    { "cell_voltage_min",   "V",    6, 2, LE, 0, 0xFFFF, 0.001, 0.0 },
+};
+
+// Charger status (0x390)
+static const leafcan_signal_t SIG_CHARGER[] = {
+    { "charging_flag",      "",     0, 1, LE, 0, 0x01,   1.0, 0.0 },
+    { "charge_current",     "A",    1, 1, LE, 0, 0xFF,   0.5, 0.0 },
+    { "charge_voltage",     "V",    2, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "charge_time_remaining_min", "min", 4, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+};
+
+#ifdef EMBOO_BATTERY
+// EMBOO pack status (0x6B0)
+static const leafcan_signal_t SIG_EMBOO_PACK_STATUS[] = {
+    { "current",            "A",    0, 2, SBE, 0, 0xFFFF, 0.1, 0.0 },
+    { "voltage",            "V",    2, 2, BE,  0, 0xFFFF, 0.1, 0.0 },
+    { "amphours",           "Ah",   4, 2, BE,  0, 0xFFFF, 0.1, 0.0 },
+    { "soc_percent",        "%",    6, 1, LE,  0, 0xFF,   0.5, 0.0 },
+};
+
+// EMBOO pack statistics (0x6B1)
+static const leafcan_signal_t SIG_EMBOO_PACK_STATS[] = {
+    { "relay_state",        "",     0, 2, BE, 0, 0xFFFF, 1.0,  0.0 },
+    { "temp_max",           "degC", 2, 1, LE, 0, 0xFF,   1.0,  0.0 },
+    { "input_voltage",      "V",    3, 2, BE, 0, 0xFFFF, 0.1,  0.0 },
+    { "summed_voltage",     "V",    5, 2, BE, 0, 0xFFFF, 0.01, 0.0 },
+};
+
+// EMBOO status flags (0x6B2)
+static const leafcan_signal_t SIG_EMBOO_STATUS_FLAGS[] = {
+    { "status_flags",       "",     0, 1, LE, 0, 0xFF, 1.0, 0.0 },
+    { "error_flags",        "",     3, 1, LE, 0, 0xFF, 1.0, 0.0 },
+};
+
+// EMBOO cell voltage (0x6B3). cell_id > 100 marks a header frame whose
+// remaining signals are meaningless; consumers must check it.
+static const leafcan_signal_t SIG_EMBOO_CELL[] = {
+    { "cell_id",            "",     0, 1, LE, 0,  0xFF,   1.0,    0.0 },
+    { "cell_voltage",       "V",    1, 2, BE, 0,  0xFFFF, 0.0001, 0.0 },
+    { "cell_resistance",    "mOhm", 3, 2, BE, 0,  0x7FFF, 0.01,   0.0 },
+    { "cell_balancing",     "",     3, 2, BE, 15, 0x8000, 1.0,    0.0 },
+    { "cell_open_voltage",  "V",    5, 2, BE, 0,  0xFFFF, 0.0001, 0.0 },
+};
+
+// EMBOO temperatures (0x6B4)
+static const leafcan_signal_t SIG_EMBOO_TEMPS[] = {
+    { "temp_max",           "degC", 2, 1, LE, 0, 0xFF, 1.0, 0.0 },
+    { "temp_min",           "degC", 3, 1, LE, 0, 0xFF, 1.0, 0.0 },
+    { "rolling_counter",    "",     4, 1, LE, 0, 0xFF, 1.0, 0.0 },
+};
+#endif // EMBOO_BATTERY
+
+// GPS position (0x710)
+static const leafcan_signal_t SIG_GPS_POSITION[] = {
+    { "latitude",           "deg",  0, 4, S,  0, 0xFFFFFFFF, 1e-7, 0.0 },
+    { "altitude",           "m",    4, 2, S,  0, 0xFFFF,     1.0,  0.0 },
+    { "satellites",         "",     6, 1, LE, 0, 0xFF,       1.0,  0.0 },
+    { "fix_quality",        "",     7, 1, LE, 0, 0xFF,       1.0,  0.0 },
+};
+
+// GPS velocity (0x711)
+static const leafcan_signal_t SIG_GPS_VELOCITY[] = {
+    { "longitude",          "deg",  0, 4, S,  0, 0xFFFFFFFF, 1e-7, 0.0 },
+    { "speed_kmh",          "km/h", 4, 2, LE, 0, 0xFFFF,     0.01, 0.0 },
+    { "heading",            "deg",  6, 2, LE, 0, 0xFFFF,     0.01, 0.0 },
+};
+
+// GPS time (0x712)
+static const leafcan_signal_t SIG_GPS_TIME[] = {
+    { "year",               "",     0, 2, LE, 0, 0xFFFF, 1.0, 0.0 },
+    { "month",              "",     2, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "day",                "",     3, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "hour",               "",     4, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "minute",             "",     5, 1, LE, 0, 0xFF,   1.0, 0.0 },
+    { "second",             "",     6, 1, LE, 0, 0xFF,   1.0, 0.0 },
+};
+
+// Body temperature sensors (0x720)
+static const leafcan_signal_t SIG_BODY_TEMP[] = {
+    { "body_temp1",         "degC", 0, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "body_temp2",         "degC", 2, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "body_temp3",         "degC", 4, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+    { "body_temp4",         "degC", 6, 2, S, 0, 0xFFFF, 0.1, 0.0 },
+};
+
+// Body voltage monitoring (0x721)
+static const leafcan_signal_t SIG_BODY_VOLTAGE[] = {
+    { "aux_voltage_12v",    "V",    0, 2, LE, 0, 0xFFFF, 0.01, 0.0 },
+    { "aux_voltage_5v",     "V",    2, 2, LE, 0, 0xFFFF, 0.01, 0.0 },
+    { "aux_current_12v",    "A",    4, 2, LE, 0, 0xFFFF, 0.01, 0.0 },
+};
+
+// Elcon charger status (0x18FF50E5, extended ID)
+static const leafcan_signal_t SIG_ELCON[] = {
+    { "output_voltage",     "V",    0, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "output_current",     "A",    2, 2, LE, 0, 0xFFFF, 0.1, 0.0 },
+    { "hw_status",          "",     4, 1, LE, 0, 0x01,   1.0, 0.0 },
+    { "temp_status",        "",     4, 1, LE, 1, 0x02,   1.0, 0.0 },
+    { "input_voltage_status", "",   4, 1, LE, 2, 0x04,   1.0, 0.0 },
+    { "charging_state",     "",     4, 1, LE, 3, 0x08,   1.0, 0.0 },
+    { "comm_status",        "",     4, 1, LE, 4, 0x10,   1.0, 0.0 },
+};
+
+// ============================================================================
+// MESSAGE TABLE (must stay sorted by can_id)
+// ============================================================================
+// Contents depend on the build configuration (see LeafCANRegistry.h).
+
+#define MSG(id, name, dlc, min_len, sigs) { id, name, dlc, min_len, COUNT(sigs), sigs }
+
+static const leafcan_message_t MESSAGES[] = {
+#ifdef ROAM_MOTOR
+    MSG(0x0A0, "roam_motor_temp1",    8, 8, SIG_ROAM_TEMP1),
+    MSG(0x0A1, "roam_motor_temp2",    8, 8, SIG_ROAM_TEMP2),
+    MSG(0x0A2, "roam_motor_temp3",    8, 8, SIG_ROAM_TEMP3),
+    MSG(0x0A5, "roam_motor_position", 8, 8, SIG_ROAM_POSITION),
+    MSG(0x0A6, "roam_motor_current",  8, 8, SIG_ROAM_CURRENT),
+    MSG(0x0A7, "roam_motor_voltage",  8, 8, SIG_ROAM_VOLTAGE),
+    MSG(0x0AC, "roam_motor_torque",   4, 4, SIG_ROAM_TORQUE),
+#endif
+    MSG(0x1D4, "vehicle_speed",       2, 2, SIG_VEHICLE_SPEED),
+    MSG(0x1DA, "motor_rpm",           3, 3, SIG_MOTOR_RPM),
+    MSG(0x1DB, "battery_soc",         8, 8, SIG_BATTERY_SOC),
+    MSG(0x1DC, "battery_temp",        8, 4, SIG_BATTERY_TEMP),
+    MSG(0x1F2, "inverter_telemetry",  8, 8, SIG_INVERTER),
+    MSG(0x351, "pack_limits",         8, 8, SIG_PACK_LIMITS),
+    MSG(0x355, "pack_soc",            6, 4, SIG_PACK_SOC),
+    MSG(0x356, "pack_measurements",   6, 6, SIG_PACK_MEASUREMENTS),
+    MSG(0x35F, "pack_info",           8, 8, SIG_PACK_INFO),
+    MSG(0x370, "cell_extrema",        8, 8, SIG_CELL_EXTREMA),
+    MSG(0x390, "charger_status",      8, 8, SIG_CHARGER),
+#ifdef EMBOO_BATTERY
+    MSG(0x6B0, "emboo_pack_status",   8, 8, SIG_EMBOO_PACK_STATUS),
+    MSG(0x6B1, "emboo_pack_stats",    8, 8, SIG_EMBOO_PACK_STATS),
+    MSG(0x6B2, "emboo_status_flags",  8, 8, SIG_EMBOO_STATUS_FLAGS),
+    MSG(0x6B3, "emboo_cell_voltage",  8, 8, SIG_EMBOO_CELL),
+    MSG(0x6B4, "emboo_temperatures",  8, 8, SIG_EMBOO_TEMPS),
+#endif
+    MSG(0x710, "gps_position",        8, 8, SIG_GPS_POSITION),
+    MSG(0x711, "gps_velocity",        8, 8, SIG_GPS_VELOCITY),
+    MSG(0x712, "gps_time",            7, 7, SIG_GPS_TIME),
+    MSG(0x720, "body_temp",           8, 8, SIG_BODY_TEMP),
+    MSG(0x721, "body_voltage",        6, 6, SIG_BODY_VOLTAGE),
+    MSG(0x18FF50E5, "elcon_charger_status", 8, 5, SIG_ELCON),
+};
+
+static const size_t MESSAGE_COUNT = sizeof(MESSAGES) / sizeof(MESSAGES[0]);
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+static double decode_signal(const leafcan_signal_t* sig, const uint8_t* data) {
+    uint32_t raw = 0;
+    if (sig->flags & LEAFCAN_SIG_BIG_ENDIAN) {
+        for (uint8_t i = 0; i < sig->length; i++) {
+            raw = (raw << 8) | data[sig->start_byte + i];
+        }
+    } else {
+        for (uint8_t i = 0; i < sig->length; i++) {
+            raw |= (uint32_t)data[sig->start_byte + i] << (8 * i);
+        }
+    }
+    raw = (raw & sig->mask) >> sig->shift;
+
+    if (sig->flags & LEAFCAN_SIG_SIGNED) {
+        // Sign-extend from length * 8 bits
+        uint32_t sign_bit = 1u << (sig->length * 8 - 1);
+        int64_t v = (int64_t)(raw ^ sign_bit) - (int64_t)sign_bit;
+        return (double)v * sig->scale + sig->offset;
+    }
+    return (double)raw * sig->scale + sig->offset;
+}
+
+extern "C" {
+
+uint32_t leafcan_abi_version(void) {
+    return LEAFCAN_ABI_VERSION;
+}
+
+size_t leafcan_message_count(void) {
+    return MESSAGE_COUNT;
+}
+
+const leafcan_message_t* leafcan_message_at(size_t index) {
+    return (index < MESSAGE_COUNT) ? &MESSAGES[index] : nullptr;
+}
+
+const leafcan_message_t* leafcan_find(uint32_t can_id) {
+    size_t lo = 0;
+    size_t hi = MESSAGE_COUNT;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (MESSAGES[mid].can_id < can_id) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < MESSAGE_COUNT && MESSAGES[lo].can_id == can_id) ? &MESSAGES[lo] : nullptr;
+}
+
+int leafcan_decode(uint32_t can_id, const uint8_t* data, uint8_t len,
+                   double* values, int max_values) {
+    if (!data || !values) return LEAFCAN_ERR_ARGS;
+
+    const leafcan_message_t* msg = leafcan_find(can_id);
+    if (!msg) return LEAFCAN_ERR_UNKNOWN_ID;
+    if (len < msg->min_len) return LEAFCAN_ERR_SHORT_FRAME;
+
+    // Zero-fill so optional trailing signals of short frames read as 0
+    uint8_t frame[8] = {0};
+    for (uint8_t i = 0; i < len && i < 8; i++) frame[i] = data[i];
+
+    int count = (msg->signal_count < max_values) ? msg->signal_count : max_values;
+    for (int i = 0; i < count; i++) {
+        values[i] = decode_signal(&msg->signals[i], frame);
+    }
+    return count;
+}
+
+size_t leafcan_decode_batch(const uint32_t* can_ids, const uint8_t* data, const uint8_t* lens,
+                            size_t n, double* values, int8_t* counts) {
+    if (!can_ids || !data || !lens || !values || !counts) return 0;
+
+    size_t decoded = 0;
+    for (size_t i = 0; i < n; i++) {
+        int rc = leafcan_decode(can_ids[i], data + i * 8, lens[i],
+                                values + i * LEAFCAN_MAX_SIGNALS, LEAFCAN_MAX_SIGNALS);
+        counts[i] = (int8_t)rc;
+        if (rc >= 0) decoded++;
+    }
+    return decoded;
+}
+
+} // extern "C"
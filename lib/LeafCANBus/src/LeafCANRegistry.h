@@ -0,0 +1,93 @@
+#ifndef LEAF_CAN_REGISTRY_H
+#define LEAF_CAN_REGISTRY_H
+
+// ============================================================================
+// CAN MESSAGE REGISTRY (stable C ABI)
+// ============================================================================
+// One descriptor table for every CAN ID on the network. The dashboard, the
+// ESP32 firmware and the Python services (via ctypes on libleafcan.so) all
+// decode frames through leafcan_decode() so each ID has exactly one layout.
+//
+// Which messages the table holds is fixed at build time by the battery/motor
+// selection (config/hardware_config.h, see LeafCANMessages.h): ROAM_MOTOR adds
+// 0x0A0-0x0AC, EMBOO_BATTERY adds 0x6B0-0x6B4. A libleafcan.so only knows the
+// IDs of the configuration it was built with; leafcan_find() returns NULL for
+// the rest. The ABI below (struct layouts, signal order) is the same in every
+// configuration, so consumers should enumerate rather than assume an ID set.
+//
+// Layouts follow LeafCANMessages.cpp (which the ESP32 modules use to produce
+// frames). Victron IDs 0x351/0x355/0x356/0x35F/0x370 are little-endian as
+// sent by modules/bms-victron.
+//
+// ABI rules: structs below are append-only, signal order within a message
+// never changes (consumers may index values positionally), and new signals
+// are only ever appended. Bump LEAFCAN_ABI_VERSION on any breaking change.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "LeafCANMessages.h"   // Battery/motor selection + CAN_ID_* defines
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LEAFCAN_ABI_VERSION         1
+#define LEAFCAN_MAX_SIGNALS         8
+
+// Signal flags
+#define LEAFCAN_SIG_SIGNED          0x01  // Two's complement over length * 8 bits
+#define LEAFCAN_SIG_BIG_ENDIAN      0x02  // Motorola byte order
+
+// leafcan_decode() error codes
+#define LEAFCAN_ERR_UNKNOWN_ID      -1
+#define LEAFCAN_ERR_SHORT_FRAME     -2
+#define LEAFCAN_ERR_ARGS            -3
+
+typedef struct {
+    const char* name;       // snake_case, matches telemetry field names
+    const char* unit;       // "V", "A", "degC", ... ("" for raw/flags)
+    uint8_t start_byte;
+    uint8_t length;         // Bytes: 1, 2 or 4
+    uint8_t flags;          // LEAFCAN_SIG_*
+    uint8_t shift;          // Right shift applied after masking
+    uint32_t mask;          // Applied to the assembled raw value
+    double scale;           // physical = raw * scale + offset
+    double offset;
+} leafcan_signal_t;
+
+typedef struct {
+    uint32_t can_id;        // 11-bit or 29-bit identifier (no flag bits)
+    const char* name;
+    uint8_t dlc;            // DLC the producer sends
+    uint8_t min_len;        // Shorter frames are rejected
+    uint8_t signal_count;
+    const leafcan_signal_t* signals;
+} leafcan_message_t;
+
+uint32_t leafcan_abi_version(void);
+
+// Registry enumeration (sorted by can_id)
+size_t leafcan_message_count(void);
+const leafcan_message_t* leafcan_message_at(size_t index);
+
+// O(log n) lookup, NULL if the ID is not registered
+const leafcan_message_t* leafcan_find(uint32_t can_id);
+
+// Decode one frame into physical values, in the message's signal order.
+// Returns the number of values written or a LEAFCAN_ERR_* code.
+int leafcan_decode(uint32_t can_id, const uint8_t* data, uint8_t len,
+                   double* values, int max_values);
+
+// Decode n frames in one call (amortizes FFI overhead for ctypes callers).
+// data is n * 8 bytes, values is n * LEAFCAN_MAX_SIGNALS doubles, and
+// counts[i] receives the per-frame leafcan_decode() result.
+// Returns the number of frames that decoded successfully.
+size_t leafcan_decode_batch(const uint32_t* can_ids, const uint8_t* data, const uint8_t* lens,
+                            size_t n, double* values, int8_t* counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LEAF_CAN_REGISTRY_H
@@ -0,0 +1,93 @@
+#ifndef LEAF_CAN_STATE_H
+#define LEAF_CAN_STATE_H
+
+// ============================================================================
+// DOUBLE-BUFFERED STATE (RX task writes, application reads)
+// ============================================================================
+// State for LeafCANBus::subscribeDirect(): unpack callbacks run in the RX
+// task and write into the back buffer, which is then published with one
+// atomic store. Readers on any core get a consistent copy with read(),
+// without locks; the writer never waits.
+//
+// Sequence counter: even = buffer (seq/2)&1 is stable, odd = the writer is
+// filling the other one. The writer makes seq odd before it touches the back
+// buffer at all, preload included, so a reader's copy is valid unless seq
+// advanced by more than 2 meanwhile (the writer started refilling that same
+// buffer), in which case it copies again.
+//
+// One writer only (the RX task). Several IDs may share one state; each
+// update starts from the latest published value.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+class LeafCANStateBase {
+public:
+    // Writer side (RX task): returns the back buffer, preloaded with the
+    // latest state; endWrite() publishes it
+    void* beginWrite() {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        void* back = buffers[((s + 2) >> 1) & 1];
+        memcpy(back, buffers[(s >> 1) & 1], size);
+        return back;
+    }
+
+    void endWrite() {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Number of published updates (poll it to see whether anything changed)
+    uint32_t updateCount() const { return seq.load(std::memory_order_acquire) >> 1; }
+
+protected:
+    LeafCANStateBase(void* front, void* back, size_t size) : seq(0), size(size) {
+        buffers[0] = front;
+        buffers[1] = back;
+    }
+
+    void readInto(void* out) const {
+        while (true) {
+            uint32_t s1 = seq.load(std::memory_order_acquire) & ~1u;
+            memcpy(out, buffers[(s1 >> 1) & 1], size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t s2 = seq.load(std::memory_order_relaxed);
+            if (s2 - s1 <= 2) return;
+        }
+    }
+
+private:
+    std::atomic<uint32_t> seq;
+    void* buffers[2];
+    size_t size;
+};
+
+template <typename T>
+class LeafCANState : public LeafCANStateBase {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "LeafCANState needs a plain struct");
+
+    LeafCANState() : LeafCANStateBase(&storage[0], &storage[1], sizeof(T)) {
+        memset(storage, 0, sizeof(storage));
+    }
+
+    explicit LeafCANState(const T& initial) : LeafCANStateBase(&storage[0], &storage[1], sizeof(T)) {
+        storage[0] = initial;
+        storage[1] = initial;
+    }
+
+    // Latest consistent snapshot
+    T read() const {
+        T out;
+        readInto(&out);
+        return out;
+    }
+
+private:
+    T storage[2];
+};
+
+#endif // LEAF_CAN_STATE_H
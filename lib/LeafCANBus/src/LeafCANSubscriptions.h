@@ -0,0 +1,162 @@
+#ifndef LEAF_CAN_SUBSCRIPTIONS_H
+#define LEAF_CAN_SUBSCRIPTIONS_H
+
+// ============================================================================
+// SUBSCRIPTION INDEX (CAN ID -> callback chain)
+// ============================================================================
+// Exact-ID subscriptions live in an open-addressing hash table (linear
+// probing, load factor <= 0.5) whose slots point at a chain of entries, so
+// dispatch is one probe plus the callbacks for that ID regardless of how
+// many subscriptions exist. Mask subscriptions ("every ID in 0x6B0-0x6B7")
+// form one extra chain that is checked for every frame; keep them few.
+//
+// Callbacks for one frame run in subscribe order: exact matches first, then
+// mask matches. There is no removal; subscriptions last until clear().
+// Header-only and Arduino-free so the host bench can drive it directly.
+
+#include <stdint.h>
+
+// Subscription callback type
+typedef void (*can_unpack_callback_t)(const uint8_t* data, uint8_t len, void* state);
+
+// Identifier bits compared by an exact subscription (11- or 29-bit IDs)
+#define CAN_SUB_EXACT_MASK 0x1FFFFFFFu
+
+// Smallest power of two >= 2 * capacity (hash table size)
+constexpr uint16_t can_sub_table_size(uint32_t n, uint32_t capacity) {
+    return n >= 2u * capacity ? (uint16_t)n : can_sub_table_size(n * 2, capacity);
+}
+
+constexpr uint8_t can_sub_log2(uint32_t n) {
+    return n <= 1 ? 0 : 1 + can_sub_log2(n / 2);
+}
+
+template <uint16_t CAPACITY>
+class LeafCANSubscriptionIndex {
+public:
+    static_assert(CAPACITY > 0 && CAPACITY <= 0x4000, "CAPACITY too large for 16-bit slot indices");
+
+    struct Entry {
+        uint32_t can_id;
+        uint32_t mask;              // CAN_SUB_EXACT_MASK for exact subscriptions
+        can_unpack_callback_t unpack_fn;
+        void* state_ptr;
+        uint16_t next;              // Next entry in this ID's chain, NONE at the end
+    };
+
+    LeafCANSubscriptionIndex() { clear(); }
+
+    void clear() {
+        entry_count = 0;
+        id_count = 0;
+        mask_head = mask_tail = NONE;
+        for (uint16_t i = 0; i < TABLE_SIZE; i++) slots[i].head = NONE;
+    }
+
+    // Exact subscription; false when the index is full
+    bool add(uint32_t can_id, can_unpack_callback_t unpack_fn, void* state_ptr) {
+        if (entry_count >= CAPACITY) return false;
+        can_id &= CAN_SUB_EXACT_MASK;
+
+        Slot* slot = probe(can_id);
+        uint16_t index = push(can_id, CAN_SUB_EXACT_MASK, unpack_fn, state_ptr);
+        if (slot->head == NONE) {
+            slot->can_id = can_id;
+            slot->head = index;
+            id_count++;
+        } else {
+            entries[slot->tail].next = index;
+        }
+        slot->tail = index;
+        return true;
+    }
+
+    // Matches every ID with (id & mask) == (can_id & mask). A mask within
+    // 0x7FF only matches standard IDs (0x000-0x7FF), as the filter assumes.
+    bool addMask(uint32_t can_id, uint32_t mask, can_unpack_callback_t unpack_fn, void* state_ptr) {
+        if (entry_count >= CAPACITY) return false;
+        mask &= CAN_SUB_EXACT_MASK;
+        if (mask <= 0x7FF) mask |= CAN_SUB_EXACT_MASK & ~0x7FFu;
+
+        uint16_t index = push(can_id & mask, mask, unpack_fn, state_ptr);
+        if (mask_head == NONE) mask_head = index;
+        else entries[mask_tail].next = index;
+        mask_tail = index;
+        return true;
+    }
+
+    // Run every callback subscribed to can_id; returns how many ran
+    uint16_t dispatch(uint32_t can_id, const uint8_t* data, uint8_t len) const {
+        uint16_t called = 0;
+        can_id &= CAN_SUB_EXACT_MASK;
+
+        const Slot* slot = probe(can_id);
+        for (uint16_t i = slot->head; i != NONE; i = entries[i].next) {
+            entries[i].unpack_fn(data, len, entries[i].state_ptr);
+            called++;
+        }
+        for (uint16_t i = mask_head; i != NONE; i = entries[i].next) {
+            if (((can_id ^ entries[i].can_id) & entries[i].mask) == 0) {
+                entries[i].unpack_fn(data, len, entries[i].state_ptr);
+                called++;
+            }
+        }
+        return called;
+    }
+
+    // Entries in subscribe order (exact and mask), e.g. to derive a filter
+    uint16_t size() const { return entry_count; }
+    const Entry& entry(uint16_t i) const { return entries[i]; }
+
+    // Distinct exact IDs
+    uint16_t idCount() const { return id_count; }
+
+private:
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    static constexpr uint16_t TABLE_SIZE = can_sub_table_size(4, CAPACITY);
+    static constexpr uint8_t TABLE_BITS = can_sub_log2(TABLE_SIZE);
+
+    struct Slot {
+        uint32_t can_id;
+        uint16_t head;              // NONE = empty slot
+        uint16_t tail;
+    };
+
+    // Fibonacci hashing spreads clustered IDs (0x6B0, 0x6B1, ...) across slots
+    static uint16_t hash(uint32_t can_id) {
+        return (uint16_t)((can_id * 2654435769u) >> (32 - TABLE_BITS));
+    }
+
+    // Slot holding can_id, or the empty slot where it would go. The table is
+    // never more than half full, so the loop always terminates.
+    Slot* probe(uint32_t can_id) {
+        uint16_t h = hash(can_id);
+        while (slots[h].head != NONE && slots[h].can_id != can_id) {
+            h = (h + 1) & (TABLE_SIZE - 1);
+        }
+        return &slots[h];
+    }
+    const Slot* probe(uint32_t can_id) const {
+        return const_cast<LeafCANSubscriptionIndex*>(this)->probe(can_id);
+    }
+
+    uint16_t push(uint32_t can_id, uint32_t mask, can_unpack_callback_t unpack_fn, void* state_ptr) {
+        Entry& e = entries[entry_count];
+        e.can_id = can_id;
+        e.mask = mask;
+        e.unpack_fn = unpack_fn;
+        e.state_ptr = state_ptr;
+        e.next = NONE;
+        return entry_count++;
+    }
+
+    Entry entries[CAPACITY];
+    Slot slots[TABLE_SIZE];
+    uint16_t entry_count;
+    uint16_t id_count;
+    uint16_t mask_head;
+    uint16_t mask_tail;
+};
+
+#endif // LEAF_CAN_SUBSCRIPTIONS_H
@@ -0,0 +1,179 @@
+#ifndef LEAF_CAN_TIME_SYNC_H
+#define LEAF_CAN_TIME_SYNC_H
+
+// ============================================================================
+// TIME SYNC (two-step sync / follow-up, gPTP style)
+// ============================================================================
+// One node (the GPS module or the Pi) is the master. Every interval it sends
+//
+//   CAN_ID_TIME_SYNC       [seq]
+//   CAN_ID_TIME_FOLLOW_UP  [seq, master time of that sync (56-bit us, LE)]
+//
+// where the follow-up carries the time the sync actually left the master's
+// controller (TX stamp from the port), so queueing and arbitration delays
+// before transmission cancel out. Followers stamp the sync on reception
+// (port RX timestamp), pair it with the follow-up and estimate offset and
+// drift to the master clock; syncedMicros() on any node then reads the
+// master's microsecond clock. Frames can carry the low 32 bits of it as an
+// origin timestamp and receivers compute the age with originAgeUs().
+//
+// Remaining error is the difference between TX-alert and RX-stamp latency
+// on the two nodes (a few tens of us on ESP32, less on SocketCAN).
+//
+// Time is passed in so the host bench can drive it with simulated clocks.
+// No locking: the owner serializes calls.
+
+#include <stdint.h>
+#include <string.h>
+
+#define CAN_TIME_SYNC_INTERVAL_MS  1000    // Master default
+#define CAN_TIME_SYNC_LOST_MS      5000    // Follower unsynced after this long without a sample
+#define CAN_TIME_SYNC_STEP_US      1000    // Larger errors step the clock and restart drift estimation
+#define CAN_TIME_SYNC_MAX_DRIFT_PPB 1000000 // Measured drift beyond 1000 ppm is a bad sample
+
+typedef struct {
+    bool synced;
+    uint32_t samples;           // Sync + follow-up pairs used
+    uint32_t missed;            // Syncs without a matching follow-up
+    uint32_t steps;             // Clock stepped (first sample, master change, large error)
+    int32_t error_us;           // Last sample: master time - our estimate before correcting
+    uint32_t error_max_us;      // Largest |error_us| since the last step
+    int32_t drift_ppb;          // Master clock rate relative to ours, minus one
+    int64_t offset_us;          // Master - local clock at the last sample
+} CANTimeSyncStats;
+
+static inline void can_time_follow_up_pack(uint8_t seq, uint64_t master_us, uint8_t* data) {
+    data[0] = seq;
+    for (int i = 0; i < 7; i++) data[1 + i] = (uint8_t)(master_us >> (8 * i));
+}
+
+static inline uint64_t can_time_follow_up_unpack(const uint8_t* data) {
+    uint64_t master_us = 0;
+    for (int i = 0; i < 7; i++) master_us |= (uint64_t)data[1 + i] << (8 * i);
+    return master_us;
+}
+
+// 32-bit micros() -> 64 bits; call at least once per 71 minutes
+class LeafCANClock64 {
+public:
+    LeafCANClock64() : high(0), last(0) {}
+
+    uint64_t extend(uint32_t now_us) {
+        if (now_us < last) high += 1ull << 32;
+        last = now_us;
+        return high | now_us;
+    }
+
+    // An earlier 32-bit stamp, relative to a just-extended now
+    static uint64_t before(uint32_t stamp_us, uint32_t now_us, uint64_t now64) {
+        return now64 - (uint32_t)(now_us - stamp_us);
+    }
+
+private:
+    uint64_t high;
+    uint32_t last;
+};
+
+// Follower side: offset + drift estimate from (local RX time, master TX time) pairs
+class LeafCANTimeSync {
+public:
+    LeafCANTimeSync() { reset(); }
+
+    void reset() {
+        memset(&stats, 0, sizeof(stats));
+        has_sync = false;
+        has_anchor = false;
+        has_drift = false;
+    }
+
+    // Sync frame received at local time rx_us (a lost follow-up leaves the
+    // previous sync pending; the new one replaces it)
+    void onSync(uint8_t seq, uint64_t rx_us) {
+        if (has_sync) stats.missed++;
+        sync_seq = seq;
+        sync_rx_us = rx_us;
+        has_sync = true;
+    }
+
+    // Follow-up for sync seq; true when it produced a sample
+    bool onFollowUp(uint8_t seq, uint64_t master_us, uint32_t now_ms) {
+        if (!has_sync || seq != sync_seq) return false;
+        has_sync = false;
+        addSample(sync_rx_us, master_us, now_ms);
+        return true;
+    }
+
+    void addSample(uint64_t local_us, uint64_t master_us, uint32_t now_ms) {
+        stats.samples++;
+        stats.offset_us = (int64_t)(master_us - local_us);
+        last_sample_ms = now_ms;
+
+        int64_t error = has_anchor ? (int64_t)(master_us - toMaster(local_us)) : INT64_MAX;
+        if (error > CAN_TIME_SYNC_STEP_US || error < -CAN_TIME_SYNC_STEP_US) {
+            // First sample, new master or lost lock: jump, estimate drift afresh
+            stats.steps++;
+            stats.error_us = 0;
+            stats.error_max_us = 0;
+            stats.drift_ppb = 0;
+            has_drift = false;
+            anchor_local_us = local_us;
+            anchor_master_us = master_us;
+            has_anchor = true;
+        } else {
+            stats.error_us = (int32_t)error;
+            uint32_t magnitude = error < 0 ? (uint32_t)-error : (uint32_t)error;
+            if (magnitude > stats.error_max_us) stats.error_max_us = magnitude;
+
+            // Drift from the raw samples, smoothed (1/8); phase corrected by
+            // half the error so RX stamp jitter is damped instead of copied
+            int64_t local_dt = (int64_t)(local_us - prev_local_us);
+            int64_t master_dt = (int64_t)(master_us - prev_master_us);
+            if (local_dt > 0) {
+                int64_t measured = (master_dt - local_dt) * 1000000000 / local_dt;
+                if (measured <= CAN_TIME_SYNC_MAX_DRIFT_PPB && measured >= -CAN_TIME_SYNC_MAX_DRIFT_PPB) {
+                    stats.drift_ppb = has_drift ? (int32_t)(stats.drift_ppb + (measured - stats.drift_ppb) / 8)
+                                                : (int32_t)measured;
+                    has_drift = true;
+                }
+            }
+            anchor_master_us = master_us - error / 2;
+            anchor_local_us = local_us;
+        }
+        prev_local_us = local_us;
+        prev_master_us = master_us;
+        stats.synced = true;
+    }
+
+    bool synced(uint32_t now_ms) const {
+        return stats.synced && now_ms - last_sample_ms < CAN_TIME_SYNC_LOST_MS;
+    }
+
+    // Local time -> master time (local time itself until the first sample)
+    uint64_t toMaster(uint64_t local_us) const {
+        if (!has_anchor) return local_us;
+        int64_t dt = (int64_t)(local_us - anchor_local_us);
+        return anchor_master_us + dt + dt * stats.drift_ppb / 1000000000;
+    }
+
+    void snapshot(CANTimeSyncStats* out, uint32_t now_ms) const {
+        *out = stats;
+        out->synced = synced(now_ms);
+    }
+
+private:
+    CANTimeSyncStats stats;
+
+    bool has_sync;              // Sync received, follow-up pending
+    uint8_t sync_seq;
+    uint64_t sync_rx_us;
+
+    bool has_anchor;
+    bool has_drift;
+    uint64_t anchor_local_us;   // toMaster() reference point
+    uint64_t anchor_master_us;
+    uint64_t prev_local_us;     // Last raw sample, for drift
+    uint64_t prev_master_us;
+    uint32_t last_sample_ms;
+};
+
+#endif // LEAF_CAN_TIME_SYNC_H
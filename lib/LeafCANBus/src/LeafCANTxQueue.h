@@ -0,0 +1,148 @@
+#ifndef LEAF_CAN_TX_QUEUE_H
+#define LEAF_CAN_TX_QUEUE_H
+
+// ============================================================================
+// TX PRIORITY QUEUE (LeafCANBus::send() -> port TX path)
+// ============================================================================
+// Frames wait here until the controller is free, then leave in bus
+// arbitration order: lowest identifier first (a standard ID beats an
+// extended ID with the same 11 leading bits), FIFO among equal IDs. The
+// controller itself is only ever given one frame, so a high-priority frame
+// queued late still overtakes everything that is waiting.
+//
+// A full queue evicts its lowest-priority frame for a higher-priority one.
+// Frames may carry a deadline and are dropped instead of sent once stale.
+// Binary min-heap over a fixed array; no locking (the port holds its TX lock).
+// Header-only and Arduino-free so the host bench can drive it directly.
+
+#include "LeafCANPort.h"
+
+typedef struct {
+    CANFrame frame;
+    uint32_t queued_us;     // micros() at push, for TX latency
+    uint32_t deadline_us;   // Drop after this micros(); see has_deadline
+    bool has_deadline;
+    uint32_t key;           // Arbitration order (see arbitration_key)
+    uint32_t seq;           // FIFO among equal keys
+} CANTxEntry;
+
+class LeafCANTxQueue {
+public:
+    LeafCANTxQueue() { clear(); }
+
+    void clear() {
+        count = 0;
+        next_seq = 0;
+    }
+
+    uint16_t size() const { return count; }
+
+    // Queue a frame. When full, the lowest-priority frame (possibly this one)
+    // is dropped: returns false if that was this frame, sets *evicted if it
+    // was another.
+    bool push(const CANFrame& frame, uint32_t now_us, uint32_t deadline_us, bool has_deadline,
+              bool* evicted) {
+        CANTxEntry e;
+        e.frame = frame;
+        e.queued_us = now_us;
+        e.deadline_us = deadline_us;
+        e.has_deadline = has_deadline;
+        e.key = arbitration_key(frame);
+        e.seq = next_seq++;
+        *evicted = false;
+
+        if (count == CAN_PORT_TX_QUEUE_LEN) {
+            // The lowest priority entry is a leaf
+            uint16_t worst = count / 2;
+            for (uint16_t i = worst + 1; i < count; i++) {
+                if (before(entries[worst], entries[i])) worst = i;
+            }
+            if (!before(e, entries[worst])) return false;
+            remove(worst);
+            *evicted = true;
+        }
+        return push_entry(e);
+    }
+
+    // Re-queue an entry that could not be handed to the controller
+    bool requeue(const CANTxEntry& e) {
+        if (count == CAN_PORT_TX_QUEUE_LEN) return false;
+        return push_entry(e);
+    }
+
+    // Highest-priority entry that is still in time; stale ones are removed
+    // on the way and counted in *expired
+    bool pop(CANTxEntry* out, uint32_t now_us, uint32_t* expired) {
+        while (count > 0) {
+            *out = entries[0];
+            remove(0);
+            if (out->has_deadline && (int32_t)(now_us - out->deadline_us) > 0) {
+                (*expired)++;
+                continue;
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    // Identifier bits in the order the bus arbitrates them:
+    // base ID[10:0], then SRR/IDE (standard wins), then extended ID[17:0]
+    static uint32_t arbitration_key(const CANFrame& f) {
+        if (!f.extended) return (f.id & 0x7FF) << 19;
+        return ((f.id >> 18) & 0x7FF) << 19 | 1u << 18 | (f.id & 0x3FFFF);
+    }
+
+    static bool before(const CANTxEntry& a, const CANTxEntry& b) {
+        if (a.key != b.key) return a.key < b.key;
+        return (int32_t)(a.seq - b.seq) < 0;
+    }
+
+    bool push_entry(const CANTxEntry& e) {
+        uint16_t i = count++;
+        entries[i] = e;
+        sift_up(i);
+        return true;
+    }
+
+    void remove(uint16_t i) {
+        entries[i] = entries[--count];
+        if (i == count) return;
+        sift_up(i);
+        sift_down(i);
+    }
+
+    void sift_up(uint16_t i) {
+        while (i > 0) {
+            uint16_t parent = (i - 1) / 2;
+            if (!before(entries[i], entries[parent])) break;
+            swap(i, parent);
+            i = parent;
+        }
+    }
+
+    void sift_down(uint16_t i) {
+        while (true) {
+            uint16_t left = 2 * i + 1;
+            uint16_t right = left + 1;
+            uint16_t best = i;
+            if (left < count && before(entries[left], entries[best])) best = left;
+            if (right < count && before(entries[right], entries[best])) best = right;
+            if (best == i) return;
+            swap(i, best);
+            i = best;
+        }
+    }
+
+    void swap(uint16_t a, uint16_t b) {
+        CANTxEntry t = entries[a];
+        entries[a] = entries[b];
+        entries[b] = t;
+    }
+
+    CANTxEntry entries[CAN_PORT_TX_QUEUE_LEN];
+    uint16_t count;
+    uint32_t next_seq;
+};
+
+#endif // LEAF_CAN_TX_QUEUE_H
@@ -44,7 +44,9 @@ void setup() {
     // Setup CAN publishers
     canBus.publish(CAN_ID_GPS_POSITION, 1000, pack_gps_position, &gpsPosition);
     canBus.publish(CAN_ID_GPS_VELOCITY, 1000, pack_gps_velocity, &gpsVelocity);
-    canBus.publish(CAN_ID_GPS_TIME, 1000, pack_gps_time, &gpsTime);
+    // Time only changes once a second (and not at all before a fix): checked
+    // every 100 ms, sent when it changes, and every 5 s regardless
+    canBus.publishOnChange(CAN_ID_GPS_TIME, 100, 5000, pack_gps_time, &gpsTime);
 
     Serial.println("[GPS] CAN publishers configured");
     Serial.println("[GPS] Waiting for GPS fix...");
@@ -61,6 +63,7 @@ void updateGPSData() {
     if (gps.location.isValid()) {
         gpsPosition.latitude = gps.location.lat();
         gpsPosition.longitude = gps.location.lng();
+        gpsVelocity.longitude = gpsPosition.longitude;  // 0x711 carries longitude
         gpsPosition.satellites = gps.satellites.value();
         gpsPosition.fix_quality = gps.location.isValid() ? 1 : 0;
 
@@ -115,8 +118,12 @@ void printGPSStatus() {
                       gpsTime.hour, gpsTime.minute, gpsTime.second);
     }
 
-    Serial.printf("CAN Stats - RX: %u, TX: %u, Errors: %u\n",
-                  canBus.getRxCount(), canBus.getTxCount(), canBus.getErrorCount());
+    Serial.printf("CAN Stats - RX: %u, TX: %u, Errors: %u, Suppressed: %u\n",
+                  canBus.getRxCount(), canBus.getTxCount(), canBus.getErrorCount(),
+                  canBus.getSuppressedCount());
+    CANBusHealth health = canBus.getBusHealth();
+    Serial.printf("CAN Bus: %s, bus-off %u, recoveries %u\n", can_bus_state_name(health.state),
+                  health.events[CAN_EVENT_BUS_OFF], health.recoveries);
     Serial.println("------------------");
 }
 
@@ -134,5 +141,6 @@ void loop() {
         lastGPSUpdate = now;
     }
 
-    delay(10);
+    // Sleep until the next publish deadline (at most 10 ms)
+    canBus.waitForNextPublish(10);
 }
@@ -0,0 +1,130 @@
+"""
+ctypes binding for libleafcan.so (lib/LeafCANBus/src/LeafCANRegistry.h)
+
+The shared library holds the one CAN decode table used by the dashboard and
+the ESP32 modules, so the logger decodes frames exactly the way they were
+packed. Search order: $LEAFCAN_LIB, then the usual install/build locations.
+"""
+
+import ctypes
+import os
+from typing import Dict, Iterable, List, Optional, Tuple
+
+ABI_VERSION = 1
+MAX_SIGNALS = 8
+
+_SEARCH_PATHS = [
+    "/usr/local/lib/libleafcan.so",
+    "/usr/lib/libleafcan.so",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "libleafcan.so"),
+    os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                 "../../../ui-dashboard/build/libleafcan.so"),
+]
+
+
+class _Signal(ctypes.Structure):
+    _fields_ = [
+        ("name", ctypes.c_char_p),
+        ("unit", ctypes.c_char_p),
+        ("start_byte", ctypes.c_uint8),
+        ("length", ctypes.c_uint8),
+        ("flags", ctypes.c_uint8),
+        ("shift", ctypes.c_uint8),
+        ("mask", ctypes.c_uint32),
+        ("scale", ctypes.c_double),
+        ("offset", ctypes.c_double),
+    ]
+
+
+class _Message(ctypes.Structure):
+    _fields_ = [
+        ("can_id", ctypes.c_uint32),
+        ("name", ctypes.c_char_p),
+        ("dlc", ctypes.c_uint8),
+        ("min_len", ctypes.c_uint8),
+        ("signal_count", ctypes.c_uint8),
+        ("signals", ctypes.POINTER(_Signal)),
+    ]
+
+
+class LeafCAN:
+    """Registry-driven decoder. Construct via load()."""
+
+    def __init__(self, lib: ctypes.CDLL, path: str):
+        self.path = path
+        self._lib = lib
+
+        lib.leafcan_abi_version.restype = ctypes.c_uint32
+        lib.leafcan_message_count.restype = ctypes.c_size_t
+        lib.leafcan_message_at.argtypes = [ctypes.c_size_t]
+        lib.leafcan_message_at.restype = ctypes.POINTER(_Message)
+        lib.leafcan_decode.argtypes = [ctypes.c_uint32, ctypes.c_char_p, ctypes.c_uint8,
+                                       ctypes.POINTER(ctypes.c_double), ctypes.c_int]
+        lib.leafcan_decode.restype = ctypes.c_int
+        lib.leafcan_decode_batch.argtypes = [ctypes.POINTER(ctypes.c_uint32), ctypes.c_char_p,
+                                             ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t,
+                                             ctypes.POINTER(ctypes.c_double),
+                                             ctypes.POINTER(ctypes.c_int8)]
+        lib.leafcan_decode_batch.restype = ctypes.c_size_t
+
+        if lib.leafcan_abi_version() != ABI_VERSION:
+            raise OSError(f"{path}: ABI {lib.leafcan_abi_version()}, expected {ABI_VERSION}")
+
+        # Cache signal names once; decode() then only crosses the FFI boundary once per frame
+        self.messages: Dict[int, Tuple[str, Tuple[str, ...]]] = {}
+        for i in range(lib.leafcan_message_count()):
+            msg = lib.leafcan_message_at(i).contents
+            names = tuple(msg.signals[j].name.decode() for j in range(msg.signal_count))
+            self.messages[msg.can_id] = (msg.name.decode(), names)
+
+        self._values = (ctypes.c_double * MAX_SIGNALS)()
+
+    def known(self, can_id: int) -> bool:
+        return can_id in self.messages
+
+    def decode(self, can_id: int, data: bytes) -> Optional[Dict[str, float]]:
+        """Decode one frame into {signal_name: value}, None if unknown or too short"""
+        entry = self.messages.get(can_id)
+        if entry is None:
+            return None
+        n = self._lib.leafcan_decode(can_id, bytes(data), len(data), self._values, MAX_SIGNALS)
+        if n < 0:
+            return None
+        return dict(zip(entry[1], self._values[:n]))
+
+    def decode_batch(self, frames: Iterable[Tuple[int, bytes]]) -> List[Optional[Dict[str, float]]]:
+        """Decode many (can_id, data) frames with a single library call"""
+        frames = list(frames)
+        n = len(frames)
+        ids = (ctypes.c_uint32 * n)(*(f[0] for f in frames))
+        lens = (ctypes.c_uint8 * n)(*(min(len(f[1]), 8) for f in frames))
+        data = b"".join(bytes(f[1][:8]).ljust(8, b"\0") for f in frames)
+        values = (ctypes.c_double * (n * MAX_SIGNALS))()
+        counts = (ctypes.c_int8 * n)()
+        self._lib.leafcan_decode_batch(ids, data, lens, n, values, counts)
+
+        results: List[Optional[Dict[str, float]]] = []
+        for i, (can_id, _) in enumerate(frames):
+            count = counts[i]
+            if count < 0:
+                results.append(None)
+                continue
+            base = i * MAX_SIGNALS
+            results.append(dict(zip(self.messages[can_id][1], values[base:base + count])))
+        return results
+
+
+def load(path: Optional[str] = None) -> Optional[LeafCAN]:
+    """Load libleafcan.so, returning None if it is not available"""
+    candidates = [path] if path else []
+    if os.environ.get("LEAFCAN_LIB"):
+        candidates.append(os.environ["LEAFCAN_LIB"])
+    candidates.extend(_SEARCH_PATHS)
+
+    for candidate in candidates:
+        if candidate and os.path.exists(candidate):
+            try:
+                return LeafCAN(ctypes.CDLL(candidate), candidate)
+            except OSError:
+                continue
+    return None
@@ -17,6 +17,9 @@ import can
 from influxdb_client import InfluxDBClient, Point
 from influxdb_client.client.write_api import SYNCHRONOUS
 
+# Shared decode registry (libleafcan.so built from lib/LeafCANBus)
+import leafcan
+
 # Optional: USB GPS support
 try:
     import serial
@@ -75,6 +78,35 @@ CAN_ID_VICTRON_CELLS_1 = 0x371   # Cell module 1 extrema
 CAN_ID_VICTRON_CELLS_2 = 0x372   # Cell module 2 extrema
 CAN_ID_VICTRON_CELLS_3 = 0x373   # Cell module 3 extrema
 
+# IDs decoded through libleafcan.so when it is available:
+# can_id -> (measurement, serial model, source tag, device_type tag)
+# Stateful or derived-field parsers (cell voltages, faults, temps) stay in Python.
+# The Python fallback for each of these IDs must decode the registry's layout
+# (tests/test_registry_fallback.py compares the two).
+REGISTRY_POINTS = {
+    CAN_ID_INVERTER_TELEMETRY: ("Inverter", "LeafEM57", "leaf_ecu", "EM57"),
+    CAN_ID_VEHICLE_SPEED: ("Vehicle", "LeafZE0", "leaf_ecu", "Leaf_ZE0"),
+    CAN_ID_CHARGER_STATUS: ("Battery", "Leaf24kWh", "leaf_ecu", "Leaf_24kWh"),
+    CAN_ID_GPS_POSITION: ("GPS", "ESP32", "esp32_gps", "NEO_6M"),
+    CAN_ID_GPS_VELOCITY: ("GPS", "ESP32", "esp32_gps", "NEO_6M"),
+    CAN_ID_BODY_TEMP_SENSORS: ("Vehicle", "LeafZE0", "esp32_body", "BodySensors"),
+    CAN_ID_BODY_VOLTAGE: ("Vehicle", "LeafZE0", "esp32_body", "BodySensors"),
+    CAN_ID_EMBOO_PACK_STATUS: ("Battery", "EMBOO", "emboo_bms", "Orion_BMS"),
+    CAN_ID_ROAM_TORQUE: ("Motor", "ROAM", "roam_motor", "RM100"),
+    CAN_ID_ROAM_POSITION: ("Motor", "ROAM", "roam_motor", "RM100"),
+    CAN_ID_ROAM_CURRENT: ("Motor", "ROAM", "roam_motor", "RM100"),
+    CAN_ID_ROAM_VOLTAGE: ("Motor", "ROAM", "roam_motor", "RM100"),
+}
+
+# Fields InfluxDB already stores as integers (a type change would reject writes)
+REGISTRY_INT_FIELDS = {
+    "status_flags", "rpm", "charging_flag", "charge_time_remaining_min",
+    "satellites", "fix_quality",
+    "torque_request", "torque_actual", "position_angle", "electrical_freq", "delta_resolver",
+    "voltage_dc_bus", "voltage_output", "voltage_vab_vd", "voltage_vbc_vq",
+    "current_phase_a", "current_phase_b", "current_phase_c", "current_dc_bus",
+}
+
 # Setup logging (systemd will capture stdout to journal)
 logging.basicConfig(
     level=logging.INFO,
@@ -167,6 +199,13 @@ class CANTelemetryLogger:
         self.hostname = socket.gethostname()
         logger.info(f"Vehicle hostname: {self.hostname}")
 
+        # Shared decode registry (falls back to the Python parsers if missing)
+        self.leafcan = leafcan.load()
+        if self.leafcan:
+            logger.info(f"Using CAN decode registry: {self.leafcan.path}")
+        else:
+            logger.info("libleafcan.so not found - using built-in Python parsers")
+
     def _get_serial_number(self, device_family: str, device_type: str) -> str:
         """Generate serial number based on hostname and device type"""
         return f"{self.hostname}-{device_family}-{device_type}"
@@ -232,15 +271,46 @@ class CANTelemetryLogger:
             logger.error(f"CAN bus initialization failed: {e}")
             return False
 
+    def parse_registry(self, can_id: int, data: bytes) -> Optional[Point]:
+        """Build a point from libleafcan.so decoded signals (see REGISTRY_POINTS)"""
+        values = self.leafcan.decode(can_id, data)
+        if values is None:
+            return None
+
+        measurement, model, source, device_type = REGISTRY_POINTS[can_id]
+        point = Point(measurement) \
+            .tag("serial_number", self._get_serial_number(measurement, model)) \
+            .tag("source", source) \
+            .tag("device_type", device_type)
+
+        for name, value in values.items():
+            if name in REGISTRY_INT_FIELDS:
+                point.field(name, int(round(value)))
+            else:
+                point.field(name, float(value))
+
+        # Derived fields the Python parsers have always written
+        if "voltage" in values and "current" in values:
+            point.field("power_kw", float(values["voltage"] * values["current"] / 1000.0))
+        if can_id == CAN_ID_VEHICLE_SPEED:
+            point.field("speed_mph", float(values["speed_kmh"] * 0.621371))
+        if can_id == CAN_ID_CHARGER_STATUS:
+            point.tag("charging", "yes" if values["charging_flag"] else "no")
+            point.field("charge_power_kw",
+                        float(values["charge_voltage"] * values["charge_current"] / 1000.0))
+
+        return point
+
     def parse_inverter_telemetry(self, data: bytes) -> Optional[Point]:
         """Parse inverter telemetry CAN message"""
         if len(data) < 8:
             return None
 
-        voltage = int.from_bytes(data[0:2], 'big') * 0.1  # V
-        current = int.from_bytes(data[2:4], 'big', signed=True) * 0.1  # A
-        temp_inverter = int.from_bytes(data[4:5], 'big', signed=True)  # °C
-        temp_motor = int.from_bytes(data[5:6], 'big', signed=True)  # °C
+        # Same layout as the registry's SIG_INVERTER
+        voltage = int.from_bytes(data[0:2], 'little') * 0.5  # V
+        current = int.from_bytes(data[2:4], 'little', signed=True) * 0.1  # A
+        temp_inverter = data[4] - 40  # °C
+        temp_motor = data[5] - 40  # °C
         status_flags = data[6]
 
         point = Point("Inverter") \
@@ -324,11 +394,12 @@ class CANTelemetryLogger:
 
     def parse_vehicle_speed(self, data: bytes) -> Optional[Point]:
         """Parse vehicle speed CAN message"""
-        if len(data) < 4:
+        if len(data) < 2:
             return None
 
-        speed_kmh = int.from_bytes(data[0:2], 'big') * 0.01
-        speed_mph = int.from_bytes(data[2:4], 'big') * 0.01
+        # Same layout as the registry's SIG_VEHICLE_SPEED (km/h only)
+        speed_kmh = int.from_bytes(data[0:2], 'little') * 0.01
+        speed_mph = speed_kmh * 0.621371
 
         point = Point("Vehicle") \
             .tag("serial_number", self._get_serial_number("Vehicle", "LeafZE0")) \
@@ -364,13 +435,14 @@ class CANTelemetryLogger:
 
     def parse_charger_status(self, data: bytes) -> Optional[Point]:
         """Parse charger status CAN message (Nissan Leaf charger on 0x390)"""
-        if len(data) < 7:
+        if len(data) < 8:
             return None
 
-        charging = data[0]
-        charge_current = int.from_bytes(data[1:3], 'big') * 0.1
-        charge_voltage = int.from_bytes(data[3:5], 'big') * 0.1
-        charge_time = int.from_bytes(data[5:7], 'big')
+        # Same layout as pack_charger_status() / the registry's SIG_CHARGER
+        charging = data[0] & 0x01
+        charge_current = data[1] * 0.5  # A
+        charge_voltage = int.from_bytes(data[2:4], 'little') * 0.1  # V
+        charge_time = int.from_bytes(data[4:6], 'little')  # min
 
         point = Point("Battery") \
             .tag("serial_number", self._get_serial_number("Battery", "Leaf24kWh")) \
@@ -439,39 +511,40 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        # Latitude/longitude stored as int32 * 1e7
-        lat_raw = int.from_bytes(data[0:4], 'big', signed=True)
-        lon_raw = int.from_bytes(data[4:8], 'big', signed=True)
+        # Same layout as the registry's SIG_GPS_POSITION; longitude is in 0x711
+        latitude = int.from_bytes(data[0:4], 'little', signed=True) * 1e-7
+        altitude = int.from_bytes(data[4:6], 'little', signed=True)  # m
+        satellites = data[6]
+        fix_quality = data[7]
 
-        latitude = lat_raw / 1e7
-        longitude = lon_raw / 1e7
-
-        # Additional data might be in subsequent messages
         point = Point("GPS") \
             .tag("serial_number", self._get_serial_number("GPS", "ESP32")) \
             .tag("source", "esp32_gps") \
             .tag("device_type", "NEO_6M") \
             .field("latitude", float(latitude)) \
-            .field("longitude", float(longitude))
+            .field("altitude", float(altitude)) \
+            .field("satellites", int(satellites)) \
+            .field("fix_quality", int(fix_quality))
 
         return point
 
     def parse_gps_velocity(self, data: bytes) -> Optional[Point]:
         """Parse GPS velocity CAN message"""
-        if len(data) < 6:
+        if len(data) < 8:
             return None
 
-        speed_kmh = int.from_bytes(data[0:2], 'big') * 0.01
-        heading = int.from_bytes(data[2:4], 'big') * 0.01
-        pdop = int.from_bytes(data[4:6], 'big') * 0.01
+        # Same layout as the registry's SIG_GPS_VELOCITY
+        longitude = int.from_bytes(data[0:4], 'little', signed=True) * 1e-7
+        speed_kmh = int.from_bytes(data[4:6], 'little') * 0.01
+        heading = int.from_bytes(data[6:8], 'little') * 0.01
 
         point = Point("GPS") \
             .tag("serial_number", self._get_serial_number("GPS", "ESP32")) \
             .tag("source", "esp32_gps") \
             .tag("device_type", "NEO_6M") \
+            .field("longitude", float(longitude)) \
             .field("speed_kmh", float(speed_kmh)) \
-            .field("heading", float(heading)) \
-            .field("pdop", float(pdop))
+            .field("heading", float(heading))
 
         return point
 
@@ -480,10 +553,11 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        temp1 = int.from_bytes(data[0:2], 'big', signed=True) / 10.0
-        temp2 = int.from_bytes(data[2:4], 'big', signed=True) / 10.0
-        temp3 = int.from_bytes(data[4:6], 'big', signed=True) / 10.0
-        temp4 = int.from_bytes(data[6:8], 'big', signed=True) / 10.0
+        # Same layout as the registry's SIG_BODY_TEMP
+        temp1 = int.from_bytes(data[0:2], 'little', signed=True) * 0.1
+        temp2 = int.from_bytes(data[2:4], 'little', signed=True) * 0.1
+        temp3 = int.from_bytes(data[4:6], 'little', signed=True) * 0.1
+        temp4 = int.from_bytes(data[6:8], 'little', signed=True) * 0.1
 
         point = Point("Vehicle") \
             .tag("serial_number", self._get_serial_number("Vehicle", "LeafZE0")) \
@@ -501,9 +575,10 @@ class CANTelemetryLogger:
         if len(data) < 6:
             return None
 
-        voltage_12v = int.from_bytes(data[0:2], 'big') * 0.01
-        voltage_5v = int.from_bytes(data[2:4], 'big') * 0.01
-        current_12v = int.from_bytes(data[4:6], 'big') * 0.01
+        # Same layout as the registry's SIG_BODY_VOLTAGE
+        voltage_12v = int.from_bytes(data[0:2], 'little') * 0.01
+        voltage_5v = int.from_bytes(data[2:4], 'little') * 0.01
+        current_12v = int.from_bytes(data[4:6], 'little') * 0.01
 
         point = Point("Vehicle") \
             .tag("serial_number", self._get_serial_number("Vehicle", "LeafZE0")) \
@@ -524,9 +599,10 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        # Big-endian format
+        # Big-endian format (same layout as the registry's SIG_EMBOO_PACK_STATUS)
         pack_current = int.from_bytes(data[0:2], 'big', signed=True) * 0.1  # A
         pack_voltage = int.from_bytes(data[2:4], 'big') * 0.1  # V
+        pack_amphours = int.from_bytes(data[4:6], 'big') * 0.1  # Ah
         pack_soc = data[6] * 0.5  # %
 
         point = Point("Battery") \
@@ -536,6 +612,7 @@ class CANTelemetryLogger:
             .field("soc_percent", float(pack_soc)) \
             .field("voltage", float(pack_voltage)) \
             .field("current", float(pack_current)) \
+            .field("amphours", float(pack_amphours)) \
             .field("power_kw", float(pack_voltage * pack_current / 1000.0))
 
         return point
@@ -711,10 +788,11 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        # Big-endian pairs
-        motor_angle = (data[0] << 8) | data[1]  # degrees
-        motor_rpm = int.from_bytes([data[2], data[3]], 'big', signed=True)
-        electrical_freq = (data[4] << 8) | data[5]  # Hz
+        # Mixed byte order (same layout as the registry's SIG_ROAM_POSITION)
+        motor_angle = int.from_bytes(data[0:2], 'big')  # degrees
+        motor_rpm = int.from_bytes(data[2:4], 'little', signed=True)
+        electrical_freq = int.from_bytes(data[4:6], 'big')  # Hz
+        delta_resolver = int.from_bytes(data[6:8], 'big', signed=True)  # degrees
 
         point = Point("Motor") \
             .tag("serial_number", self._get_serial_number("Motor", "ROAM")) \
@@ -722,7 +800,8 @@ class CANTelemetryLogger:
             .tag("device_type", "RM100") \
             .field("rpm", int(motor_rpm)) \
             .field("position_angle", int(motor_angle)) \
-            .field("electrical_freq", int(electrical_freq))
+            .field("electrical_freq", int(electrical_freq)) \
+            .field("delta_resolver", int(delta_resolver))
 
         return point
 
@@ -731,16 +810,20 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        # Little-endian pairs, 0.1V resolution
-        dc_bus_voltage = int.from_bytes([data[0], data[1]], 'little')  # 0.1V units
-        output_voltage = int.from_bytes([data[2], data[3]], 'little')  # 0.1V units
+        # Big-endian pairs (same layout as the registry's SIG_ROAM_VOLTAGE)
+        dc_bus_voltage = int.from_bytes(data[0:2], 'big')
+        output_voltage = int.from_bytes(data[2:4], 'big')
+        vab_vd_voltage = int.from_bytes(data[4:6], 'big')
+        vbc_vq_voltage = int.from_bytes(data[6:8], 'big')
 
         point = Point("Motor") \
             .tag("serial_number", self._get_serial_number("Motor", "ROAM")) \
             .tag("source", "roam_motor") \
             .tag("device_type", "RM100") \
             .field("voltage_dc_bus", int(dc_bus_voltage)) \
-            .field("voltage_output", int(output_voltage))
+            .field("voltage_output", int(output_voltage)) \
+            .field("voltage_vab_vd", int(vab_vd_voltage)) \
+            .field("voltage_vbc_vq", int(vbc_vq_voltage))
 
         return point
 
@@ -749,11 +832,11 @@ class CANTelemetryLogger:
         if len(data) < 8:
             return None
 
-        # Little-endian pairs, signed, 1A resolution
-        phase_a = int.from_bytes([data[0], data[1]], 'little', signed=True)
-        phase_b = int.from_bytes([data[2], data[3]], 'little', signed=True)
-        phase_c = int.from_bytes([data[4], data[5]], 'little', signed=True)
-        dc_bus_current = int.from_bytes([data[6], data[7]], 'little', signed=True)
+        # Big-endian pairs, signed, 1A resolution (same layout as the registry's SIG_ROAM_CURRENT)
+        phase_a = int.from_bytes(data[0:2], 'big', signed=True)
+        phase_b = int.from_bytes(data[2:4], 'big', signed=True)
+        phase_c = int.from_bytes(data[4:6], 'big', signed=True)
+        dc_bus_current = int.from_bytes(data[6:8], 'big', signed=True)
 
         point = Point("Motor") \
             .tag("serial_number", self._get_serial_number("Motor", "ROAM")) \
@@ -811,8 +894,10 @@ class CANTelemetryLogger:
         point = None
 
         # Parse based on CAN ID
+        if self.leafcan and msg.arbitration_id in REGISTRY_POINTS and self.leafcan.known(msg.arbitration_id):
+            point = self.parse_registry(msg.arbitration_id, msg.data)
         # Inverter telemetry enabled
-        if msg.arbitration_id == CAN_ID_INVERTER_TELEMETRY:
+        elif msg.arbitration_id == CAN_ID_INVERTER_TELEMETRY:
             point = self.parse_inverter_telemetry(msg.data)
         # Leaf BMS battery data disabled (incorrect parsing - to be fixed later)
         # elif msg.arbitration_id == CAN_ID_BATTERY_SOC:
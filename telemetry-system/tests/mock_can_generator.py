@@ -52,6 +52,8 @@ class MockVehicleState:
         # GPS
         self.latitude = 51.5074  # London
         self.longitude = -0.1278
+        self.altitude = 11  # m
+        self.satellites = 8
         self.gps_speed = 0.0
         self.heading = 0.0
 
@@ -146,18 +148,18 @@ class MockVehicleState:
 
 
 def pack_inverter_telemetry(state: MockVehicleState) -> bytes:
-    """Pack inverter telemetry message"""
-    voltage = int(state.inverter_voltage * 10)
+    """Pack inverter telemetry message (registry SIG_INVERTER layout)"""
+    voltage = int(state.inverter_voltage * 2)
     current = int(state.inverter_current * 10)
-    temp_inv = int(state.inverter_temp)
-    temp_motor = int(state.motor_temp)
+    temp_inv = int(state.inverter_temp) + 40
+    temp_motor = int(state.motor_temp) + 40
     status = 0x01  # Active
 
     data = bytearray(8)
-    data[0:2] = voltage.to_bytes(2, 'big')
-    data[2:4] = current.to_bytes(2, 'big', signed=True)
-    data[4] = temp_inv.to_bytes(1, 'big', signed=True)[0]
-    data[5] = temp_motor.to_bytes(1, 'big', signed=True)[0]
+    data[0:2] = voltage.to_bytes(2, 'little')
+    data[2:4] = current.to_bytes(2, 'little', signed=True)
+    data[4] = temp_inv
+    data[5] = temp_motor
     data[6] = status
     data[7] = 0
 
@@ -197,13 +199,11 @@ def pack_battery_temp(state: MockVehicleState) -> bytes:
 
 
 def pack_vehicle_speed(state: MockVehicleState) -> bytes:
-    """Pack vehicle speed message"""
+    """Pack vehicle speed message (registry SIG_VEHICLE_SPEED layout)"""
     speed_kmh = int(state.speed * 100)
-    speed_mph = int(state.speed * 0.621371 * 100)
 
-    data = bytearray(8)
-    data[0:2] = speed_kmh.to_bytes(2, 'big')
-    data[2:4] = speed_mph.to_bytes(2, 'big')
+    data = bytearray(2)
+    data[0:2] = speed_kmh.to_bytes(2, 'little')
 
     return bytes(data)
 
@@ -228,62 +228,63 @@ def pack_charger_status(state: MockVehicleState) -> bytes:
 
     data = bytearray(8)
     data[0] = charging
-    data[1:3] = int(current * 10).to_bytes(2, 'big')
-    data[3:5] = int(voltage * 10).to_bytes(2, 'big')
-    data[5:7] = time_remaining.to_bytes(2, 'big')
+    data[1] = min(int(current * 2), 0xFF)
+    data[2:4] = int(voltage * 10).to_bytes(2, 'little')
+    data[4:6] = time_remaining.to_bytes(2, 'little')
 
     return bytes(data)
 
 
 def pack_gps_position(state: MockVehicleState) -> bytes:
-    """Pack GPS position message"""
+    """Pack GPS position message (registry SIG_GPS_POSITION layout)"""
     lat = int(state.latitude * 1e7)
-    lon = int(state.longitude * 1e7)
 
     data = bytearray(8)
-    data[0:4] = lat.to_bytes(4, 'big', signed=True)
-    data[4:8] = lon.to_bytes(4, 'big', signed=True)
+    data[0:4] = lat.to_bytes(4, 'little', signed=True)
+    data[4:6] = int(state.altitude).to_bytes(2, 'little', signed=True)
+    data[6] = state.satellites
+    data[7] = 1  # GPS fix
 
     return bytes(data)
 
 
 def pack_gps_velocity(state: MockVehicleState) -> bytes:
-    """Pack GPS velocity message"""
+    """Pack GPS velocity message (registry SIG_GPS_VELOCITY layout)"""
+    lon = int(state.longitude * 1e7)
     speed = int(state.gps_speed * 100)
     heading = int(state.heading * 100)
-    pdop = 150  # 1.5
 
     data = bytearray(8)
-    data[0:2] = speed.to_bytes(2, 'big')
-    data[2:4] = heading.to_bytes(2, 'big')
-    data[4:6] = pdop.to_bytes(2, 'big')
+    data[0:4] = lon.to_bytes(4, 'little', signed=True)
+    data[4:6] = speed.to_bytes(2, 'little')
+    data[6:8] = heading.to_bytes(2, 'little')
 
     return bytes(data)
 
 
 def pack_body_temp(state: MockVehicleState) -> bytes:
-    """Pack body temperature sensors message"""
+    """Pack body temperature sensors message (registry SIG_BODY_TEMP layout)"""
     temp = int(state.ambient_temp * 10)
 
     data = bytearray(8)
-    data[0:2] = temp.to_bytes(2, 'big', signed=True)
-    data[2:4] = temp.to_bytes(2, 'big', signed=True)
-    data[4:6] = temp.to_bytes(2, 'big', signed=True)
-    data[6:8] = temp.to_bytes(2, 'big', signed=True)
+    data[0:2] = temp.to_bytes(2, 'little', signed=True)
+    data[2:4] = temp.to_bytes(2, 'little', signed=True)
+    data[4:6] = temp.to_bytes(2, 'little', signed=True)
+    data[6:8] = temp.to_bytes(2, 'little', signed=True)
 
     return bytes(data)
 
 
 def pack_body_voltage(state: MockVehicleState) -> bytes:
-    """Pack body voltage message"""
+    """Pack body voltage message (registry SIG_BODY_VOLTAGE layout)"""
     v12 = int(state.voltage_12v * 100)
     v5 = 500  # 5.0V
     i12 = 250  # 2.5A
 
-    data = bytearray(8)
-    data[0:2] = v12.to_bytes(2, 'big')
-    data[2:4] = v5.to_bytes(2, 'big')
-    data[4:6] = i12.to_bytes(2, 'big')
+    data = bytearray(6)
+    data[0:2] = v12.to_bytes(2, 'little')
+    data[2:4] = v5.to_bytes(2, 'little')
+    data[4:6] = i12.to_bytes(2, 'little')
 
     return bytes(data)
 
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+Check that the telemetry logger's Python fallback parsers decode every
+REGISTRY_POINTS ID exactly like libleafcan.so does.
+
+Each frame is run through process_can_message() twice, once with the registry
+loaded and once without it, and the written points are compared field by
+field. Needs libleafcan.so (see README, or point $LEAFCAN_LIB at a build);
+python-can and influxdb-client are stubbed if they are not installed.
+
+Usage: python3 test_registry_fallback.py [path/to/libleafcan.so]
+"""
+import os
+import random
+import sys
+import types
+
+LOGGER_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          "../services/telemetry-logger")
+sys.path.insert(0, LOGGER_DIR)
+
+FRAMES_PER_ID = 500
+
+
+class RecordedPoint:
+    """Stands in for influxdb_client.Point and keeps what was written"""
+
+    def __init__(self, measurement):
+        self.measurement = measurement
+        self.tags = {}
+        self.fields = {}
+
+    def tag(self, key, value):
+        self.tags[key] = value
+        return self
+
+    def field(self, key, value):
+        self.fields[key] = value
+        return self
+
+
+class RecordingWriteApi:
+    def __init__(self):
+        self.points = []
+
+    def write(self, bucket, record):
+        self.points.append(record)
+
+
+def stub_missing_modules():
+    """The logger imports python-can and influxdb-client at module level"""
+    try:
+        import can  # noqa: F401
+    except ImportError:
+        can = types.ModuleType("can")
+        can.Bus = object
+        can.Message = object
+        sys.modules["can"] = can
+    try:
+        import influxdb_client  # noqa: F401
+        import influxdb_client.client.write_api  # noqa: F401
+    except ImportError:
+        influx = types.ModuleType("influxdb_client")
+        influx.InfluxDBClient = object
+        influx.Point = RecordedPoint
+        client = types.ModuleType("influxdb_client.client")
+        write_api = types.ModuleType("influxdb_client.client.write_api")
+        write_api.SYNCHRONOUS = None
+        sys.modules["influxdb_client"] = influx
+        sys.modules["influxdb_client.client"] = client
+        sys.modules["influxdb_client.client.write_api"] = write_api
+
+
+class Frame:
+    def __init__(self, can_id, data):
+        self.arbitration_id = can_id
+        self.data = data
+
+
+def make_logger(telemetry_logger, registry):
+    """A logger with only the state process_can_message() touches"""
+    log = telemetry_logger.CANTelemetryLogger.__new__(telemetry_logger.CANTelemetryLogger)
+    log.hostname = "test"
+    log.leafcan = registry
+    log.stats = {}
+    log.can_id_counts = {}
+    log.cell_voltages = {}
+    log.last_cell_write = 0
+    log.active_faults = set()
+    log.fault_counts = {}
+    log.influx_bucket = "test"
+    log.write_api = RecordingWriteApi()
+    return log
+
+
+def decode(log, can_id, data):
+    log.write_api.points.clear()
+    log.process_can_message(Frame(can_id, data))
+    return log.write_api.points[0] if log.write_api.points else None
+
+
+def compare(expected, actual):
+    """Return a description of the first difference, None if the points match"""
+    if (expected is None) != (actual is None):
+        return f"registry point {expected is not None}, fallback point {actual is not None}"
+    if expected is None:
+        return None
+    if expected.measurement != actual.measurement:
+        return f"measurement {expected.measurement!r} != {actual.measurement!r}"
+    if expected.tags != actual.tags:
+        return f"tags {expected.tags} != {actual.tags}"
+    if set(expected.fields) != set(actual.fields):
+        return f"fields {sorted(expected.fields)} != {sorted(actual.fields)}"
+    for name, value in expected.fields.items():
+        other = actual.fields[name]
+        if type(value) is not type(other):
+            return f"{name}: {type(value).__name__} != {type(other).__name__}"
+        if abs(value - other) > 1e-9 * max(1.0, abs(value)):
+            return f"{name}: {value} != {other}"
+    return None
+
+
+def make_frames(rng):
+    """Edge patterns, random payloads, and every truncated length"""
+    frames = [bytes(8), bytes([0xFF] * 8), bytes([0x80, 0x00] * 4), bytes([0x7F, 0xFF] * 4)]
+    frames += [bytes(rng.randrange(256) for _ in range(8)) for _ in range(FRAMES_PER_ID)]
+    frames += [bytes(rng.randrange(256) for _ in range(n)) for n in range(8)]
+    return frames
+
+
+def main():
+    stub_missing_modules()
+    import leafcan
+    import telemetry_logger
+
+    registry = leafcan.load(sys.argv[1] if len(sys.argv) > 1 else None)
+    if registry is None:
+        print("SKIP: libleafcan.so not found (build it or set LEAFCAN_LIB)")
+        return 0
+    print(f"Registry: {registry.path}")
+
+    telemetry_logger.Point = RecordedPoint
+    with_registry = make_logger(telemetry_logger, registry)
+    fallback = make_logger(telemetry_logger, None)
+
+    rng = random.Random(0x1EAF)
+    failures = 0
+    for can_id in sorted(telemetry_logger.REGISTRY_POINTS):
+        if not registry.known(can_id):
+            print(f"  0x{can_id:03X}: not in this registry build, skipped")
+            continue
+
+        frames = make_frames(rng)
+        mismatch = None
+        for data in frames:
+            diff = compare(decode(with_registry, can_id, data), decode(fallback, can_id, data))
+            if diff:
+                mismatch = f"{data.hex()} ({len(data)} bytes): {diff}"
+                break
+
+        if mismatch:
+            failures += 1
+            print(f"  0x{can_id:03X}: FAIL {mismatch}")
+        else:
+            print(f"  0x{can_id:03X}: {len(frames)} frames match")
+
+    print("PASS" if failures == 0 else f"FAIL: {failures} ID(s) decode differently")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,306 @@
+/**
+ * Dashboard render benchmark: the real UI on the headless display (host only)
+ *
+ * Runs ui_init() + DashboardUI on memfb_display and replays a CAN log
+ * (can_log_demo.txt: 30 s of driving) through CANReceiver. Time is
+ * simulated: the LVGL tick advances 5 ms per iteration, like the main loop,
+ * and log frames are fed when their timestamp is reached, so every run
+ * renders the same frames. Each lv_timer_handler() call that redrew is
+ * timed; CPU time is the process's, per simulated second.
+ *
+ * PNG frames of the composed screen can be written at checkpoints
+ * (simulated seconds) to check what was rendered. Gauge draw times are
+ * reported with the static layer cache on (default) or off, to compare,
+ * and LVGL heap use (dash_heap) over the replay.
+ *
+ * Check: the log parses, the UI binds and redraws, the last frame is not
+ * blank, and the LVGL heap never ran out and is consistent. The frame hash
+ * printed at the end only changes when the rendering does.
+ *
+ * Usage:
+ *   dashboard_bench [--log can_log_demo.txt] [--png <dir>] [--png-at 5,15,29] [--no-layer-cache]
+ *   dashboard_bench --check
+ */
+
+#include "memfb_display.h"
+#include "ui.h"
+#include "dashboard_ui.h"
+#include "gauge_layers.h"
+#include "can_receiver.h"
+#include "dash_heap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define SCREEN_W    800
+#define SCREEN_H    480
+#define STEP_MS     5           // Main loop period
+#define SETTLE_MS   1000        // Run past the last log frame so animations finish
+
+struct LogEntry {
+    uint32_t time_ms;
+    uint32_t can_id;
+    uint8_t dlc;
+    uint8_t data[8];
+};
+
+static bool refreshed = false;
+
+static void monitor(lv_disp_drv_t* drv, uint32_t time_ms, uint32_t px) {
+    (void)drv; (void)time_ms; (void)px;
+    refreshed = true;
+}
+
+static double now_s() {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+}
+
+static double cpu_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Same format as the Windows demo playback: "time(s) id(hex) dlc bytes(hex)"
+static bool load_log(const char* path, std::vector<LogEntry>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        double t;
+        unsigned id, dlc, b[8];
+        int n = sscanf(line, "%lf %x %u %x %x %x %x %x %x %x %x",
+                       &t, &id, &dlc, &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]);
+        if (n < 3 || dlc > 8 || n != 3 + (int)dlc) continue;
+        LogEntry e = { (uint32_t)(t * 1000.0 + 0.5), id, (uint8_t)dlc, {} };
+        for (unsigned i = 0; i < dlc; i++) e.data[i] = (uint8_t)b[i];
+        out.push_back(e);
+    }
+    fclose(f);
+    return true;
+}
+
+// ============================================================================
+// PNG (stored deflate blocks: no zlib needed)
+// ============================================================================
+
+static uint32_t crc_table[256];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, size_t n) {
+    if (!crc_table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (n--) crc = crc_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v >> 24); out.push_back(v >> 16); out.push_back(v >> 8); out.push_back(v);
+}
+
+static void put_chunk(FILE* f, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    put_be32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_be32(chunk, crc32_update(0, chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+static bool write_png(const char* path, const lv_color_t* px, uint32_t w, uint32_t h) {
+    // Raw scanlines: filter byte 0 + RGB
+    std::vector<uint8_t> raw;
+    raw.reserve((w * 3 + 1) * h);
+    for (uint32_t y = 0; y < h; y++) {
+        raw.push_back(0);
+        for (uint32_t x = 0; x < w; x++) {
+            lv_color32_t c;
+            c.full = lv_color_to32(px[y * w + x]);
+            raw.push_back(c.ch.red);
+            raw.push_back(c.ch.green);
+            raw.push_back(c.ch.blue);
+        }
+    }
+
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    for (uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    for (size_t pos = 0; pos < raw.size(); ) {
+        size_t len = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + len == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(len & 0xFF); z.push_back(len >> 8);
+        z.push_back(~len & 0xFF); z.push_back((~len >> 8) & 0xFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    put_be32(z, (b << 16) | a);
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), f);
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, w);
+    put_be32(ihdr, h);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });     // 8-bit RGB
+    put_chunk(f, "IHDR", ihdr);
+    put_chunk(f, "IDAT", z);
+    put_chunk(f, "IEND", {});
+    return fclose(f) == 0;
+}
+
+static uint64_t frame_hash(const lv_color_t* px, uint32_t n) {
+    uint64_t h = 1469598103934665603ull;            // FNV-1a over the RGB values
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t c = lv_color_to32(px[i]) & 0xFFFFFF;
+        for (int k = 0; k < 3; k++) h = (h ^ ((c >> (8 * k)) & 0xFF)) * 1099511628211ull;
+    }
+    return h;
+}
+
+int main(int argc, char** argv) {
+    bool check = false;
+    bool layer_cache = true;
+    const char* log_path = DASH_CAN_LOG;
+    const char* png_dir = nullptr;
+    std::vector<uint32_t> png_at = { 5000, 15000, 29000 };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--check") == 0) check = true;
+        else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) log_path = argv[++i];
+        else if (strcmp(argv[i], "--no-layer-cache") == 0) layer_cache = false;
+        else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc) png_dir = argv[++i];
+        else if (strcmp(argv[i], "--png-at") == 0 && i + 1 < argc) {
+            png_at.clear();
+            for (char* s = strtok(argv[++i], ","); s; s = strtok(nullptr, ",")) {
+                png_at.push_back((uint32_t)(atof(s) * 1000.0 + 0.5));
+            }
+        }
+    }
+
+    std::vector<LogEntry> log;
+    if (!load_log(log_path, log) || log.empty()) {
+        fprintf(stderr, "dashboard_bench: cannot read CAN log %s\n", log_path);
+        return 1;
+    }
+    uint32_t end_ms = log.back().time_ms + SETTLE_MS;
+    printf("CAN log: %s (%zu frames, %.1f s)\n", log_path, log.size(), log.back().time_ms / 1000.0);
+
+    lv_init();
+    memfb_display_init(SCREEN_W, SCREEN_H);
+    lv_disp_get_default()->driver->monitor_cb = monitor;
+    ui_init();
+    DashboardUI dashboard;
+    dashboard.init();
+    bool cached = gauge_layers_init(layer_cache);
+    CANReceiver can;                        // Not init(): frames come from the log
+    DashHeapStats heap0;
+    dash_heap_get_stats(&heap0);
+
+    // CANReceiver prints every decoded frame on Linux; keep that out of the
+    // results but not out of the measurement
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+
+    std::vector<double> frame_ms;
+    std::vector<std::string> pngs;
+    size_t next = 0, next_png = 0;
+    double wall0 = now_s(), cpu0 = cpu_s();
+    for (uint32_t t = 0; t <= end_ms; t += STEP_MS) {
+        for (; next < log.size() && log[next].time_ms <= t; next++) {
+            can.processCANMessage(log[next].can_id, log[next].dlc, log[next].data);
+        }
+        lv_tick_inc(STEP_MS);
+        dashboard.update(can);
+
+        refreshed = false;
+        double t0 = now_s();
+        lv_timer_handler();
+        if (refreshed) frame_ms.push_back((now_s() - t0) * 1e3);
+
+        if (png_dir && next_png < png_at.size() && t >= png_at[next_png]) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/dashboard_%05u.png", png_dir, png_at[next_png]);
+            if (write_png(path, memfb_display_pixels(), SCREEN_W, SCREEN_H)) pngs.push_back(path);
+            else pngs.push_back(std::string("FAILED ") + path);
+            next_png++;
+        }
+    }
+    double wall = now_s() - wall0, cpu = cpu_s() - cpu0;
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(devnull);
+    close(saved_stdout);
+
+    const lv_color_t* px = memfb_display_pixels();
+    uint32_t distinct = 0;
+    for (uint32_t i = 1; i < SCREEN_W * SCREEN_H && !distinct; i++) {
+        if (lv_color_to32(px[i]) != lv_color_to32(px[0])) distinct = 1;
+    }
+    const WidgetUpdateStats& ui = dashboard.getUpdateStats();
+    double sim_s = end_ms / 1000.0;
+
+    std::vector<double> sorted = frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+    auto pct = [&](double p) { return sorted.empty() ? 0.0 : sorted[(size_t)(p * (sorted.size() - 1))]; };
+    double total_ms = 0.0;
+    for (double v : frame_ms) total_ms += v;
+
+    printf("replay: %.1f s simulated in %.2f s wall, %zu frames, %u bands, %u widget updates\n",
+           sim_s, wall, frame_ms.size(), memfb_display_flushes(), ui.applied);
+    printf("  frames/s (rendering back to back)  %8.1f\n", frame_ms.empty() ? 0.0 : frame_ms.size() / (total_ms / 1e3));
+    printf("  frame time p50 / p99 / max         %8.3f / %.3f / %.3f ms\n", pct(0.5), pct(0.99), sorted.empty() ? 0.0 : sorted.back());
+    printf("  CPU time per simulated second      %8.1f ms (%.1f%% of one core)\n", cpu * 1e3 / sim_s, cpu * 100.0 / sim_s);
+    printf("  last frame hash                    %016llx\n",
+           (unsigned long long)frame_hash(px, SCREEN_W * SCREEN_H));
+    GaugeDrawStats gauges[GAUGE_LAYER_GAUGES];
+    gauge_layers_get_stats(gauges);
+    printf("  gauge draw avg / max (layer cache %s):\n", cached ? "on" : "off");
+    for (const GaugeDrawStats& g : gauges) {
+        printf("    %-8s %6u draws  %7.1f / %u us\n", g.name, g.draws,
+               g.draws ? (double)g.total_us / g.draws : 0.0, g.max_us);
+    }
+    DashHeapStats heap;
+    dash_heap_get_stats(&heap);
+    printf("  LVGL heap: %u KB live, peak %u of %u KB; %.0f allocs/s, %.0f reallocs/s, %llu failed\n",
+           heap.live_bytes / 1024, heap.peak_bytes / 1024, heap.arena_bytes / 1024,
+           (heap.allocs - heap0.allocs) / sim_s, (heap.reallocs - heap0.reallocs) / sim_s,
+           (unsigned long long)heap.failed);
+    for (const DashHeapPoolStats& p : heap.pools) {
+        printf("    pool %3u B  %3u / %3u slots, peak %3u, %llu to TLSF\n", p.slot_size, p.used, p.slots,
+               p.peak_used, (unsigned long long)p.misses);
+    }
+    printf("    TLSF free %u KB in %u blocks, largest %u KB (%u%% fragmented); by size:",
+           heap.free_bytes / 1024, heap.free_blocks, heap.largest_free / 1024, dash_heap_fragmentation(&heap));
+    for (uint32_t b = 0; b < DASH_HEAP_FREE_BUCKETS; b++) {
+        if (heap.free_hist[b]) printf(" <%u:%u", 32U << b, heap.free_hist[b]);
+    }
+    printf("\n");
+    for (const std::string& p : pngs) printf("  wrote %s\n", p.c_str());
+
+    bool ok = !frame_ms.empty() && ui.applied > 0 && distinct && heap.failed == 0 && dash_heap_check();
+    gauge_layers_cleanup();
+    memfb_display_cleanup();
+    if (check) printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
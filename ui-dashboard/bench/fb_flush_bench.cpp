@@ -0,0 +1,302 @@
+/**
+ * fbdev flush benchmark: per-pixel loop vs. fb_convert row kernels (host only)
+ *
+ * Times a full-screen 800x480 flush from an LVGL 32-bit draw buffer into a
+ * framebuffer in memory, for the framebuffer formats the Pi exposes:
+ * XRGB8888 (vc4/fbtft at 32 bpp), RGB565 (16 bpp panels), XBGR8888 and
+ * 24 bpp (generic path). "per-pixel" is the flush loop fbdev_display.cpp
+ * used before: offset recomputed and bits_per_pixel tested per pixel.
+ *
+ * Check: every kernel must produce the same framebuffer bytes as the
+ * per-pixel reference, also for odd widths (SIMD tails) and padded strides,
+ * from both LVGL color depths (32 and the 16-bit RGB565 build).
+ *
+ * Pipeline: a full frame rendered (opacity blend, as LVGL fills do) and
+ * flushed to an RGB565 panel at LV_COLOR_DEPTH 32 vs. 16, with the bytes
+ * each moves per frame.
+ *
+ * Usage:
+ *   fb_flush_bench           correctness + timings
+ *   fb_flush_bench --check   correctness only (exit 1 on mismatch)
+ */
+
+#include "fb_convert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define SCREEN_W      800
+#define SCREEN_H      480
+#define FLUSH_ROUNDS  200
+
+// lv_color32_t memory layout (LV_COLOR_DEPTH 32)
+typedef struct {
+    uint8_t blue;
+    uint8_t green;
+    uint8_t red;
+    uint8_t alpha;
+} Color32;
+
+struct Format {
+    const char* name;
+    FbPixelFormat format;
+};
+
+static const Format formats[] = {
+    { "xrgb8888", { 32, 16, 8, 8, 8, 0, 8, 24, 8 } },
+    { "rgb565",   { 16, 11, 5, 5, 6, 0, 5, 0, 0 } },
+    { "xbgr8888", { 32, 0, 8, 8, 8, 16, 8, 24, 8 } },
+    { "rgb888",   { 24, 16, 8, 8, 8, 0, 8, 0, 0 } },
+};
+
+static double now_s() {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Reference: one pixel at a time from the fb bitfields (the old flush for
+// 32 and 16 bpp, generalized for the formats it did not handle)
+static void flush_reference(const FbPixelFormat& f, uint8_t* fb, uint32_t line_length,
+                            const Color32* color_p, uint32_t x1, uint32_t y1, uint32_t w, uint32_t h) {
+    for (uint32_t y = y1; y < y1 + h; y++) {
+        for (uint32_t x = x1; x < x1 + w; x++) {
+            long location = x * (f.bits_per_pixel / 8) + y * line_length;
+            Color32 c = *color_p++;
+            uint32_t v = (f.transp_length ? ((1u << f.transp_length) - 1) << f.transp_offset : 0) |
+                         (uint32_t)(c.red >> (8 - f.red_length)) << f.red_offset |
+                         (uint32_t)(c.green >> (8 - f.green_length)) << f.green_offset |
+                         (uint32_t)(c.blue >> (8 - f.blue_length)) << f.blue_offset;
+            for (uint32_t k = 0; k < f.bits_per_pixel / 8; k++) fb[location + k] = (uint8_t)(v >> (8 * k));
+        }
+    }
+}
+
+// The flush loop as it was in fbdev_display.cpp (32 and 16 bpp only)
+static void flush_per_pixel(const FbPixelFormat& f, uint8_t* fbp, uint32_t line_length,
+                            const Color32* color_p, uint32_t x1, uint32_t y1, uint32_t w, uint32_t h) {
+    for (uint32_t y = y1; y < y1 + h; y++) {
+        for (uint32_t x = x1; x < x1 + w; x++) {
+            long location = x * (f.bits_per_pixel / 8) + y * line_length;
+            Color32 c = *color_p;
+            if (f.bits_per_pixel == 32) {
+                *(fbp + location) = c.blue;
+                *(fbp + location + 1) = c.green;
+                *(fbp + location + 2) = c.red;
+                *(fbp + location + 3) = 0xFF;
+            } else if (f.bits_per_pixel == 16) {
+                uint16_t pixel = ((c.red & 0xF8) << 8) | ((c.green & 0xFC) << 3) | (c.blue >> 3);
+                *((uint16_t*)(fbp + location)) = pixel;
+            }
+            color_p++;
+        }
+    }
+}
+
+static void flush_rows(const FbConverter& conv, uint8_t* fb, uint32_t line_length,
+                       const Color32* color_p, uint32_t x1, uint32_t y1, uint32_t w, uint32_t h) {
+    fb_convert_blit(&conv, fb + y1 * line_length + x1 * conv.dst_bytes, line_length,
+                    (const uint8_t*)color_p, w * sizeof(Color32), w, h);
+}
+
+// The old per-pixel reference for a 16-bit (RGB565) draw buffer
+static void flush_reference_565(const FbPixelFormat& f, uint8_t* fb, uint32_t line_length,
+                                const uint16_t* color_p, uint32_t x1, uint32_t y1, uint32_t w, uint32_t h) {
+    std::vector<Color32> px(w * h);
+    for (uint32_t i = 0; i < w * h; i++) {
+        px[i].red = (color_p[i] >> 8) & 0xF8;
+        px[i].green = (color_p[i] >> 3) & 0xFC;
+        px[i].blue = (color_p[i] << 3) & 0xF8;
+        px[i].alpha = 0xFF;
+    }
+    flush_reference(f, fb, line_length, px.data(), x1, y1, w, h);
+}
+
+static void fill_random(std::vector<Color32>& px) {
+    for (Color32& c : px) {
+        c.blue = rand();
+        c.green = rand();
+        c.red = rand();
+        c.alpha = 0xFF;     // LVGL draws opaque pixels on the screen layer
+    }
+}
+
+static const uint32_t widths[] = { 1, 3, 7, 8, 15, 16, 17, 33, 799, 800 };
+
+// Kernel vs. reference for several widths/offsets/strides
+static bool check_format(const Format& fmt) {
+    FbConverter conv;
+    if (!fb_convert_select(&conv, FB_SRC_XRGB8888, &fmt.format)) return false;
+
+    bool ok = true;
+    for (uint32_t w : widths) {
+        for (uint32_t pad : { 0u, 12u }) {
+            uint32_t x1 = SCREEN_W - w;
+            uint32_t h = 5;
+            uint32_t line_length = SCREEN_W * (fmt.format.bits_per_pixel / 8) + pad;
+            std::vector<Color32> px(w * h);
+            fill_random(px);
+
+            std::vector<uint8_t> expect(line_length * (h + 2), 0xA5);
+            std::vector<uint8_t> got(line_length * (h + 2), 0xA5);
+            flush_reference(fmt.format, expect.data(), line_length, px.data(), x1, 1, w, h);
+            flush_rows(conv, got.data(), line_length, px.data(), x1, 1, w, h);
+            if (expect != got) {
+                printf("FAIL: %s (%s) width %u pad %u\n", fmt.name, conv.name, w, pad);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+// Same from an RGB565 draw buffer (LV_COLOR_DEPTH 16)
+static bool check_format_565(const Format& fmt) {
+    FbConverter conv;
+    if (!fb_convert_select(&conv, FB_SRC_RGB565, &fmt.format)) return false;
+
+    bool ok = true;
+    for (uint32_t w : widths) {
+        uint32_t x1 = SCREEN_W - w;
+        uint32_t h = 5;
+        uint32_t line_length = SCREEN_W * (fmt.format.bits_per_pixel / 8) + 12;
+        std::vector<uint16_t> px(w * h);
+        for (uint16_t& p : px) p = rand();
+
+        std::vector<uint8_t> expect(line_length * (h + 2), 0xA5);
+        std::vector<uint8_t> got(line_length * (h + 2), 0xA5);
+        flush_reference_565(fmt.format, expect.data(), line_length, px.data(), x1, 1, w, h);
+        fb_convert_blit(&conv, got.data() + line_length + x1 * conv.dst_bytes, line_length,
+                        (const uint8_t*)px.data(), w * sizeof(uint16_t), w, h);
+        if (expect != got) {
+            printf("FAIL: rgb565 source -> %s (%s) width %u\n", fmt.name, conv.name, w);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// ============================================================================
+// PIPELINE: render + flush at 32 vs. 16 bit
+// ============================================================================
+
+// LVGL-style opacity fill (lv_color_mix): res = (c * opa + bg * (255 - opa)) / 255
+static inline uint8_t mix8(uint8_t c, uint8_t bg, uint8_t opa) {
+    return (uint8_t)(((uint32_t)c * opa + (uint32_t)bg * (255 - opa) + 0x80) * 0x8081 >> 23);
+}
+
+static void render_32(Color32* buf, uint32_t frame) {
+    for (uint32_t y = 0; y < SCREEN_H; y++) {
+        Color32 c = { (uint8_t)(y + frame), (uint8_t)(0x73 + frame), 0xFF, 0xFF };
+        uint8_t opa = (uint8_t)(y * 255 / SCREEN_H);
+        Color32* row = buf + y * SCREEN_W;
+        for (uint32_t x = 0; x < SCREEN_W; x++) {
+            row[x].red = mix8(c.red, row[x].red, opa);
+            row[x].green = mix8(c.green, row[x].green, opa);
+            row[x].blue = mix8(c.blue, row[x].blue, opa);
+            row[x].alpha = 0xFF;
+        }
+    }
+}
+
+// LV_COLOR_DEPTH 16 mixes the 5/6/5 channels in place
+static void render_565(uint16_t* buf, uint32_t frame) {
+    for (uint32_t y = 0; y < SCREEN_H; y++) {
+        uint16_t c = (uint16_t)(0xF800 | (((0x73 + frame) & 0xFC) << 3) | (((y + frame) & 0xF8) >> 3));
+        uint8_t opa = (uint8_t)(y * 255 / SCREEN_H);
+        uint16_t* row = buf + y * SCREEN_W;
+        for (uint32_t x = 0; x < SCREEN_W; x++) {
+            uint16_t bg = row[x];
+            uint32_t r = mix8(c >> 11, bg >> 11, opa);
+            uint32_t g = mix8((c >> 5) & 0x3F, (bg >> 5) & 0x3F, opa);
+            uint32_t b = mix8(c & 0x1F, bg & 0x1F, opa);
+            row[x] = (uint16_t)(r << 11 | g << 5 | b);
+        }
+    }
+}
+
+static void run_pipeline() {
+    const FbPixelFormat rgb565 = formats[1].format;
+    uint32_t line_length = SCREEN_W * 2;
+    std::vector<uint8_t> fb(line_length * SCREEN_H);
+    const double px = (double)SCREEN_W * SCREEN_H;
+
+    printf("\nrender + flush to an RGB565 panel, %dx%d, %d frames:\n", SCREEN_W, SCREEN_H, FLUSH_ROUNDS);
+    for (uint32_t depth : { (uint32_t)FB_SRC_XRGB8888, (uint32_t)FB_SRC_RGB565 }) {
+        FbConverter conv;
+        fb_convert_select(&conv, depth, &rgb565);
+        std::vector<uint8_t> buf(SCREEN_W * SCREEN_H * conv.src_bytes);
+
+        double render = 0.0, flush = 0.0;
+        for (int i = 0; i < FLUSH_ROUNDS; i++) {
+            double t0 = now_s();
+            if (depth == FB_SRC_XRGB8888) render_32((Color32*)buf.data(), i);
+            else render_565((uint16_t*)buf.data(), i);
+            double t1 = now_s();
+            fb_convert_blit(&conv, fb.data(), line_length, buf.data(), SCREEN_W * conv.src_bytes,
+                            SCREEN_W, SCREEN_H);
+            flush += now_s() - t1;
+            render += t1 - t0;
+        }
+        render /= FLUSH_ROUNDS;
+        flush /= FLUSH_ROUNDS;
+
+        // Blend reads + writes the draw buffer, flush reads it and writes the fb
+        double bytes = px * (3 * conv.src_bytes + conv.dst_bytes);
+        printf("  LV_COLOR_DEPTH %-2u render %6.3f ms  flush %6.3f ms (%s)  frame %6.3f ms  "
+               "%5.2f MB/frame  %5.2f GB/s\n",
+               depth, render * 1e3, flush * 1e3, conv.name, (render + flush) * 1e3,
+               bytes / 1e6, bytes / (render + flush) / 1e9);
+    }
+}
+
+int main(int argc, char** argv) {
+    bool check = argc > 1 && strcmp(argv[1], "--check") == 0;
+
+    srand(1);
+    bool ok = true;
+    for (const Format& fmt : formats) ok = check_format(fmt) && ok;
+    for (const Format& fmt : formats) ok = check_format_565(fmt) && ok;
+    printf("fb_convert: %s\n", ok ? "all formats match the per-pixel reference" : "MISMATCH");
+    if (check) {
+        printf("%s\n", ok ? "PASS" : "FAIL");
+        return ok ? 0 : 1;
+    }
+
+    std::vector<Color32> screen(SCREEN_W * SCREEN_H);
+    fill_random(screen);
+    printf("full-screen %dx%d flush, %d rounds:\n", SCREEN_W, SCREEN_H, FLUSH_ROUNDS);
+    for (const Format& fmt : formats) {
+        FbConverter conv;
+        fb_convert_select(&conv, FB_SRC_XRGB8888, &fmt.format);
+        uint32_t line_length = SCREEN_W * (fmt.format.bits_per_pixel / 8);
+        std::vector<uint8_t> fb(line_length * SCREEN_H);
+
+        double before = 0.0;
+        bool has_before = fmt.format.bits_per_pixel != 24;     // Old loop wrote nothing at 24 bpp
+        if (has_before) {
+            double t0 = now_s();
+            for (int i = 0; i < FLUSH_ROUNDS; i++) {
+                flush_per_pixel(fmt.format, fb.data(), line_length, screen.data(), 0, 0, SCREEN_W, SCREEN_H);
+            }
+            before = (now_s() - t0) / FLUSH_ROUNDS;
+        }
+
+        double t0 = now_s();
+        for (int i = 0; i < FLUSH_ROUNDS; i++) {
+            flush_rows(conv, fb.data(), line_length, screen.data(), 0, 0, SCREEN_W, SCREEN_H);
+        }
+        double after = (now_s() - t0) / FLUSH_ROUNDS;
+
+        if (has_before) {
+            printf("  %-9s per-pixel %6.3f ms   %-28s %6.3f ms  (%.1fx)\n",
+                   fmt.name, before * 1e3, conv.name, after * 1e3, before / after);
+        } else {
+            printf("  %-9s per-pixel    n/a     %-28s %6.3f ms\n", fmt.name, conv.name, after * 1e3);
+        }
+    }
+
+    run_pipeline();
+    return ok ? 0 : 1;
+}
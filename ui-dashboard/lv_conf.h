@@ -3,13 +3,18 @@
 
 #include <stdint.h>
 
-/* Color settings */
+/* Color settings (LV_COLOR_DEPTH comes from CMake's DASH_COLOR_DEPTH: 32, or 16 for RGB565) */
+#ifndef LV_COLOR_DEPTH
 #define LV_COLOR_DEPTH 32
+#endif
 #define LV_COLOR_16_SWAP 0
 
-/* Memory settings */
-#define LV_MEM_CUSTOM 0
-#define LV_MEM_SIZE (128U * 1024U)
+/* Memory settings: size-class pools + TLSF with usage telemetry (src/shared/dash_heap.h) */
+#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM_INCLUDE "dash_heap.h"
+#define LV_MEM_CUSTOM_ALLOC dash_heap_alloc
+#define LV_MEM_CUSTOM_FREE dash_heap_free
+#define LV_MEM_CUSTOM_REALLOC dash_heap_realloc
 
 /* Display settings */
 #define LV_HOR_RES_MAX 800
@@ -68,4 +73,7 @@
 #define LV_USE_FLEX 1
 #define LV_USE_GRID 1
 
+/* Others */
+#define LV_USE_SNAPSHOT 1   /* Static layer cache (src/ui/gauge_layers.cpp) */
+
 #endif /* LV_CONF_H */
@@ -1,5 +1,7 @@
 #include <cstdio>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <thread>
 #include <atomic>
 #include <chrono>
@@ -7,18 +9,25 @@
 #include "lvgl.h"
 
 // Platform-specific display drivers
-#ifdef PLATFORM_WINDOWS
+#ifdef PLATFORM_SDL
     #include "platform/windows/sdl_display.h"
 #elif defined(PLATFORM_LINUX)
     #include "platform/linux/fbdev_display.h"
+    #ifdef HAVE_LIBDRM
+        #include "platform/linux/drm_display.h"
+    #endif
 #endif
 
 // UI (SquareLine-generated)
 #include "ui/ui.h"
 #include "ui/dashboard_ui.h"
+#include "ui/gauge_layers.h"
+#include "ui/perf_overlay.h"
 
 // CAN
 #include "shared/can_receiver.h"
+#include "shared/frame_stats.h"
+#include "shared/dash_heap.h"
 
 using namespace std::chrono_literals;
 
@@ -28,38 +37,150 @@ static void handle_sigint(int) {
     g_running = false;
 }
 
-int main() {
+// Pixels LVGL redrew, from the display driver's monitor callback
+static uint64_t g_refreshed_px = 0;
+
+static void count_refreshed_px(lv_disp_drv_t* drv, uint32_t time_ms, uint32_t px) {
+    (void)drv;
+    (void)time_ms;
+    g_refreshed_px += px;
+    frame_stats_refreshed(px);
+}
+
+// Every period: invalidated px/s, how many widget updates reached LVGL, gauge
+// draw times and LVGL heap use
+static void report_ui_stats(const DashboardUI& dashboard, double seconds) {
+    static uint64_t last_px = 0;
+    static WidgetUpdateStats last = {};
+    const WidgetUpdateStats& now = dashboard.getUpdateStats();
+    std::printf("[UI] %.0f px/s invalidated; widget updates/s: %.0f applied, %.0f unchanged, %.0f rate-capped\n",
+                (g_refreshed_px - last_px) / seconds, (now.applied - last.applied) / seconds,
+                (now.unchanged - last.unchanged) / seconds, (now.deferred - last.deferred) / seconds);
+    last_px = g_refreshed_px;
+    last = now;
+
+    static GaugeDrawStats last_gauges[GAUGE_LAYER_GAUGES] = {};
+    GaugeDrawStats gauges[GAUGE_LAYER_GAUGES];
+    gauge_layers_get_stats(gauges);
+    std::printf("[UI] gauge draw (avg/max us):");
+    for (int i = 0; i < GAUGE_LAYER_GAUGES; i++) {
+        uint32_t draws = gauges[i].draws - last_gauges[i].draws;
+        std::printf(" %s %.0f/%u", gauges[i].name,
+                    draws ? (double)(gauges[i].total_us - last_gauges[i].total_us) / draws : 0.0, gauges[i].max_us);
+        last_gauges[i] = gauges[i];
+    }
+    std::printf("\n");
+
+    static uint64_t last_allocs = 0;
+    DashHeapStats heap;
+    dash_heap_get_stats(&heap);
+    uint64_t misses = 0;
+    for (const DashHeapPoolStats& p : heap.pools) misses += p.misses;
+    std::printf("[MEM] LVGL heap %u KB live, peak %u of %u KB; %.0f allocs/s; TLSF free %u KB in %u blocks, "
+                "largest %u KB (%u%% fragmented); %llu pool misses, %llu failed\n",
+                heap.live_bytes / 1024, heap.peak_bytes / 1024, heap.arena_bytes / 1024,
+                (heap.allocs - last_allocs) / seconds, heap.free_bytes / 1024, heap.free_blocks,
+                heap.largest_free / 1024, dash_heap_fragmentation(&heap), (unsigned long long)misses,
+                (unsigned long long)heap.failed);
+    last_allocs = heap.allocs;
+}
+
+#ifdef PLATFORM_LINUX
+// fbdev by default; --drm selects KMS page flips (falls back to fbdev)
+static bool g_drm = false;
+
+static bool linux_display_init(bool want_drm) {
+#ifdef HAVE_LIBDRM
+    if (want_drm) {
+        g_drm = drm_display_init();
+        if (g_drm) return true;
+        std::fprintf(stderr, "[drm] init failed, falling back to fbdev\n");
+    }
+#else
+    if (want_drm) std::fprintf(stderr, "[drm] built without libdrm, using fbdev\n");
+#endif
+    return fbdev_display_init();
+}
+
+static void linux_display_cleanup() {
+#ifdef HAVE_LIBDRM
+    if (g_drm) {
+        drm_display_cleanup();
+        return;
+    }
+#endif
+    fbdev_display_cleanup();
+}
+
+static void linux_display_update() {
+    if (g_drm) {
+        lv_timer_handler();
+    } else {
+        fbdev_display_update();     // Also timestamps the frame for the band stats
+    }
+}
+
+// Idle until the next loop iteration; with DRM, page-flip events end the wait
+static void linux_display_wait() {
+#ifdef HAVE_LIBDRM
+    if (g_drm) {
+        drm_display_wait(5);
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(5ms);
+}
+#endif
+
+int main(int argc, char** argv) {
     std::signal(SIGINT, handle_sigint);
     std::signal(SIGTERM, handle_sigint);
 
     std::printf("=== Nissan Leaf CAN Dashboard ===\n");
-#ifdef PLATFORM_WINDOWS
-    std::printf("Platform: Windows (SDL2)\n");
+#ifdef PLATFORM_SDL
+    std::printf("Platform: SDL2 simulator\n");
 #elif defined(PLATFORM_LINUX)
     std::printf("Platform: Linux (Framebuffer)\n");
 #endif
 
+    // --drm (Linux), --overlay, --stats <file|unix:socket>, --stats-period <s>, --no-layer-cache
+    bool want_drm = false;
+    bool layer_cache = true;
+    bool want_overlay = false;
+    const char* stats_path = nullptr;
+    float stats_period = 5.0f;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--drm") == 0) want_drm = true;
+        else if (std::strcmp(argv[i], "--overlay") == 0) want_overlay = true;
+        else if (std::strcmp(argv[i], "--no-layer-cache") == 0) layer_cache = false;
+        else if (std::strcmp(argv[i], "--stats") == 0 && i + 1 < argc) stats_path = argv[++i];
+        else if (std::strcmp(argv[i], "--stats-period") == 0 && i + 1 < argc) stats_period = (float)std::atof(argv[++i]);
+    }
+#ifndef PLATFORM_LINUX
+    (void)want_drm;
+#endif
+
     // 1) Initialize platform-specific display
-#ifdef PLATFORM_WINDOWS
+#ifdef PLATFORM_SDL
     if (!sdl_display_init()) {
         std::fprintf(stderr, "[SDL] init failed\n");
         return 1;
     }
 #elif defined(PLATFORM_LINUX)
-    if (!fbdev_display_init()) {
+    if (!linux_display_init(want_drm)) {
         std::fprintf(stderr, "[fbdev] init failed; is /dev/fb0 available and permission OK?\n");
         return 1;
     }
 #endif
 
-    // 2) CAN receiver (mock on Windows, SocketCAN on Linux, future: CANable Pro on Windows)
+    // 2) CAN receiver (PCAN or log playback in the simulator, SocketCAN on Linux)
     CANReceiver can;
     if (!can.init()) {
         std::fprintf(stderr, "[CANReceiver] failed to init.\n");
-#ifdef PLATFORM_WINDOWS
+#ifdef PLATFORM_SDL
         sdl_display_cleanup();
 #elif defined(PLATFORM_LINUX)
-        fbdev_display_cleanup();
+        linux_display_cleanup();
 #endif
         return 1;
     }
@@ -70,12 +191,24 @@ int main() {
     DashboardUI dashboard;
     dashboard.init();                       // binds widgets
     std::puts("SquareLine UI initialized");
+    gauge_layers_init(layer_cache);         // Static parts rendered once into an image
+
+    lv_disp_get_default()->driver->monitor_cb = count_refreshed_px;
+
+    // Frame stats cost one branch per hook unless asked for
+    if (want_overlay || stats_path) {
+        frame_stats_enable(stats_period, stats_path);
+        if (want_overlay) perf_overlay_create();
+    }
 
     std::puts("==========================> Entering main loop...");
 
     // 6) Main loop: pump LVGL + pull any fresh CAN state to UI
     auto last_tick = std::chrono::steady_clock::now();
+    auto last_report = last_tick;
     while (g_running.load(std::memory_order_relaxed)) {
+        frame_stats_loop();
+
         // Calculate elapsed time and update LVGL tick
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_tick).count();
@@ -84,29 +217,44 @@ int main() {
             last_tick = now;
         }
 
-        // Process CAN messages (from log file on Windows, SocketCAN on Linux, CANable Pro in future)
+        // Process CAN messages (PCAN or log file in the simulator, SocketCAN on Linux)
         can.update();
 
         // Update gauges from recent CAN values (this is cheap)
         dashboard.update(can);
 
-#ifdef PLATFORM_WINDOWS
-        // Windows: SDL handles events and presents the display
+        if (now - last_report >= 30s) {
+            report_ui_stats(dashboard, std::chrono::duration<double>(now - last_report).count());
+            last_report = now;
+        }
+
+        if (want_overlay) perf_overlay_update();
+
+        frame_stats_refresh_begin();
+#ifdef PLATFORM_SDL
+        // Simulator: SDL handles events, LVGL flushes into the window texture
         sdl_display_update();
 #elif defined(PLATFORM_LINUX)
         // Linux: Let LVGL handle timers/animations/invalidations
-        lv_timer_handler();
+        linux_display_update();
 #endif
+        frame_stats_refresh_end();
 
         // Small sleep to avoid pegging a core
+#ifdef PLATFORM_LINUX
+        linux_display_wait();
+#else
         std::this_thread::sleep_for(5ms);
+#endif
     }
 
     // 3) Shutdown
-#ifdef PLATFORM_WINDOWS
+    frame_stats_shutdown();
+    gauge_layers_cleanup();
+#ifdef PLATFORM_SDL
     sdl_display_cleanup();
 #elif defined(PLATFORM_LINUX)
-    fbdev_display_cleanup();
+    linux_display_cleanup();
 #endif
     return 0;
 }
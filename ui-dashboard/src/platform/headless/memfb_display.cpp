@@ -0,0 +1,55 @@
+#include "memfb_display.h"
+#include <stdio.h>
+#include <string.h>
+
+static lv_disp_drv_t disp_drv;
+static lv_disp_draw_buf_t disp_buf;
+static lv_color_t* buf1 = nullptr;
+static lv_color_t* buf2 = nullptr;
+static lv_color_t* frame = nullptr;
+static uint32_t flushes = 0;
+
+static void memfb_display_flush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
+    uint32_t w = lv_area_get_width(area);
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(frame + y * drv->hor_res + area->x1, color_p, w * sizeof(lv_color_t));
+        color_p += w;
+    }
+    flushes++;
+    lv_disp_flush_ready(drv);
+}
+
+bool memfb_display_init(uint32_t width, uint32_t height) {
+    frame = new lv_color_t[width * height];
+    memset(frame, 0, width * height * sizeof(lv_color_t));
+
+    uint32_t buf_size = width * 100;
+    buf1 = new lv_color_t[buf_size];
+    buf2 = new lv_color_t[buf_size];
+    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buf_size);
+
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.draw_buf = &disp_buf;
+    disp_drv.flush_cb = memfb_display_flush;
+    disp_drv.hor_res = width;
+    disp_drv.ver_res = height;
+    lv_disp_drv_register(&disp_drv);
+
+    printf("[memfb] Display initialized (%ux%u, %d bpp, in memory)\n", width, height, LV_COLOR_DEPTH);
+    return true;
+}
+
+const lv_color_t* memfb_display_pixels() {
+    return frame;
+}
+
+uint32_t memfb_display_flushes() {
+    return flushes;
+}
+
+void memfb_display_cleanup() {
+    delete[] buf1;
+    delete[] buf2;
+    delete[] frame;
+    buf1 = buf2 = frame = nullptr;
+}
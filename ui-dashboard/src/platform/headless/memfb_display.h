@@ -0,0 +1,22 @@
+#ifndef MEMFB_DISPLAY_H
+#define MEMFB_DISPLAY_H
+
+#include "lvgl.h"
+
+// Headless display: LVGL renders 100-line bands, like the fbdev fallback,
+// and each band is copied into a framebuffer in memory. No device, no
+// window: for benchmarks and render checks in CI.
+
+// Initialize the in-memory display (also the LVGL default display)
+bool memfb_display_init(uint32_t width, uint32_t height);
+
+// The composed frame, width * height lv_color_t, row-major
+const lv_color_t* memfb_display_pixels();
+
+// Bands flushed since init
+uint32_t memfb_display_flushes();
+
+// Cleanup in-memory display
+void memfb_display_cleanup();
+
+#endif // MEMFB_DISPLAY_H
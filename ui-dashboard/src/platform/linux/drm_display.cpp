@@ -0,0 +1,557 @@
+#include "drm_display.h"
+#include "frame_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+
+#if LV_COLOR_DEPTH == 32
+  #define DRM_LV_FORMAT DRM_FORMAT_XRGB8888
+#elif LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0
+  #define DRM_LV_FORMAT DRM_FORMAT_RGB565
+#else
+  #error "drm_display needs LV_COLOR_DEPTH 32, or 16 with LV_COLOR_16_SWAP 0"
+#endif
+
+#define DRM_MAX_BUFFERS 3
+#define DRM_MAX_DAMAGE  16      // More rects collapse into their bounding box
+
+// Damage as LVGL areas (inclusive); full = whole screen
+typedef struct {
+    lv_area_t rects[DRM_MAX_DAMAGE];
+    uint32_t count;
+    bool full;
+} DamageList;
+
+enum BufState { BUF_FREE, BUF_QUEUED, BUF_PENDING, BUF_FRONT };
+
+typedef struct {
+    uint32_t handle;
+    uint32_t fb_id;
+    uint32_t pitch;
+    uint64_t size;
+    uint8_t* map;
+    BufState state;
+    DamageList stale;           // Changed in the shadow since this buffer was written
+} DumbBuffer;
+
+// Atomic property IDs
+static struct {
+    uint32_t conn_crtc_id;
+    uint32_t crtc_mode_id, crtc_active;
+    uint32_t plane_fb_id, plane_crtc_id;
+    uint32_t plane_src_x, plane_src_y, plane_src_w, plane_src_h;
+    uint32_t plane_crtc_x, plane_crtc_y, plane_crtc_w, plane_crtc_h;
+    uint32_t plane_damage;      // FB_DAMAGE_CLIPS, 0 if the driver lacks it
+} prop;
+
+static int drmfd = -1;
+static uint32_t conn_id, crtc_id, plane_id;
+static drmModeModeInfo mode;
+static drmModeCrtc* saved_crtc = nullptr;
+static uint32_t mode_blob = 0;
+
+static DumbBuffer buffers[DRM_MAX_BUFFERS];
+static int buffer_count = 0;
+static int front = -1, pending = -1, queued = -1;
+static DamageList commit_damage;        // Since the last commit
+
+static lv_disp_drv_t disp_drv;
+static lv_disp_draw_buf_t disp_buf;
+static lv_color_t* shadow = nullptr;
+
+static DrmFrameStats stats;
+static uint64_t commit_us = 0;
+static uint64_t last_flip_us = 0;
+static drmEventContext evctx;
+
+static uint64_t now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);        // DRM event timestamps are monotonic
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// ============================================================================
+// DAMAGE
+// ============================================================================
+
+static void damage_reset(DamageList* d, bool full) {
+    d->count = 0;
+    d->full = full;
+}
+
+static void damage_add(DamageList* d, const lv_area_t* a) {
+    if (d->full) return;
+    if (d->count == DRM_MAX_DAMAGE) {
+        lv_area_t box = d->rects[0];
+        for (uint32_t i = 1; i < d->count; i++) _lv_area_join(&box, &box, &d->rects[i]);
+        d->rects[0] = box;
+        d->count = 1;
+    }
+    d->rects[d->count++] = *a;
+}
+
+// Copy a buffer's stale areas from the shadow, row by row
+static void damage_copy(DumbBuffer* b) {
+    lv_area_t screen = { 0, 0, (lv_coord_t)(mode.hdisplay - 1), (lv_coord_t)(mode.vdisplay - 1) };
+    uint32_t count = b->stale.full ? 1 : b->stale.count;
+    for (uint32_t i = 0; i < count; i++) {
+        const lv_area_t* a = b->stale.full ? &screen : &b->stale.rects[i];
+        uint32_t w = lv_area_get_width(a) * sizeof(lv_color_t);
+        const lv_color_t* src = shadow + a->y1 * mode.hdisplay + a->x1;
+        uint8_t* dst = b->map + a->y1 * b->pitch + a->x1 * sizeof(lv_color_t);
+        for (lv_coord_t y = a->y1; y <= a->y2; y++) {
+            memcpy(dst, src, w);
+            src += mode.hdisplay;
+            dst += b->pitch;
+        }
+    }
+    damage_reset(&b->stale, false);
+}
+
+// ============================================================================
+// COMMITS / PAGE FLIPS
+// ============================================================================
+
+static bool commit_buffer(int b) {
+    drmModeAtomicReq* req = drmModeAtomicAlloc();
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_fb_id, buffers[b].fb_id);
+
+    // Clips only go in the commit that carries them (the kernel resets them)
+    uint32_t damage_blob = 0;
+    stats.damage_rects = 0;
+    if (prop.plane_damage && !commit_damage.full && commit_damage.count > 0) {
+        struct drm_mode_rect clips[DRM_MAX_DAMAGE];
+        for (uint32_t i = 0; i < commit_damage.count; i++) {
+            const lv_area_t* a = &commit_damage.rects[i];
+            clips[i] = { a->x1, a->y1, a->x2 + 1, a->y2 + 1 };   // Exclusive end
+        }
+        if (drmModeCreatePropertyBlob(drmfd, clips, commit_damage.count * sizeof(clips[0]),
+                                      &damage_blob) == 0) {
+            drmModeAtomicAddProperty(req, plane_id, prop.plane_damage, damage_blob);
+            stats.damage_rects = commit_damage.count;
+        }
+    }
+
+    int ret = drmModeAtomicCommit(drmfd, req, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, nullptr);
+    drmModeAtomicFree(req);
+    if (damage_blob) drmModeDestroyPropertyBlob(drmfd, damage_blob);
+    if (ret != 0) {
+        perror("[drm] Atomic commit failed");
+        buffers[b].state = BUF_FREE;
+        damage_reset(&buffers[b].stale, true);      // Frame lost: rewrite it fully
+        return false;
+    }
+
+    buffers[b].state = BUF_PENDING;
+    pending = b;
+    commit_us = now_us();
+    damage_reset(&commit_damage, false);
+    stats.commits++;
+    return true;
+}
+
+static void page_flip_handler(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec,
+                              unsigned int crtc, void* user_data) {
+    (void)fd; (void)sequence; (void)crtc; (void)user_data;
+    if (pending < 0) return;
+
+    uint64_t flip_us = (uint64_t)tv_sec * 1000000 + tv_usec;
+    float period_ms = 1000.0f / stats.refresh_hz;
+    float latency_ms = (float)(int64_t)(flip_us - commit_us) / 1000.0f;
+    stats.latency_avg_ms = stats.flips ? stats.latency_avg_ms + (latency_ms - stats.latency_avg_ms) / 16
+                                       : latency_ms;
+    if (latency_ms > 1.5f * period_ms) stats.late++;
+
+    // Only back-to-back flips say something about pacing; longer gaps are an idle UI
+    float interval_ms = (float)(flip_us - last_flip_us) / 1000.0f;
+    if (last_flip_us && interval_ms < 4.0f * period_ms) {
+        stats.interval_avg_ms = stats.interval_avg_ms ? stats.interval_avg_ms + (interval_ms - stats.interval_avg_ms) / 16
+                                                      : interval_ms;
+        if (interval_ms > stats.interval_max_ms) stats.interval_max_ms = interval_ms;
+    }
+    last_flip_us = flip_us;
+    stats.flips++;
+
+    if (front >= 0) buffers[front].state = BUF_FREE;
+    front = pending;
+    buffers[front].state = BUF_FRONT;
+    pending = -1;
+
+    if (queued >= 0) {
+        int b = queued;
+        queued = -1;
+        commit_buffer(b);
+    }
+}
+
+// A buffer LVGL's frame can be copied into: free, else the queued one
+// (its frame is dropped), else wait for the pending flip
+static int acquire_buffer() {
+    for (int waited = 0; ; waited = 1) {
+        for (int i = 0; i < buffer_count; i++) {
+            if (buffers[i].state == BUF_FREE) return i;
+        }
+        if (queued >= 0) {
+            int b = queued;
+            queued = -1;
+            stats.dropped++;
+            return b;
+        }
+        if (!waited) stats.waits++;
+        if (pending < 0 || !drm_display_wait(100)) return -1;
+    }
+}
+
+// ============================================================================
+// LVGL
+// ============================================================================
+
+// Direct mode into the shadow: the frame is complete at the last area
+static void drm_display_flush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
+    (void)area; (void)color_p;
+    if (!lv_disp_flush_is_last(drv)) {
+        lv_disp_flush_ready(drv);
+        return;
+    }
+
+    // The invalidated areas of this refresh (still set while flushing)
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) continue;
+        for (int b = 0; b < buffer_count; b++) damage_add(&buffers[b].stale, &disp->inv_areas[i]);
+        damage_add(&commit_damage, &disp->inv_areas[i]);
+    }
+    stats.frames++;
+
+    int b = acquire_buffer();
+    if (b >= 0) {
+        uint64_t t0 = g_frame_stats_enabled ? now_us() : 0;
+        damage_copy(&buffers[b]);
+        frame_stats_band(g_frame_stats_enabled ? (uint32_t)(now_us() - t0) : 0);
+        if (pending < 0) {
+            commit_buffer(b);
+        } else {
+            buffers[b].state = BUF_QUEUED;
+            queued = b;
+        }
+    }
+    frame_stats_flushed();
+
+    lv_disp_flush_ready(drv);
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+static uint32_t find_prop(uint32_t obj_id, uint32_t obj_type, const char* name) {
+    drmModeObjectProperties* props = drmModeObjectGetProperties(drmfd, obj_id, obj_type);
+    if (!props) return 0;
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < props->count_props && !id; i++) {
+        drmModePropertyRes* p = drmModeGetProperty(drmfd, props->props[i]);
+        if (p && strcmp(p->name, name) == 0) id = p->prop_id;
+        drmModeFreeProperty(p);
+    }
+    drmModeFreeObjectProperties(props);
+    return id;
+}
+
+static uint64_t prop_value(uint32_t obj_id, uint32_t obj_type, const char* name) {
+    uint32_t id = find_prop(obj_id, obj_type, name);
+    drmModeObjectProperties* props = drmModeObjectGetProperties(drmfd, obj_id, obj_type);
+    uint64_t value = 0;
+    for (uint32_t i = 0; props && i < props->count_props; i++) {
+        if (props->props[i] == id) value = props->prop_values[i];
+    }
+    drmModeFreeObjectProperties(props);
+    return value;
+}
+
+// First connected connector, its preferred mode and a CRTC that can drive it
+static bool find_output(drmModeRes* res) {
+    for (int i = 0; i < res->count_connectors; i++) {
+        drmModeConnector* conn = drmModeGetConnector(drmfd, res->connectors[i]);
+        if (!conn) continue;
+        if (conn->connection != DRM_MODE_CONNECTED || conn->count_modes == 0) {
+            drmModeFreeConnector(conn);
+            continue;
+        }
+
+        mode = conn->modes[0];
+        for (int m = 0; m < conn->count_modes; m++) {
+            if (conn->modes[m].type & DRM_MODE_TYPE_PREFERRED) {
+                mode = conn->modes[m];
+                break;
+            }
+        }
+
+        crtc_id = 0;
+        for (int e = 0; e < conn->count_encoders && !crtc_id; e++) {
+            drmModeEncoder* enc = drmModeGetEncoder(drmfd, conn->encoders[e]);
+            if (!enc) continue;
+            for (int c = 0; c < res->count_crtcs; c++) {
+                if (enc->possible_crtcs & (1u << c)) {
+                    crtc_id = res->crtcs[c];
+                    break;
+                }
+            }
+            drmModeFreeEncoder(enc);
+        }
+
+        conn_id = conn->connector_id;
+        drmModeFreeConnector(conn);
+        if (crtc_id) return true;
+    }
+    return false;
+}
+
+// The CRTC's primary plane, if it can scan out lv_color_t
+static bool find_plane(drmModeRes* res) {
+    int crtc_index = -1;
+    for (int c = 0; c < res->count_crtcs; c++) {
+        if (res->crtcs[c] == crtc_id) crtc_index = c;
+    }
+
+    drmModePlaneRes* planes = drmModeGetPlaneResources(drmfd);
+    if (!planes) return false;
+    plane_id = 0;
+    for (uint32_t i = 0; i < planes->count_planes && !plane_id; i++) {
+        drmModePlane* plane = drmModeGetPlane(drmfd, planes->planes[i]);
+        if (!plane) continue;
+        bool usable = (plane->possible_crtcs & (1u << crtc_index)) &&
+                      prop_value(plane->plane_id, DRM_MODE_OBJECT_PLANE, "type") == DRM_PLANE_TYPE_PRIMARY;
+        for (uint32_t f = 0; usable && f < plane->count_formats; f++) {
+            if (plane->formats[f] == DRM_LV_FORMAT) {
+                plane_id = plane->plane_id;
+                break;
+            }
+        }
+        drmModeFreePlane(plane);
+    }
+    drmModeFreePlaneResources(planes);
+    return plane_id != 0;
+}
+
+static bool create_buffer(DumbBuffer* b) {
+    struct drm_mode_create_dumb create = {};
+    create.width = mode.hdisplay;
+    create.height = mode.vdisplay;
+    create.bpp = LV_COLOR_DEPTH;
+    if (drmIoctl(drmfd, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0) {
+        perror("[drm] Failed to create dumb buffer");
+        return false;
+    }
+    b->handle = create.handle;
+    b->pitch = create.pitch;
+    b->size = create.size;
+
+    uint32_t handles[4] = { b->handle }, pitches[4] = { b->pitch }, offsets[4] = { 0 };
+    if (drmModeAddFB2(drmfd, mode.hdisplay, mode.vdisplay, DRM_LV_FORMAT, handles, pitches, offsets,
+                      &b->fb_id, 0) != 0) {
+        perror("[drm] Failed to add framebuffer");
+        return false;
+    }
+
+    struct drm_mode_map_dumb map = {};
+    map.handle = b->handle;
+    if (drmIoctl(drmfd, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0) {
+        perror("[drm] Failed to map dumb buffer");
+        return false;
+    }
+    b->map = (uint8_t*)mmap(0, b->size, PROT_READ | PROT_WRITE, MAP_SHARED, drmfd, map.offset);
+    if (b->map == MAP_FAILED) {
+        b->map = nullptr;
+        perror("[drm] Failed to mmap dumb buffer");
+        return false;
+    }
+    memset(b->map, 0, b->size);
+    b->state = BUF_FREE;
+    damage_reset(&b->stale, true);
+    return true;
+}
+
+static void destroy_buffer(DumbBuffer* b) {
+    if (b->map) munmap(b->map, b->size);
+    if (b->fb_id) drmModeRmFB(drmfd, b->fb_id);
+    if (b->handle) {
+        struct drm_mode_destroy_dumb destroy = {};
+        destroy.handle = b->handle;
+        drmIoctl(drmfd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+    }
+    memset(b, 0, sizeof(*b));
+}
+
+// Blocking modeset showing buffer 0
+static bool modeset() {
+    if (drmModeCreatePropertyBlob(drmfd, &mode, sizeof(mode), &mode_blob) != 0) return false;
+
+    drmModeAtomicReq* req = drmModeAtomicAlloc();
+    drmModeAtomicAddProperty(req, conn_id, prop.conn_crtc_id, crtc_id);
+    drmModeAtomicAddProperty(req, crtc_id, prop.crtc_mode_id, mode_blob);
+    drmModeAtomicAddProperty(req, crtc_id, prop.crtc_active, 1);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_fb_id, buffers[0].fb_id);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_crtc_id, crtc_id);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_src_x, 0);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_src_y, 0);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_src_w, (uint64_t)mode.hdisplay << 16);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_src_h, (uint64_t)mode.vdisplay << 16);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_crtc_x, 0);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_crtc_y, 0);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_crtc_w, mode.hdisplay);
+    drmModeAtomicAddProperty(req, plane_id, prop.plane_crtc_h, mode.vdisplay);
+    int ret = drmModeAtomicCommit(drmfd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+    drmModeAtomicFree(req);
+    if (ret != 0) {
+        perror("[drm] Modeset failed");
+        return false;
+    }
+
+    buffers[0].state = BUF_FRONT;
+    front = 0;
+    return true;
+}
+
+// Open a card with atomic modesetting, dumb buffers and a connected output
+static bool open_card(const char* path) {
+    drmfd = open(path, O_RDWR | O_CLOEXEC);
+    if (drmfd < 0) return false;
+
+    uint64_t dumb = 0;
+    drmModeRes* res = nullptr;
+    bool ok = drmSetClientCap(drmfd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0 &&
+              drmSetClientCap(drmfd, DRM_CLIENT_CAP_ATOMIC, 1) == 0 &&
+              drmGetCap(drmfd, DRM_CAP_DUMB_BUFFER, &dumb) == 0 && dumb &&
+              (res = drmModeGetResources(drmfd)) != nullptr &&
+              find_output(res) && find_plane(res);
+    if (res) drmModeFreeResources(res);
+    if (!ok) {
+        close(drmfd);
+        drmfd = -1;
+    }
+    return ok;
+}
+
+bool drm_display_init(const DrmOptions* options) {
+    DrmOptions defaults = DRM_OPTIONS_DEFAULT;
+    if (!options) options = &defaults;
+
+    char path[32];
+    if (options->device) {
+        open_card(options->device);
+    } else {
+        for (int i = 0; i < 8 && drmfd < 0; i++) {
+            snprintf(path, sizeof(path), "/dev/dri/card%d", i);
+            open_card(path);
+        }
+    }
+    if (drmfd < 0) {
+        fprintf(stderr, "[drm] No card with atomic KMS, dumb buffers and a connected output\n");
+        return false;
+    }
+
+    prop.conn_crtc_id = find_prop(conn_id, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID");
+    prop.crtc_mode_id = find_prop(crtc_id, DRM_MODE_OBJECT_CRTC, "MODE_ID");
+    prop.crtc_active = find_prop(crtc_id, DRM_MODE_OBJECT_CRTC, "ACTIVE");
+    prop.plane_fb_id = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "FB_ID");
+    prop.plane_crtc_id = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_ID");
+    prop.plane_src_x = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "SRC_X");
+    prop.plane_src_y = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "SRC_Y");
+    prop.plane_src_w = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "SRC_W");
+    prop.plane_src_h = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "SRC_H");
+    prop.plane_crtc_x = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_X");
+    prop.plane_crtc_y = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_Y");
+    prop.plane_crtc_w = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_W");
+    prop.plane_crtc_h = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_H");
+    prop.plane_damage = find_prop(plane_id, DRM_MODE_OBJECT_PLANE, "FB_DAMAGE_CLIPS");
+
+    saved_crtc = drmModeGetCrtc(drmfd, crtc_id);
+
+    buffer_count = options->buffers == 2 ? 2 : DRM_MAX_BUFFERS;
+    for (int i = 0; i < buffer_count; i++) {
+        if (!create_buffer(&buffers[i])) {
+            drm_display_cleanup();
+            return false;
+        }
+    }
+    if (!modeset()) {
+        drm_display_cleanup();
+        return false;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    stats.refresh_hz = mode.vrefresh ? (float)mode.vrefresh : 60.0f;
+    damage_reset(&commit_damage, true);
+
+    memset(&evctx, 0, sizeof(evctx));
+    evctx.version = 3;
+    evctx.page_flip_handler2 = page_flip_handler;
+
+    // Initialize LVGL
+    lv_init();
+
+    // One full-screen shadow in normal memory (dumb buffers are often
+    // write-combined, too slow for LVGL to blend in)
+    uint32_t screen_px = mode.hdisplay * mode.vdisplay;
+    shadow = new lv_color_t[screen_px];
+    lv_disp_draw_buf_init(&disp_buf, shadow, nullptr, screen_px);
+
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.draw_buf = &disp_buf;
+    disp_drv.flush_cb = drm_display_flush;
+    disp_drv.direct_mode = 1;
+    disp_drv.hor_res = mode.hdisplay;
+    disp_drv.ver_res = mode.vdisplay;
+    lv_disp_drv_register(&disp_drv);
+
+    printf("[drm] Display initialized (%dx%d@%u, %d buffers, damage clips %s)\n",
+           mode.hdisplay, mode.vdisplay, mode.vrefresh, buffer_count, prop.plane_damage ? "on" : "off");
+    return true;
+}
+
+bool drm_display_wait(int timeout_ms) {
+    if (drmfd < 0) return false;
+    struct pollfd pfd = { drmfd, POLLIN, 0 };
+    if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) return false;
+    drmHandleEvent(drmfd, &evctx);
+    return true;
+}
+
+void drm_display_get_stats(DrmFrameStats* out) {
+    *out = stats;
+}
+
+void drm_display_cleanup() {
+    if (drmfd >= 0) {
+        // Let the last flip land before freeing its buffer
+        queued = -1;
+        while (pending >= 0 && drm_display_wait(100)) {}
+
+        if (saved_crtc && saved_crtc->mode_valid) {
+            drmModeSetCrtc(drmfd, saved_crtc->crtc_id, saved_crtc->buffer_id, saved_crtc->x, saved_crtc->y,
+                           &conn_id, 1, &saved_crtc->mode);
+        }
+        if (saved_crtc) drmModeFreeCrtc(saved_crtc);
+        saved_crtc = nullptr;
+        if (stats.flips) {
+            printf("[drm] %u frames, %u flips, %u dropped, %u late, flip interval %.2f ms avg / %.2f max\n",
+                   stats.frames, stats.flips, stats.dropped, stats.late,
+                   stats.interval_avg_ms, stats.interval_max_ms);
+        }
+        for (int i = 0; i < buffer_count; i++) destroy_buffer(&buffers[i]);
+        if (mode_blob) drmModeDestroyPropertyBlob(drmfd, mode_blob);
+        close(drmfd);
+        drmfd = -1;
+    }
+    delete[] shadow;
+    shadow = nullptr;
+    printf("[drm] Display cleaned up\n");
+}
@@ -0,0 +1,52 @@
+#ifndef DRM_DISPLAY_H
+#define DRM_DISPLAY_H
+
+#include "lvgl.h"
+
+// ============================================================================
+// DRM/KMS display (alternative to fbdev, built when libdrm is found)
+// ============================================================================
+// LVGL renders into a full-screen shadow buffer; after each frame only the
+// invalidated areas are copied into a free dumb buffer, which is shown with a
+// non-blocking atomic commit carrying those areas as FB_DAMAGE_CLIPS. The
+// page-flip event arrives on the DRM fd: the main loop waits on it with
+// drm_display_wait() instead of sleeping.
+//
+// With three buffers a frame finished while a flip is pending is queued and
+// committed from the flip event (a newer frame replaces it); with two the
+// render waits for the flip. Works on vkms (modprobe vkms) without a display.
+
+typedef struct {
+    const char* device;     // NULL = first /dev/dri/card* with a connected output
+    int buffers;            // 2 or 3
+} DrmOptions;
+
+#define DRM_OPTIONS_DEFAULT { nullptr, 3 }
+
+// Frame pacing, since init
+typedef struct {
+    uint32_t frames;            // Frames rendered by LVGL
+    uint32_t commits;           // Atomic commits (page flips requested)
+    uint32_t flips;             // Page-flip events received
+    uint32_t dropped;           // Queued frames replaced by a newer one
+    uint32_t waits;             // Frames that waited for a free buffer
+    uint32_t late;              // Commit -> flip took more than 1.5 refresh periods
+    uint32_t damage_rects;      // Clips in the last commit (0 = full frame)
+    float refresh_hz;
+    float interval_avg_ms;      // Between back-to-back flips (EWMA)
+    float interval_max_ms;
+    float latency_avg_ms;       // Commit -> flip event (EWMA)
+} DrmFrameStats;
+
+// Initialize KMS output for LVGL (NULL = DRM_OPTIONS_DEFAULT)
+bool drm_display_init(const DrmOptions* options = nullptr);
+
+// Wait up to timeout_ms for DRM events and dispatch them; true if any came
+bool drm_display_wait(int timeout_ms);
+
+void drm_display_get_stats(DrmFrameStats* out);
+
+// Cleanup: restores the CRTC the console had
+void drm_display_cleanup();
+
+#endif // DRM_DISPLAY_H
@@ -0,0 +1,175 @@
+#include "fb_convert.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+  #define FB_CONVERT_SIMD "sse2"
+#elif defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define FB_CONVERT_SIMD "neon"
+#else
+  #define FB_CONVERT_SIMD "scalar"
+#endif
+
+// ============================================================================
+// ROW KERNELS
+// ============================================================================
+
+static void row_copy(const FbConverter* conv, uint8_t* dst, const uint8_t* src, uint32_t pixels) {
+    memcpy(dst, src, pixels * conv->src_bytes);
+}
+
+// 0xAARRGGBB -> RRRRRGGG GGGBBBBB, truncating
+static inline uint16_t xrgb_to_565(uint32_t p) {
+    return (uint16_t)(((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F));
+}
+
+static void row_xrgb_to_565(const FbConverter*, uint8_t* dst, const uint8_t* src, uint32_t pixels) {
+    const uint32_t* s = (const uint32_t*)src;
+    uint16_t* d = (uint16_t*)dst;
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i mask_r = _mm_set1_epi32(0xF800);
+    const __m128i mask_g = _mm_set1_epi32(0x07E0);
+    const __m128i mask_b = _mm_set1_epi32(0x001F);
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i p0 = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i p1 = _mm_loadu_si128((const __m128i*)(s + i + 4));
+        __m128i v0 = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(p0, 8), mask_r),
+                                               _mm_and_si128(_mm_srli_epi32(p0, 5), mask_g)),
+                                  _mm_and_si128(_mm_srli_epi32(p0, 3), mask_b));
+        __m128i v1 = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(p1, 8), mask_r),
+                                               _mm_and_si128(_mm_srli_epi32(p1, 5), mask_g)),
+                                  _mm_and_si128(_mm_srli_epi32(p1, 3), mask_b));
+        // Sign-extend the 16-bit values so the signed saturating pack keeps them
+        v0 = _mm_srai_epi32(_mm_slli_epi32(v0, 16), 16);
+        v1 = _mm_srai_epi32(_mm_slli_epi32(v1, 16), 16);
+        _mm_storeu_si128((__m128i*)(d + i), _mm_packs_epi32(v0, v1));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t p = vld4q_u8(src + i * 4);    // val[0] = B, [1] = G, [2] = R
+        uint8x16x2_t out;
+        out.val[1] = vorrq_u8(vandq_u8(p.val[2], vdupq_n_u8(0xF8)), vshrq_n_u8(p.val[1], 5));
+        out.val[0] = vorrq_u8(vshlq_n_u8(vandq_u8(p.val[1], vdupq_n_u8(0x1C)), 3), vshrq_n_u8(p.val[0], 3));
+        vst2q_u8(dst + i * 2, out);
+    }
+#endif
+    for (; i < pixels; i++) d[i] = xrgb_to_565(s[i]);
+}
+
+// 0xAARRGGBB -> 0xFFBBGGRR (fb with red at bit 0)
+static inline uint32_t xrgb_to_xbgr(uint32_t p) {
+    return 0xFF000000u | (p & 0x0000FF00u) | ((p >> 16) & 0xFFu) | ((p & 0xFFu) << 16);
+}
+
+static void row_xrgb_to_xbgr(const FbConverter*, uint8_t* dst, const uint8_t* src, uint32_t pixels) {
+    const uint32_t* s = (const uint32_t*)src;
+    uint32_t* d = (uint32_t*)dst;
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+    const __m128i mask_g = _mm_set1_epi32(0x0000FF00);
+    const __m128i mask_lo = _mm_set1_epi32(0x000000FF);
+    const __m128i mask_hi = _mm_set1_epi32(0x00FF0000);
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i v = _mm_or_si128(_mm_or_si128(alpha, _mm_and_si128(p, mask_g)),
+                                 _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), mask_lo),
+                                              _mm_and_si128(_mm_slli_epi32(p, 16), mask_hi)));
+        _mm_storeu_si128((__m128i*)(d + i), v);
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t p = vld4q_u8(src + i * 4);
+        uint8x16x4_t out;
+        out.val[0] = p.val[2];
+        out.val[1] = p.val[1];
+        out.val[2] = p.val[0];
+        out.val[3] = vdupq_n_u8(0xFF);
+        vst4q_u8(dst + i * 4, out);
+    }
+#endif
+    for (; i < pixels; i++) d[i] = xrgb_to_xbgr(s[i]);
+}
+
+// Any 16/24/32 bpp packed-pixel format, one pixel at a time
+static void row_generic(const FbConverter* conv, uint8_t* dst, const uint8_t* src, uint32_t pixels) {
+    const FbPixelFormat& f = conv->format;
+    uint32_t transp = f.transp_length ? ((1u << f.transp_length) - 1) << f.transp_offset : 0;
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint32_t r, g, b;
+        if (conv->src_bits == FB_SRC_RGB565) {
+            uint16_t p = ((const uint16_t*)src)[i];
+            r = (p >> 8) & 0xF8;
+            g = (p >> 3) & 0xFC;
+            b = (p << 3) & 0xF8;
+        } else {
+            uint32_t p = ((const uint32_t*)src)[i];
+            r = (p >> 16) & 0xFF;
+            g = (p >> 8) & 0xFF;
+            b = p & 0xFF;
+        }
+
+        uint32_t v = transp |
+                     (r >> (8 - f.red_length)) << f.red_offset |
+                     (g >> (8 - f.green_length)) << f.green_offset |
+                     (b >> (8 - f.blue_length)) << f.blue_offset;
+        for (uint32_t k = 0; k < conv->dst_bytes; k++) *dst++ = (uint8_t)(v >> (8 * k));
+    }
+}
+
+// ============================================================================
+// SELECTION
+// ============================================================================
+
+static bool is_rgb(const FbPixelFormat* f, uint32_t bpp, uint32_t r_off, uint32_t g_off, uint32_t b_off,
+                   uint32_t r_len, uint32_t g_len, uint32_t b_len) {
+    return f->bits_per_pixel == bpp &&
+           f->red_offset == r_off && f->green_offset == g_off && f->blue_offset == b_off &&
+           f->red_length == r_len && f->green_length == g_len && f->blue_length == b_len;
+}
+
+bool fb_convert_select(FbConverter* conv, uint32_t src_bits, const FbPixelFormat* format) {
+    memset(conv, 0, sizeof(*conv));
+    conv->src_bits = src_bits;
+    conv->src_bytes = src_bits / 8;
+    conv->dst_bytes = format->bits_per_pixel / 8;
+    conv->format = *format;
+
+    uint32_t bpp = format->bits_per_pixel;
+    if (bpp != 16 && bpp != 24 && bpp != 32) return false;
+    if (format->red_length > 8 || format->green_length > 8 || format->blue_length > 8) return false;
+
+    bool fb_xrgb = is_rgb(format, 32, 16, 8, 0, 8, 8, 8);
+    bool fb_xbgr = is_rgb(format, 32, 0, 8, 16, 8, 8, 8);
+    bool fb_565 = is_rgb(format, 16, 11, 5, 0, 5, 6, 5);
+
+    if ((src_bits == FB_SRC_XRGB8888 && fb_xrgb) || (src_bits == FB_SRC_RGB565 && fb_565)) {
+        conv->row = row_copy;
+        conv->name = "memcpy";
+        conv->identity = true;
+    } else if (src_bits == FB_SRC_XRGB8888 && fb_565) {
+        conv->row = row_xrgb_to_565;
+        conv->name = "xrgb8888->rgb565 (" FB_CONVERT_SIMD ")";
+    } else if (src_bits == FB_SRC_XRGB8888 && fb_xbgr) {
+        conv->row = row_xrgb_to_xbgr;
+        conv->name = "xrgb8888->xbgr8888 (" FB_CONVERT_SIMD ")";
+    } else {
+        conv->row = row_generic;
+        conv->name = "generic";
+    }
+    return true;
+}
+
+void fb_convert_blit(const FbConverter* conv, uint8_t* dst, uint32_t dst_stride,
+                     const uint8_t* src, uint32_t src_stride, uint32_t w, uint32_t h) {
+    for (uint32_t y = 0; y < h; y++) {
+        conv->row(conv, dst, src, w);
+        dst += dst_stride;
+        src += src_stride;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef FB_CONVERT_H
+#define FB_CONVERT_H
+
+// ============================================================================
+// LVGL draw buffer -> framebuffer pixel conversion (row kernels)
+// ============================================================================
+// The framebuffer format is resolved once (fb_convert_select) into a row
+// function; flushing is then one call per row with no per-pixel branching:
+//
+//   same layout        memcpy
+//   XRGB8888 -> RGB565 SSE2 / NEON, scalar tail (truncating, like LVGL)
+//   XRGB8888 -> XBGR   red/blue swap (SSE2 / NEON), alpha forced opaque
+//   anything else      generic per-pixel path from the fb bitfields
+//
+// No LVGL dependency, so the bench can build it without the library.
+
+#include <stdint.h>
+
+// Source pixel layout of lv_color_t
+#define FB_SRC_XRGB8888 32      // LV_COLOR_DEPTH 32: bytes B, G, R, A
+#define FB_SRC_RGB565   16      // LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0
+
+// Framebuffer format, from struct fb_var_screeninfo
+typedef struct {
+    uint32_t bits_per_pixel;
+    uint32_t red_offset, red_length;
+    uint32_t green_offset, green_length;
+    uint32_t blue_offset, blue_length;
+    uint32_t transp_offset, transp_length;
+} FbPixelFormat;
+
+struct FbConverter;
+typedef void (*fb_row_fn)(const FbConverter* conv, uint8_t* dst, const uint8_t* src, uint32_t pixels);
+
+struct FbConverter {
+    fb_row_fn row;
+    uint32_t src_bytes;         // Per pixel
+    uint32_t dst_bytes;
+    const char* name;           // For the init log / bench
+    bool identity;              // Same layout: LVGL could render into the fb directly
+    uint32_t src_bits;
+    FbPixelFormat format;       // Generic path only
+};
+
+// Pick the row kernel for LVGL's color depth and the framebuffer format;
+// false if the framebuffer depth is not 16, 24 or 32 bpp
+bool fb_convert_select(FbConverter* conv, uint32_t src_bits, const FbPixelFormat* format);
+
+// Convert a w x h block; strides in bytes
+void fb_convert_blit(const FbConverter* conv, uint8_t* dst, uint32_t dst_stride,
+                     const uint8_t* src, uint32_t src_stride, uint32_t w, uint32_t h);
+
+#endif // FB_CONVERT_H
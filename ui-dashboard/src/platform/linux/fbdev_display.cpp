@@ -1,4 +1,6 @@
 #include "fbdev_display.h"
+#include "fb_convert.h"
+#include "frame_stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,9 +9,20 @@
 #include <sys/mman.h>
 #include <sys/ioctl.h>
 #include <linux/fb.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// fb_convert.h reads lv_color_t as XRGB8888 or plain RGB565
+#if LV_COLOR_DEPTH != 32 && !(LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0)
+#error "fbdev_display needs LV_COLOR_DEPTH 32, or 16 with LV_COLOR_16_SWAP 0"
+#endif
 
 static int fbfd = -1;
 static struct fb_var_screeninfo vinfo;
+static struct fb_var_screeninfo vinfo_saved;   // Restored at cleanup
+static bool vinfo_changed = false;
 static struct fb_fix_screeninfo finfo;
 static uint8_t* fbp = nullptr;
 static long screensize = 0;
@@ -17,41 +30,217 @@ static lv_disp_drv_t disp_drv;
 static lv_disp_draw_buf_t disp_buf;
 static lv_color_t* buf1 = nullptr;
 static lv_color_t* buf2 = nullptr;
+static FbConverter converter;          // Chosen once for LV_COLOR_DEPTH + fb format
+
+// Double-buffered direct mode: LVGL draws into the hidden half, flush pans to it
+static bool direct_mode = false;
+static bool wait_vsync = false;
+static uint32_t flips = 0;
+
+// Flush thread: one band in flight while LVGL renders into the other buffer
+static std::thread flush_worker;
+static std::mutex flush_mutex;
+static std::condition_variable flush_cv;       // Band posted / band done
+static lv_area_t flush_area;
+static lv_color_t* flush_color = nullptr;
+static bool flush_last = false;                // Band ends the frame
+static bool flush_busy = false;
+static bool flush_quit = false;
+
+static FbdevFlushStats stats;
+static uint64_t band_start_us = 0;             // LVGL started drawing the current band
+static uint64_t band_wait_us = 0;              // ... of which spent in wait_cb
+
+static uint64_t now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void average(float* avg, float* max, float sample, uint32_t n) {
+    *avg = n ? *avg + (sample - *avg) / 16 : sample;
+    if (max && sample > *max) *max = sample;
+}
 
-// Flush callback for LVGL
+static void copy_band(const lv_area_t* area, const lv_color_t* color_p) {
+    uint32_t w = lv_area_get_width(area);
+    uint32_t h = lv_area_get_height(area);
+    uint8_t* dst = fbp + (area->y1 + vinfo.yoffset) * finfo.line_length +
+                   (area->x1 + vinfo.xoffset) * converter.dst_bytes;
+    fb_convert_blit(&converter, dst, finfo.line_length, (const uint8_t*)color_p,
+                    w * sizeof(lv_color_t), w, h);
+}
+
+// Band drawn: account its render time (called at the top of the flush)
+static void band_rendered(lv_disp_drv_t* disp_drv) {
+    uint64_t now = now_us();
+    if (band_start_us) {
+        average(&stats.render_avg_us, &stats.render_max_us, (float)(now - band_start_us - band_wait_us), stats.bands);
+        average(&stats.wait_avg_us, nullptr, (float)band_wait_us, stats.bands);
+    }
+    if (lv_disp_flush_is_last(disp_drv)) stats.frames++;
+}
+
+// Flush callback for LVGL: one row kernel call per line of the area
 static void fbdev_display_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
-    if (!fbp) return;
-
-    int32_t x, y;
-    for (y = area->y1; y <= area->y2; y++) {
-        for (x = area->x1; x <= area->x2; x++) {
-            long location = (x + vinfo.xoffset) * (vinfo.bits_per_pixel / 8) +
-                           (y + vinfo.yoffset) * finfo.line_length;
-
-            lv_color_t c = *color_p;
-
-            if (vinfo.bits_per_pixel == 32) {
-                *(fbp + location) = c.ch.blue;
-                *(fbp + location + 1) = c.ch.green;
-                *(fbp + location + 2) = c.ch.red;
-                *(fbp + location + 3) = 0xFF;  // Alpha
-            } else if (vinfo.bits_per_pixel == 16) {
-                // RGB565
-                uint16_t pixel = ((c.ch.red & 0xF8) << 8) |
-                                ((c.ch.green & 0xFC) << 3) |
-                                (c.ch.blue >> 3);
-                *((uint16_t*)(fbp + location)) = pixel;
-            }
-
-            color_p++;
+    if (!fbp) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    band_rendered(disp_drv);
+    uint64_t t0 = now_us();
+    copy_band(area, color_p);
+    uint32_t flush_us = (uint32_t)(now_us() - t0);
+    average(&stats.flush_avg_us, &stats.flush_max_us, (float)flush_us, stats.bands);
+    stats.bands++;
+    frame_stats_band(flush_us);
+    if (lv_disp_flush_is_last(disp_drv)) frame_stats_flushed();
+
+    lv_disp_flush_ready(disp_drv);
+    band_start_us = now_us();
+    band_wait_us = 0;
+}
+
+// Threaded flush: hand the band over and return; LVGL waits in wait_cb
+// before it reuses this buffer
+static void fbdev_display_flush_async(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
+    if (!fbp) {
+        lv_disp_flush_ready(disp_drv);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    band_rendered(disp_drv);
+    flush_area = *area;
+    flush_color = color_p;
+    flush_last = lv_disp_flush_is_last(disp_drv);
+    flush_busy = true;
+    flush_cv.notify_all();
+    band_start_us = now_us();
+    band_wait_us = 0;
+}
+
+static void fbdev_flush_worker() {
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    for (;;) {
+        flush_cv.wait(lock, [] { return flush_busy || flush_quit; });
+        if (flush_quit) break;
+
+        lock.unlock();
+        uint64_t t0 = now_us();
+        copy_band(&flush_area, flush_color);
+        uint64_t t1 = now_us();
+        lock.lock();
+
+        average(&stats.flush_avg_us, &stats.flush_max_us, (float)(t1 - t0), stats.bands);
+        stats.bands++;
+        frame_stats_band((uint32_t)(t1 - t0));
+        if (flush_last) frame_stats_flushed();
+        flush_busy = false;
+        lv_disp_flush_ready(&disp_drv);
+        flush_cv.notify_all();
+    }
+}
+
+// LVGL is waiting for the previous band: sleep instead of spinning
+static void fbdev_display_wait(lv_disp_drv_t* disp_drv) {
+    (void)disp_drv;
+    uint64_t t0 = now_us();
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    flush_cv.wait_for(lock, std::chrono::milliseconds(1), [] { return !flush_busy; });
+    band_wait_us += now_us() - t0;
+}
+
+// Direct mode: the areas are already in place; show the finished frame
+static void fbdev_display_flip(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
+    (void)area;
+    if (lv_disp_flush_is_last(disp_drv)) {
+        // color_p is the start of the buffer LVGL just rendered
+        vinfo.yoffset = (uint8_t*)color_p == fbp ? 0 : vinfo.yres;
+        if (ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) == -1) {
+            perror("[fbdev] FBIOPAN_DISPLAY");
+        }
+
+        // Don't let LVGL draw into the old front buffer while it is still scanned out
+        int crtc = 0;
+        if (wait_vsync && ioctl(fbfd, FBIO_WAITFORVSYNC, &crtc) == -1) {
+            printf("[fbdev] FBIO_WAITFORVSYNC not supported, flipping without it\n");
+            wait_vsync = false;
         }
+        flips++;
     }
+    frame_stats_band(0);                // Nothing to copy in direct mode
+    if (lv_disp_flush_is_last(disp_drv)) frame_stats_flushed();
 
     lv_disp_flush_ready(disp_drv);
 }
 
-bool fbdev_display_init() {
+// RGB565 build: ask the driver for 16 bpp so the flush (or direct mode)
+// needs no conversion; keeps the current mode if it refuses. The 32-bit
+// build leaves the console's depth alone and converts.
+static void negotiate_depth() {
+    if (LV_COLOR_DEPTH != 16 || vinfo.bits_per_pixel == LV_COLOR_DEPTH) return;
+
+    struct fb_var_screeninfo want = vinfo;
+    want.bits_per_pixel = LV_COLOR_DEPTH;
+    if (ioctl(fbfd, FBIOPUT_VSCREENINFO, &want) == 0 &&
+        ioctl(fbfd, FBIOGET_VSCREENINFO, &want) == 0 &&
+        want.bits_per_pixel == LV_COLOR_DEPTH &&
+        ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo) == 0) {
+        printf("[fbdev] Switched framebuffer from %u to %u bpp\n", vinfo.bits_per_pixel, want.bits_per_pixel);
+        vinfo = want;
+        vinfo_changed = true;
+        return;
+    }
+
+    ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo_saved);
+    ioctl(fbfd, FBIOGET_VSCREENINFO, &vinfo);
+    ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo);
+}
+
+// Grow the virtual framebuffer to two screens and check the driver pans;
+// restores the original mode if not
+static bool setup_double_buffer() {
+    if (!converter.identity || finfo.line_length != vinfo.xres * converter.dst_bytes) {
+        printf("[fbdev] Double buffering needs the fb in lv_color_t layout without row padding\n");
+        return false;
+    }
+
+    struct fb_var_screeninfo want = vinfo;
+    want.yres_virtual = vinfo.yres * 2;
+    want.yoffset = 0;
+    if (ioctl(fbfd, FBIOPUT_VSCREENINFO, &want) == -1 ||
+        ioctl(fbfd, FBIOGET_VSCREENINFO, &want) == -1 ||
+        want.yres_virtual < vinfo.yres * 2 ||
+        ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo) == -1 ||
+        finfo.smem_len < finfo.line_length * vinfo.yres * 2) {
+        printf("[fbdev] Cannot get a %ux%u virtual framebuffer, using partial buffers\n",
+               vinfo.xres, vinfo.yres * 2);
+        ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo);
+        ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo);
+        return false;
+    }
+
+    want.yoffset = want.yres;
+    bool pans = ioctl(fbfd, FBIOPAN_DISPLAY, &want) == 0;
+    want.yoffset = 0;
+    pans = pans && ioctl(fbfd, FBIOPAN_DISPLAY, &want) == 0;
+    if (!pans) {
+        printf("[fbdev] Driver cannot pan, using partial buffers\n");
+        ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo);
+        ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo);
+        return false;
+    }
+
+    vinfo = want;
+    vinfo_changed = true;
+    return true;
+}
+
+bool fbdev_display_init(const FbdevOptions* options) {
     const char* fbdev = "/dev/fb0";
+    FbdevOptions defaults = FBDEV_OPTIONS_DEFAULT;
+    if (!options) options = &defaults;
 
     // Open framebuffer device
     fbfd = open(fbdev, O_RDWR);
@@ -73,6 +262,25 @@ bool fbdev_display_init() {
         close(fbfd);
         return false;
     }
+    vinfo_saved = vinfo;
+    negotiate_depth();
+
+    // Resolve the pixel conversion once instead of per pixel
+    FbPixelFormat format = {
+        vinfo.bits_per_pixel,
+        vinfo.red.offset, vinfo.red.length,
+        vinfo.green.offset, vinfo.green.length,
+        vinfo.blue.offset, vinfo.blue.length,
+        vinfo.transp.offset, vinfo.transp.length,
+    };
+    if (!fb_convert_select(&converter, LV_COLOR_DEPTH, &format)) {
+        fprintf(stderr, "[fbdev] Unsupported framebuffer depth: %d bpp\n", vinfo.bits_per_pixel);
+        close(fbfd);
+        return false;
+    }
+
+    direct_mode = options->double_buffer && setup_double_buffer();
+    wait_vsync = direct_mode && options->wait_vsync;
 
     // Calculate screen size
     screensize = vinfo.yres_virtual * finfo.line_length;
@@ -88,38 +296,78 @@ bool fbdev_display_init() {
     // Initialize LVGL
     lv_init();
 
-    // Allocate draw buffers
-    uint32_t buf_size = vinfo.xres * 100;
-    buf1 = new lv_color_t[buf_size];
-    buf2 = new lv_color_t[buf_size];
-
-    // Initialize display buffer
-    lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buf_size);
+    // Initialize display buffer: the two framebuffer halves, or two
+    // partial buffers copied into the framebuffer
+    lv_disp_drv_init(&disp_drv);
+    if (direct_mode) {
+        uint32_t screen_px = vinfo.xres * vinfo.yres;
+        lv_disp_draw_buf_init(&disp_buf, fbp, fbp + finfo.line_length * vinfo.yres, screen_px);
+        disp_drv.direct_mode = 1;
+        disp_drv.flush_cb = fbdev_display_flip;
+    } else {
+        uint32_t buf_size = vinfo.xres * 100;
+        buf1 = new lv_color_t[buf_size];
+        buf2 = new lv_color_t[buf_size];
+        lv_disp_draw_buf_init(&disp_buf, buf1, buf2, buf_size);
+        if (options->flush_thread) {
+            flush_quit = false;
+            flush_worker = std::thread(fbdev_flush_worker);
+            disp_drv.flush_cb = fbdev_display_flush_async;
+            disp_drv.wait_cb = fbdev_display_wait;
+        } else {
+            disp_drv.flush_cb = fbdev_display_flush;
+        }
+    }
 
     // Initialize display driver
-    lv_disp_drv_init(&disp_drv);
     disp_drv.draw_buf = &disp_buf;
-    disp_drv.flush_cb = fbdev_display_flush;
     disp_drv.hor_res = vinfo.xres;
     disp_drv.ver_res = vinfo.yres;
     lv_disp_drv_register(&disp_drv);
 
-    printf("[fbdev] Display initialized (%dx%d, %d bpp)\n",
-           vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
+    printf("[fbdev] Display initialized (%dx%d, %d bpp, %s%s)\n",
+           vinfo.xres, vinfo.yres, vinfo.bits_per_pixel,
+           direct_mode ? (wait_vsync ? "double-buffered, pan + vsync" : "double-buffered, pan")
+                       : converter.name,
+           flush_worker.joinable() ? ", flush thread" : "");
     return true;
 }
 
 void fbdev_display_update() {
+    band_start_us = now_us();       // First band of a frame starts here
+    band_wait_us = 0;
     lv_timer_handler();
 }
 
+void fbdev_display_get_stats(FbdevFlushStats* out) {
+    std::lock_guard<std::mutex> lock(flush_mutex);
+    *out = stats;
+}
+
 void fbdev_display_cleanup() {
+    if (flush_worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            flush_quit = true;
+            flush_cv.notify_all();
+        }
+        flush_worker.join();
+    }
+    if (stats.bands) {
+        printf("[fbdev] %u frames, %u bands: render %.0f us avg / %.0f max, flush %.0f us avg / %.0f max, "
+               "wait %.0f us avg\n",
+               stats.frames, stats.bands, stats.render_avg_us, stats.render_max_us,
+               stats.flush_avg_us, stats.flush_max_us, stats.wait_avg_us);
+    }
     if (buf1) delete[] buf1;
     if (buf2) delete[] buf2;
     if (fbp && fbp != MAP_FAILED) {
         munmap(fbp, screensize);
     }
     if (fbfd >= 0) {
+        // Back to the console's mode (depth, single height)
+        if (vinfo_changed) ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo_saved);
+        if (direct_mode) printf("[fbdev] %u page flips\n", flips);
         close(fbfd);
     }
     printf("[fbdev] Display cleaned up\n");
@@ -3,12 +3,40 @@
 
 #include "lvgl.h"
 
-// Initialize framebuffer display for LVGL
-bool fbdev_display_init();
+typedef struct {
+    // LVGL renders straight into a virtual framebuffer twice the screen
+    // height and flips halves with FBIOPAN_DISPLAY (no copy, no tearing).
+    // Falls back to partial buffers + copy if the driver cannot pan or the
+    // framebuffer format differs from lv_color_t.
+    bool double_buffer;
+    bool wait_vsync;        // FBIO_WAITFORVSYNC after each flip
+
+    // Partial buffers: convert/copy each band on a separate thread so LVGL
+    // renders the next band into the other buffer meanwhile
+    bool flush_thread;
+} FbdevOptions;
+
+#define FBDEV_OPTIONS_DEFAULT { true, true, true }
+
+// Per-band timings of the partial-buffer path, since init
+typedef struct {
+    uint32_t frames;
+    uint32_t bands;             // Areas flushed
+    float render_avg_us;        // LVGL drawing one band (EWMA; first band includes layout)
+    float render_max_us;
+    float flush_avg_us;         // Converting/copying one band into the framebuffer
+    float flush_max_us;
+    float wait_avg_us;          // LVGL blocked on the previous band's copy
+} FbdevFlushStats;
+
+// Initialize framebuffer display for LVGL (NULL = FBDEV_OPTIONS_DEFAULT)
+bool fbdev_display_init(const FbdevOptions* options = nullptr);
 
 // Update framebuffer display
 void fbdev_display_update();
 
+void fbdev_display_get_stats(FbdevFlushStats* out);
+
 // Cleanup framebuffer display
 void fbdev_display_cleanup();
 
@@ -1,31 +1,50 @@
 #include "sdl_display.h"
+#include "frame_stats.h"
 #include <SDL.h>
+#include <cstdlib>
 #include <iostream>
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 480
 
+// The texture takes lv_color_t as it is: flushes are uploaded without conversion
+#if LV_COLOR_DEPTH == 32
+  #define SDL_LV_FORMAT SDL_PIXELFORMAT_ARGB8888
+#elif LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0
+  #define SDL_LV_FORMAT SDL_PIXELFORMAT_RGB565
+#else
+  #error "sdl_display needs LV_COLOR_DEPTH 32, or 16 with LV_COLOR_16_SWAP 0"
+#endif
+
 static SDL_Window* window = nullptr;
 static SDL_Renderer* renderer = nullptr;
+static SDL_Texture* texture = nullptr;     // Whole screen; LVGL only redraws what changed
 static lv_disp_drv_t disp_drv;
 static lv_disp_draw_buf_t disp_buf;
 static lv_color_t* buf1 = nullptr;
 static lv_color_t* buf2 = nullptr;
 
-// Flush callback for LVGL
-static void sdl_display_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
-    if (!renderer) return;
+static void present() {
+    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    SDL_RenderPresent(renderer);
+}
 
-    int32_t x, y;
-    for (y = area->y1; y <= area->y2; y++) {
-        for (x = area->x1; x <= area->x2; x++) {
-            lv_color_t c = *color_p;
-            SDL_SetRenderDrawColor(renderer, c.ch.red, c.ch.green, c.ch.blue, 0xFF);
-            SDL_RenderDrawPoint(renderer, x, y);
-            color_p++;
-        }
+// Flush callback for LVGL: one texture upload per area, present after the last one
+static void sdl_display_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
+    if (!texture) {
+        lv_disp_flush_ready(disp_drv);
+        return;
     }
+    Uint64 t0 = g_frame_stats_enabled ? SDL_GetPerformanceCounter() : 0;
 
+    SDL_Rect rect = { area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area) };
+    SDL_UpdateTexture(texture, &rect, color_p, rect.w * (int)sizeof(lv_color_t));
+    if (lv_disp_flush_is_last(disp_drv)) present();
+
+    if (g_frame_stats_enabled) {
+        frame_stats_band((uint32_t)((SDL_GetPerformanceCounter() - t0) * 1000000 / SDL_GetPerformanceFrequency()));
+        if (lv_disp_flush_is_last(disp_drv)) frame_stats_flushed();
+    }
     lv_disp_flush_ready(disp_drv);
 }
 
@@ -61,6 +80,17 @@ bool sdl_display_init() {
         return false;
     }
 
+    // Create the screen texture (opaque: alpha of lv_color_t is ignored)
+    texture = SDL_CreateTexture(renderer, SDL_LV_FORMAT, SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (!texture) {
+        std::cerr << "[SDL] Failed to create texture: " << SDL_GetError() << std::endl;
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+
     // Initialize LVGL
     lv_init();
 
@@ -79,7 +109,8 @@ bool sdl_display_init() {
     disp_drv.ver_res = WINDOW_HEIGHT;
     lv_disp_drv_register(&disp_drv);
 
-    std::cout << "[SDL] Display initialized (" << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << ")" << std::endl;
+    std::cout << "[SDL] Display initialized (" << WINDOW_WIDTH << "x" << WINDOW_HEIGHT
+              << ", " << SDL_GetPixelFormatName(SDL_LV_FORMAT) << " streaming texture)" << std::endl;
     return true;
 }
 
@@ -92,21 +123,20 @@ void sdl_display_update() {
         if (event.type == SDL_QUIT) {
             exit(0);
         }
+        // The texture still holds the whole frame: show it again, nothing to redraw
+        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+            present();
+        }
     }
 
-    // Force full screen refresh
-    lv_obj_invalidate(lv_scr_act());
-
-    // LVGL timer handler (renders to buffer and calls flush callback)
+    // LVGL timer handler (renders invalidated areas and calls flush callback)
     lv_timer_handler();
-
-    // Present the rendered frame
-    SDL_RenderPresent(renderer);
 }
 
 void sdl_display_cleanup() {
     if (buf1) delete[] buf1;
     if (buf2) delete[] buf2;
+    if (texture) SDL_DestroyTexture(texture);
     if (renderer) SDL_DestroyRenderer(renderer);
     if (window) SDL_DestroyWindow(window);
     SDL_Quit();
@@ -2,7 +2,7 @@
 #include <cstdint>
 #include <atomic>
 
-#ifdef PLATFORM_WINDOWS
+#ifdef PLATFORM_SDL
   #include "windows/mock_can.h"
 #elif defined(PLATFORM_LINUX)
   // Provides CANMessage + SocketCANData
@@ -46,19 +46,19 @@ public:
     uint16_t getMaxCellVoltage() const { return max_cell_voltage_.load(std::memory_order_relaxed); } // mV
     uint16_t getMinCellVoltage() const { return min_cell_voltage_.load(std::memory_order_relaxed); } // mV
 
-    // Vehicle data (0x1F2)
+    // Vehicle data (speed 0x1D4, gear from 0x1DA direction; ready/accel have no frame yet)
     uint16_t getSpeed() const { return speed_.load(std::memory_order_relaxed); }        // kph * 100
     uint8_t getGear() const { return gear_.load(std::memory_order_relaxed); }           // 0=P,1=R,2=N,3=D,4=B
     bool getReady() const { return ready_.load(std::memory_order_relaxed); }
     uint8_t getAccelPedal() const { return accel_pedal_.load(std::memory_order_relaxed); } // % * 2
 
-    // Motor/Inverter (0x1D4)
+    // Motor/Inverter (rpm 0x1DA/0x0A5, torque 0x0AC, temps 0x1F2)
     int16_t getMotorRPM() const { return motor_rpm_.load(std::memory_order_relaxed); }
     int16_t getMotorTorque() const { return motor_torque_.load(std::memory_order_relaxed); } // Nm * 10
     uint8_t getInverterTemp() const { return inverter_temp_.load(std::memory_order_relaxed); } // °C
     uint8_t getMotorTemp() const { return motor_temp_.load(std::memory_order_relaxed); }     // °C
 
-    // GPS (0x710, 0x711)
+    // GPS (lat/sats/fix 0x710, lon/speed/heading 0x711)
     int32_t getLatitude() const { return gps_lat_.load(std::memory_order_relaxed); }    // deg * 1e7
     int32_t getLongitude() const { return gps_lon_.load(std::memory_order_relaxed); }   // deg * 1e7
     uint16_t getGPSSpeed() const { return gps_speed_.load(std::memory_order_relaxed); } // m/s * 100
@@ -66,11 +66,12 @@ public:
     uint8_t getGPSFixType() const { return gps_fix_type_.load(std::memory_order_relaxed); }
     uint8_t getGPSSats() const { return gps_sats_.load(std::memory_order_relaxed); }
 
-    // Process a raw CAN message (for both Linux SocketCAN and Windows mock data)
+    // Process a raw CAN message (for both Linux SocketCAN and the simulator's mock data).
+    // Decoding goes through leafcan_decode(); unregistered IDs are ignored.
     void processCANMessage(uint32_t can_id, uint8_t len, const uint8_t* data);
 
 private:
-    void* platform_data = nullptr;     // MultiCan* on Linux, MockCANData* on Windows
+    void* platform_data = nullptr;     // MultiCan* on Linux, MockCANData* in the simulator
 
     // BMS Battery Limits (0x351) - Victron protocol
     std::atomic<int16_t> charge_voltage_setpoint_{0};    // V * 10
@@ -101,13 +102,13 @@ private:
     std::atomic<uint16_t> max_cell_voltage_{0};     // mV
     std::atomic<uint16_t> min_cell_voltage_{0};     // mV
 
-    // Vehicle (0x1F2)
+    // Vehicle (0x1D4, 0x1DA)
     std::atomic<uint16_t> speed_{0};          // kph * 100
     std::atomic<uint8_t> gear_{0};
     std::atomic<bool> ready_{false};
     std::atomic<uint8_t> accel_pedal_{0};     // % * 2
 
-    // Motor/Inverter (0x1D4)
+    // Motor/Inverter (0x1DA/0x0A5, 0x0AC, 0x1F2)
     std::atomic<int16_t> motor_rpm_{0};
     std::atomic<int16_t> motor_torque_{0};    // Nm * 10
     std::atomic<uint8_t> inverter_temp_{0};
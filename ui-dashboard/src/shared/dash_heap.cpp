@@ -0,0 +1,471 @@
+#include "dash_heap.h"
+#include <cstdio>
+#include <cstring>
+
+#define TLSF_BYTES (128U * 1024U)
+
+// Slots per class: sized for the main screen's objects, text and style arrays
+// (32 KB in all); a full class overflows into TLSF and counts a miss
+static constexpr uint32_t pool_slot_size[DASH_HEAP_POOL_CLASSES] = { 16, 32, 64, 128 };
+static constexpr uint32_t pool_slot_count[DASH_HEAP_POOL_CLASSES] = { 256, 256, 192, 64 };
+
+static constexpr uint32_t pool_bytes() {
+    uint32_t n = 0;
+    for (int c = 0; c < DASH_HEAP_POOL_CLASSES; c++) n += pool_slot_size[c] * pool_slot_count[c];
+    return n;
+}
+static constexpr uint32_t POOL_BYTES = pool_bytes();
+
+alignas(16) static uint8_t pool_area[POOL_BYTES];
+alignas(16) static uint8_t tlsf_area[TLSF_BYTES];
+
+static bool initialized = false;
+static DashHeapStats stats;
+
+// ============================================================================
+// SIZE-CLASS POOLS
+// ============================================================================
+
+typedef struct PoolSlot {
+    struct PoolSlot* next;
+} PoolSlot;
+
+static uint8_t* pool_base[DASH_HEAP_POOL_CLASSES];
+static PoolSlot* pool_free[DASH_HEAP_POOL_CLASSES];
+
+static void pools_init() {
+    uint8_t* p = pool_area;
+    for (int c = 0; c < DASH_HEAP_POOL_CLASSES; c++) {
+        pool_base[c] = p;
+        pool_free[c] = nullptr;
+        // Pushed last to first: slots are handed out in address order
+        for (uint32_t i = pool_slot_count[c]; i-- > 0;) {
+            PoolSlot* s = (PoolSlot*)(p + i * pool_slot_size[c]);
+            s->next = pool_free[c];
+            pool_free[c] = s;
+        }
+        p += pool_slot_count[c] * pool_slot_size[c];
+
+        stats.pools[c].slot_size = pool_slot_size[c];
+        stats.pools[c].slots = pool_slot_count[c];
+    }
+}
+
+// Smallest class that fits, -1 if none
+static int pool_class(size_t size) {
+    for (int c = 0; c < DASH_HEAP_POOL_CLASSES; c++) {
+        if (size <= pool_slot_size[c]) return c;
+    }
+    return -1;
+}
+
+// Class of a pool slot, -1 if p is not in the pools
+static int pool_of(const void* p) {
+    const uint8_t* b = (const uint8_t*)p;
+    if (b < pool_area || b >= pool_area + POOL_BYTES) return -1;
+    for (int c = DASH_HEAP_POOL_CLASSES - 1; c > 0; c--) {
+        if (b >= pool_base[c]) return c;
+    }
+    return 0;
+}
+
+static void* pool_alloc(int c) {
+    PoolSlot* s = pool_free[c];
+    if (!s) {
+        stats.pools[c].misses++;
+        return nullptr;
+    }
+    pool_free[c] = s->next;
+    DashHeapPoolStats& ps = stats.pools[c];
+    if (++ps.used > ps.peak_used) ps.peak_used = ps.used;
+    stats.live_bytes += pool_slot_size[c];
+    return s;
+}
+
+static void pool_release(int c, void* p) {
+    PoolSlot* s = (PoolSlot*)p;
+    s->next = pool_free[c];
+    pool_free[c] = s;
+    stats.pools[c].used--;
+    stats.live_bytes -= pool_slot_size[c];
+}
+
+// ============================================================================
+// TLSF
+// ============================================================================
+// Free blocks are kept in lists by size: first level = power of two, second
+// level = 16 linear steps within it (bitmaps say which lists are non-empty).
+// An allocation rounds up to the next list that only holds big enough blocks,
+// so the search is two bit scans. Blocks are physically linked both ways, so
+// a free merges with free neighbours at once.
+
+typedef struct Block {
+    struct Block* prev_phys;    // Physically previous block, nullptr for the first
+    size_t size;                // Payload bytes | BLOCK_FREE
+    // Payload; free blocks keep their list links here
+    struct Block* next_free;
+    struct Block* prev_free;
+} Block;
+
+#define BLOCK_HEADER offsetof(Block, next_free)
+#define BLOCK_FREE   ((size_t)1)
+#define MIN_PAYLOAD  (sizeof(Block) - BLOCK_HEADER)
+
+#define ALIGN_LOG2  3
+#define ALIGN       (1U << ALIGN_LOG2)
+#define SL_LOG2     4
+#define SL_COUNT    (1U << SL_LOG2)
+#define FL_SHIFT    (SL_LOG2 + ALIGN_LOG2)
+#define SMALL_BLOCK (1U << FL_SHIFT)        // Below: one first level, 8 byte steps
+#define FL_MAX      18                      // Blocks < 256 KB
+#define FL_COUNT    (FL_MAX - FL_SHIFT + 1)
+
+static_assert(BLOCK_HEADER % ALIGN == 0, "payload must stay aligned");
+static_assert(TLSF_BYTES < (1U << FL_MAX), "TLSF area beyond the first-level index");
+
+static uint32_t fl_bitmap;
+static uint32_t sl_bitmap[FL_COUNT];
+static Block* free_heads[FL_COUNT][SL_COUNT];
+
+// Highest / lowest set bit, x != 0
+static inline int fls32(uint32_t x) {
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(x);
+#else
+    int i = 0;
+    while (x >>= 1) i++;
+    return i;
+#endif
+}
+
+static inline int ffs32(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    int i = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static inline size_t block_size(const Block* b) { return b->size & ~BLOCK_FREE; }
+static inline bool block_is_free(const Block* b) { return (b->size & BLOCK_FREE) != 0; }
+static inline void* block_payload(Block* b) { return (uint8_t*)b + BLOCK_HEADER; }
+static inline Block* payload_block(void* p) { return (Block*)((uint8_t*)p - BLOCK_HEADER); }
+static inline Block* block_next(const Block* b) {
+    return (Block*)((uint8_t*)b + BLOCK_HEADER + block_size(b));
+}
+
+// List a block of this size belongs to
+static void mapping_insert(size_t size, int* fl, int* sl) {
+    if (size < SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (int)(size / (SMALL_BLOCK / SL_COUNT));
+    } else {
+        int f = fls32((uint32_t)size);
+        *sl = (int)((size >> (f - SL_LOG2)) ^ SL_COUNT);
+        *fl = f - (FL_SHIFT - 1);
+    }
+}
+
+// First list whose blocks are all >= size; false if beyond the index
+static bool mapping_search(size_t size, int* fl, int* sl) {
+    if (size >= SMALL_BLOCK) size += (1U << (fls32((uint32_t)size) - SL_LOG2)) - 1;
+    mapping_insert(size, fl, sl);
+    return *fl < (int)FL_COUNT;
+}
+
+static void insert_free(Block* b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    Block* head = free_heads[fl][sl];
+    b->next_free = head;
+    b->prev_free = nullptr;
+    if (head) head->prev_free = b;
+    free_heads[fl][sl] = b;
+    fl_bitmap |= 1U << fl;
+    sl_bitmap[fl] |= 1U << sl;
+}
+
+static void remove_free(Block* b) {
+    int fl, sl;
+    mapping_insert(block_size(b), &fl, &sl);
+    if (b->next_free) b->next_free->prev_free = b->prev_free;
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        free_heads[fl][sl] = b->next_free;
+        if (!b->next_free) {
+            sl_bitmap[fl] &= ~(1U << sl);
+            if (!sl_bitmap[fl]) fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+static Block* find_free(int fl, int sl) {
+    uint32_t sl_map = sl_bitmap[fl] & (~0U << sl);
+    if (!sl_map) {
+        uint32_t fl_map = fl_bitmap & (~0U << (fl + 1));
+        if (!fl_map) return nullptr;
+        fl = ffs32(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    return free_heads[fl][ffs32(sl_map)];
+}
+
+// Free b and merge it with free neighbours
+static void release(Block* b) {
+    b->size |= BLOCK_FREE;
+    Block* prev = b->prev_phys;
+    if (prev && block_is_free(prev)) {
+        remove_free(prev);
+        prev->size += BLOCK_HEADER + block_size(b);
+        b = prev;
+    }
+    Block* next = block_next(b);
+    if (block_is_free(next)) {
+        remove_free(next);
+        b->size += BLOCK_HEADER + block_size(next);
+    }
+    block_next(b)->prev_phys = b;
+    insert_free(b);
+}
+
+// Trim a used block to size; a tail big enough to be a block is released
+static void split(Block* b, size_t size) {
+    size_t rest = block_size(b) - size;
+    if (rest < BLOCK_HEADER + MIN_PAYLOAD) return;
+    Block* tail = (Block*)((uint8_t*)b + BLOCK_HEADER + size);
+    tail->prev_phys = b;
+    tail->size = rest - BLOCK_HEADER;
+    b->size = size;
+    block_next(tail)->prev_phys = tail;
+    release(tail);
+}
+
+static size_t adjust_size(size_t size) {
+    size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+    return size < MIN_PAYLOAD ? MIN_PAYLOAD : size;
+}
+
+static void tlsf_init() {
+    Block* first = (Block*)tlsf_area;
+    first->prev_phys = nullptr;
+    first->size = TLSF_BYTES - 2 * BLOCK_HEADER;
+    // Sentinel: used and empty, ends every walk and merge
+    Block* sentinel = block_next(first);
+    sentinel->prev_phys = first;
+    sentinel->size = 0;
+    release(first);
+}
+
+static Block* tlsf_alloc(size_t size) {
+    if (size > TLSF_BYTES) return nullptr;
+    size = adjust_size(size);
+    int fl, sl;
+    if (!mapping_search(size, &fl, &sl)) return nullptr;
+    Block* b = find_free(fl, sl);
+    if (!b) return nullptr;
+    remove_free(b);
+    b->size &= ~BLOCK_FREE;
+    split(b, size);
+    return b;
+}
+
+// Resize without moving: shrink, or grow into a free next block
+static bool tlsf_resize(Block* b, size_t size) {
+    if (size > TLSF_BYTES) return false;
+    size = adjust_size(size);
+    if (size <= block_size(b)) {
+        split(b, size);
+        return true;
+    }
+    Block* next = block_next(b);
+    if (!block_is_free(next) || block_size(b) + BLOCK_HEADER + block_size(next) < size) return false;
+    remove_free(next);
+    b->size += BLOCK_HEADER + block_size(next);
+    block_next(b)->prev_phys = b;
+    split(b, size);
+    return true;
+}
+
+// ============================================================================
+// LV_MEM_CUSTOM ENTRY POINTS
+// ============================================================================
+
+static void heap_init() {
+    stats.arena_bytes = POOL_BYTES + TLSF_BYTES;
+    pools_init();
+    tlsf_init();
+    initialized = true;
+}
+
+static void note_alloc() {
+    stats.allocs++;
+    stats.live_allocs++;
+    if (stats.live_bytes > stats.peak_bytes) stats.peak_bytes = stats.live_bytes;
+}
+
+void* dash_heap_alloc(size_t size) {
+    if (!initialized) heap_init();
+    void* p = nullptr;
+    int c = pool_class(size);
+    if (c >= 0) p = pool_alloc(c);
+    if (!p) {
+        Block* b = tlsf_alloc(size);
+        if (b) {
+            stats.live_bytes += block_size(b);
+            p = block_payload(b);
+        }
+    }
+    if (!p) {
+        stats.failed++;
+        return nullptr;
+    }
+    note_alloc();
+    return p;
+}
+
+void dash_heap_free(void* p) {
+    if (!p) return;
+    int c = pool_of(p);
+    if (c >= 0) {
+        pool_release(c, p);
+    } else {
+        Block* b = payload_block(p);
+        stats.live_bytes -= block_size(b);
+        release(b);
+    }
+    stats.frees++;
+    stats.live_allocs--;
+}
+
+void* dash_heap_realloc(void* p, size_t size) {
+    if (!p) return dash_heap_alloc(size);
+    if (size == 0) {
+        dash_heap_free(p);
+        return nullptr;
+    }
+    stats.reallocs++;
+
+    size_t old_size;
+    int c = pool_of(p);
+    if (c >= 0) {
+        if (size <= pool_slot_size[c]) return p;        // Still fits its slot
+        old_size = pool_slot_size[c];
+    } else {
+        Block* b = payload_block(p);
+        old_size = block_size(b);
+        if (tlsf_resize(b, size)) {
+            stats.live_bytes = stats.live_bytes - old_size + block_size(b);
+            if (stats.live_bytes > stats.peak_bytes) stats.peak_bytes = stats.live_bytes;
+            return p;
+        }
+    }
+
+    void* q = dash_heap_alloc(size);
+    if (!q) return nullptr;                             // p stays valid
+    memcpy(q, p, old_size < size ? old_size : size);
+    dash_heap_free(p);
+    return q;
+}
+
+// ============================================================================
+// TELEMETRY
+// ============================================================================
+
+void dash_heap_get_stats(DashHeapStats* out) {
+    if (!initialized) heap_init();
+    *out = stats;
+    out->free_bytes = 0;
+    out->free_blocks = 0;
+    out->largest_free = 0;
+    memset(out->free_hist, 0, sizeof(out->free_hist));
+
+    for (Block* b = (Block*)tlsf_area; block_size(b) != 0; b = block_next(b)) {
+        if (!block_is_free(b)) continue;
+        uint32_t size = (uint32_t)block_size(b);
+        uint32_t bucket = 0;
+        while (bucket < DASH_HEAP_FREE_BUCKETS - 1 && size >= (32U << bucket)) bucket++;
+        out->free_hist[bucket]++;
+        out->free_bytes += size;
+        out->free_blocks++;
+        if (size > out->largest_free) out->largest_free = size;
+    }
+}
+
+uint32_t dash_heap_fragmentation(const DashHeapStats* s) {
+    if (s->free_bytes == 0) return 0;
+    return 100 - (uint32_t)((uint64_t)s->largest_free * 100 / s->free_bytes);
+}
+
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond)) {                                  \
+            fprintf(stderr, "[heap] check failed: ");   \
+            fprintf(stderr, __VA_ARGS__);               \
+            fprintf(stderr, "\n");                      \
+            return false;                               \
+        }                                               \
+    } while (0)
+
+bool dash_heap_check(void) {
+    if (!initialized) heap_init();
+
+    // Physical chain: links, alignment, no two free neighbours
+    uint32_t used_bytes = 0, free_blocks = 0;
+    Block* prev = nullptr;
+    Block* b = (Block*)tlsf_area;
+    for (; block_size(b) != 0; prev = b, b = block_next(b)) {
+        CHECK((uint8_t*)b + BLOCK_HEADER + block_size(b) <= tlsf_area + TLSF_BYTES - BLOCK_HEADER,
+              "block %p runs past the arena", (void*)b);
+        CHECK(b->prev_phys == prev, "block %p: wrong previous block", (void*)b);
+        CHECK(block_size(b) % ALIGN == 0 && block_size(b) >= MIN_PAYLOAD, "block %p: bad size %zu",
+              (void*)b, block_size(b));
+        if (block_is_free(b)) {
+            CHECK(!prev || !block_is_free(prev), "free blocks %p and %p not merged", (void*)prev, (void*)b);
+            free_blocks++;
+        } else {
+            used_bytes += (uint32_t)block_size(b);
+        }
+    }
+    CHECK((uint8_t*)b == tlsf_area + TLSF_BYTES - BLOCK_HEADER && b->prev_phys == prev && !block_is_free(b),
+          "sentinel misplaced");
+
+    // Free lists: every block free, in its list, bitmaps in step
+    uint32_t listed = 0;
+    for (int fl = 0; fl < (int)FL_COUNT; fl++) {
+        CHECK(((fl_bitmap >> fl) & 1) == (sl_bitmap[fl] != 0), "first-level bit %d", fl);
+        for (int sl = 0; sl < (int)SL_COUNT; sl++) {
+            CHECK(((sl_bitmap[fl] >> sl) & 1) == (free_heads[fl][sl] != nullptr), "second-level bit %d/%d", fl, sl);
+            for (Block* f = free_heads[fl][sl]; f; f = f->next_free) {
+                int ffl, fsl;
+                mapping_insert(block_size(f), &ffl, &fsl);
+                CHECK(block_is_free(f) && ffl == fl && fsl == sl, "block %p in list %d/%d", (void*)f, fl, sl);
+                CHECK(++listed <= free_blocks, "free lists hold more than %u blocks", free_blocks);
+            }
+        }
+    }
+    CHECK(listed == free_blocks, "%u blocks listed, %u free", listed, free_blocks);
+
+    // Pools: free slots + used = slots, all inside the class
+    uint32_t pool_bytes = 0;
+    for (int c = 0; c < DASH_HEAP_POOL_CLASSES; c++) {
+        uint32_t n = 0;
+        for (PoolSlot* s = pool_free[c]; s; s = s->next) {
+            CHECK(pool_of(s) == c && ((uint8_t*)s - pool_base[c]) % pool_slot_size[c] == 0,
+                  "slot %p in free list of class %d", (void*)s, c);
+            CHECK(++n <= pool_slot_count[c], "class %d free list loops", c);
+        }
+        CHECK(n + stats.pools[c].used == pool_slot_count[c], "class %d: %u free + %u used", c, n,
+              stats.pools[c].used);
+        pool_bytes += stats.pools[c].used * pool_slot_size[c];
+    }
+
+    CHECK(stats.live_bytes == used_bytes + pool_bytes, "live bytes %u, blocks hold %u", stats.live_bytes,
+          used_bytes + pool_bytes);
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef DASH_HEAP_H
+#define DASH_HEAP_H
+
+// ============================================================================
+// LVGL heap (LV_MEM_CUSTOM): size-class pools + TLSF, with telemetry
+// ============================================================================
+// Small requests (label text, style property arrays, event lists, timers,
+// most widget structs) take a slot from a fixed pool of their size class:
+// a free list pop, no splitting or merging, and no holes left between
+// long-lived objects when text is reallocated every frame. Larger requests,
+// and small ones whose pool is exhausted, go to a TLSF heap (two-level
+// segregated fit: O(1) allocate and free, immediate coalescing).
+//
+// The arena is static: 32 KB of pools + 128 KB TLSF (the previous
+// LV_MEM_SIZE). Only LVGL's thread allocates here; there is no locking.
+//
+// Included by lv_mem.c through lv_conf.h: plain C.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DASH_HEAP_POOL_CLASSES 4        // 16, 32, 64, 128 byte slots
+#define DASH_HEAP_FREE_BUCKETS 14       // TLSF free blocks: [0,32), [32,64) ... [128K, inf)
+
+typedef struct {
+    uint32_t slot_size;
+    uint32_t slots;
+    uint32_t used;
+    uint32_t peak_used;
+    uint64_t misses;                    // Requests of this class served by TLSF (pool full)
+} DashHeapPoolStats;
+
+typedef struct {
+    uint32_t arena_bytes;               // Pools + TLSF
+    uint32_t live_bytes;                // Pool slots + TLSF blocks in use (rounded sizes)
+    uint32_t peak_bytes;
+    uint32_t live_allocs;
+
+    // Cumulative; rates are deltas over the caller's period
+    uint64_t allocs;                    // Including reallocs that moved
+    uint64_t frees;
+    uint64_t reallocs;
+    uint64_t failed;
+
+    // TLSF free space (walked when stats are taken)
+    uint32_t free_bytes;
+    uint32_t free_blocks;
+    uint32_t largest_free;
+    uint32_t free_hist[DASH_HEAP_FREE_BUCKETS];
+
+    DashHeapPoolStats pools[DASH_HEAP_POOL_CLASSES];
+} DashHeapStats;
+
+void* dash_heap_alloc(size_t size);
+void dash_heap_free(void* p);
+void* dash_heap_realloc(void* p, size_t size);
+
+void dash_heap_get_stats(DashHeapStats* out);
+
+// Percent of TLSF free space outside the largest free block (0 = one hole)
+uint32_t dash_heap_fragmentation(const DashHeapStats* s);
+
+// Walks every block and free list; false (and a message on stderr) if the
+// heap is inconsistent. For checks, not per frame.
+bool dash_heap_check(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DASH_HEAP_H
@@ -0,0 +1,284 @@
+#include "frame_stats.h"
+#include "dash_heap.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifndef _WIN32
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+#endif
+
+bool g_frame_stats_enabled = false;
+
+static float period_s = 5.0f;
+static std::string export_path;
+#ifndef _WIN32
+static int export_sock = -1;
+static struct sockaddr_un export_addr;
+#endif
+
+static FrameStats current;
+static FrameStats last;
+static uint32_t window_seq = 0;
+static uint64_t window_start_us = 0;
+static uint64_t loop_last_us = 0;
+static uint64_t refresh_start_us = 0;
+static bool refreshed = false;
+static uint32_t refreshed_px = 0;
+
+#define PENDING_FRAMES 4
+
+// Redrawn by lv_timer_handler(), waiting for their last band (main thread)
+typedef struct {
+    uint64_t start_us;
+    uint64_t end_us;
+    uint32_t px;
+} RenderedFrame;
+
+static RenderedFrame rendered[PENDING_FRAMES];
+static uint32_t rendered_count = 0;
+
+// Bands of the frame being flushed (flush thread or main thread)
+static std::atomic<uint32_t> band_count{0};
+static std::atomic<uint32_t> band_flush_us{0};
+
+// Completely flushed, taken by the main thread at the next refresh_end
+typedef struct {
+    uint32_t bands;
+    uint32_t flush_us;
+    uint64_t done_us;
+} FlushedFrame;
+
+static std::mutex flushed_lock;
+static FlushedFrame flushed[PENDING_FRAMES];
+static uint32_t flushed_count = 0;
+
+static uint64_t now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================================
+// HISTOGRAMS
+// ============================================================================
+
+void frame_hist_add(FrameHist* h, uint32_t value) {
+    uint32_t b = 0;
+    while (b < FRAME_HIST_BUCKETS - 1 && value >= (2u << b)) b++;
+    h->buckets[b]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) h->max = value;
+}
+
+uint32_t frame_hist_percentile(const FrameHist* h, float p) {
+    if (h->count == 0) return 0;
+    uint32_t rank = (uint32_t)(p * (h->count - 1)) + 1;
+    uint32_t seen = 0;
+    for (uint32_t b = 0; b < FRAME_HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = b < FRAME_HIST_BUCKETS - 1 ? (2u << b) - 1 : h->max;
+            return upper < h->max ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+// ============================================================================
+// EXPORT
+// ============================================================================
+
+static int append_hist(char* out, size_t size, const char* name, const FrameHist* h) {
+    int n = snprintf(out, size, "\"%s\":{\"count\":%u,\"avg\":%.1f,\"p50\":%u,\"p99\":%u,\"max\":%u,\"buckets\":[",
+                     name, h->count, h->count ? (double)h->sum / h->count : 0.0,
+                     frame_hist_percentile(h, 0.5f), frame_hist_percentile(h, 0.99f), h->max);
+    for (uint32_t b = 0; b < FRAME_HIST_BUCKETS && n < (int)size; b++) {
+        n += snprintf(out + n, size - n, b ? ",%u" : "%u", h->buckets[b]);
+    }
+    if (n < (int)size) n += snprintf(out + n, size - n, "]}");
+    return n;
+}
+
+static void export_window(const FrameStats* s) {
+    char json[2048];
+    int n = snprintf(json, sizeof(json), "{\"seq\":%u,\"seconds\":%.2f,\"frames\":%u,", window_seq, s->seconds, s->frames);
+    const struct { const char* name; const FrameHist* hist; } hists[] = {
+        { "render_us", &s->render_us },
+        { "flush_us", &s->flush_us },
+        { "area_px", &s->area_px },
+        { "bands", &s->bands },
+        { "loop_us", &s->loop_us },
+    };
+    for (size_t i = 0; i < sizeof(hists) / sizeof(hists[0]) && n < (int)sizeof(json); i++) {
+        if (i) n += snprintf(json + n, sizeof(json) - n, ",");
+        if (n < (int)sizeof(json)) n += append_hist(json + n, sizeof(json) - n, hists[i].name, hists[i].hist);
+    }
+
+    // LVGL heap at the end of the window
+    static uint64_t last_allocs = 0;
+    DashHeapStats heap;
+    dash_heap_get_stats(&heap);
+    if (n < (int)sizeof(json)) {
+        n += snprintf(json + n, sizeof(json) - n,
+                      ",\"heap\":{\"arena\":%u,\"live\":%u,\"peak\":%u,\"allocs_per_s\":%.0f,\"failed\":%llu,"
+                      "\"free\":%u,\"largest_free\":%u,\"free_hist\":[",
+                      heap.arena_bytes, heap.live_bytes, heap.peak_bytes,
+                      s->seconds > 0 ? (heap.allocs - last_allocs) / s->seconds : 0.0,
+                      (unsigned long long)heap.failed, heap.free_bytes, heap.largest_free);
+    }
+    last_allocs = heap.allocs;
+    for (uint32_t b = 0; b < DASH_HEAP_FREE_BUCKETS && n < (int)sizeof(json); b++) {
+        n += snprintf(json + n, sizeof(json) - n, b ? ",%u" : "%u", heap.free_hist[b]);
+    }
+    if (n < (int)sizeof(json)) n += snprintf(json + n, sizeof(json) - n, "]}");
+    if (n < (int)sizeof(json)) n += snprintf(json + n, sizeof(json) - n, "}\n");
+    if (n >= (int)sizeof(json)) return;
+
+#ifndef _WIN32
+    if (export_sock >= 0) {
+        // Datagram, non-blocking: no reader, no cost
+        sendto(export_sock, json, n, MSG_DONTWAIT, (struct sockaddr*)&export_addr, sizeof(export_addr));
+        return;
+    }
+#endif
+
+    // Replace the file so readers never see a partial window
+    std::string tmp = export_path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "w");
+    if (!f) return;
+    fwrite(json, 1, n, f);
+    fclose(f);
+#ifdef _WIN32
+    std::remove(export_path.c_str());     // rename() does not replace on Windows
+#endif
+    std::rename(tmp.c_str(), export_path.c_str());
+}
+
+// ============================================================================
+// HOOKS
+// ============================================================================
+
+bool frame_stats_enable(float period, const char* path) {
+    period_s = period > 0.0f ? period : 5.0f;
+    export_path = path ? path : "";
+
+#ifndef _WIN32
+    if (export_path.compare(0, 5, "unix:") == 0) {
+        memset(&export_addr, 0, sizeof(export_addr));
+        export_addr.sun_family = AF_UNIX;
+        strncpy(export_addr.sun_path, export_path.c_str() + 5, sizeof(export_addr.sun_path) - 1);
+        export_sock = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (export_sock < 0) {
+            perror("[stats] socket");
+            return false;
+        }
+    }
+#endif
+
+    memset(&current, 0, sizeof(current));
+    window_start_us = now_us();
+    g_frame_stats_enabled = true;
+    printf("[stats] Frame stats every %.1f s%s%s\n", period_s,
+           export_path.empty() ? "" : " -> ", export_path.c_str());
+    return true;
+}
+
+void frame_stats_shutdown() {
+    g_frame_stats_enabled = false;
+#ifndef _WIN32
+    if (export_sock >= 0) close(export_sock);
+    export_sock = -1;
+#endif
+}
+
+bool frame_stats_window(FrameStats* out, uint32_t* sequence) {
+    if (window_seq == 0) return false;
+    *out = last;
+    if (sequence) *sequence = window_seq;
+    return true;
+}
+
+void frame_stats_loop_impl() {
+    uint64_t now = now_us();
+    if (loop_last_us) frame_hist_add(&current.loop_us, (uint32_t)(now - loop_last_us));
+    loop_last_us = now;
+
+    float elapsed = (now - window_start_us) / 1e6f;
+    if (elapsed >= period_s) {
+        current.seconds = elapsed;
+        last = current;
+        window_seq++;
+        if (!export_path.empty()) export_window(&last);
+        memset(&current, 0, sizeof(current));
+        window_start_us = now;
+    }
+}
+
+void frame_stats_refresh_begin_impl() {
+    refresh_start_us = now_us();
+    refreshed = false;
+}
+
+void frame_stats_refreshed_impl(uint32_t px) {
+    refreshed = true;
+    refreshed_px += px;
+}
+
+void frame_stats_band_impl(uint32_t flush_us) {
+    band_count.fetch_add(1, std::memory_order_relaxed);
+    band_flush_us.fetch_add(flush_us, std::memory_order_relaxed);
+}
+
+void frame_stats_flushed_impl() {
+    FlushedFrame frame;
+    frame.bands = band_count.exchange(0, std::memory_order_relaxed);
+    frame.flush_us = band_flush_us.exchange(0, std::memory_order_relaxed);
+    frame.done_us = now_us();
+
+    std::lock_guard<std::mutex> lock(flushed_lock);
+    if (flushed_count == PENDING_FRAMES) {
+        memmove(flushed, flushed + 1, (PENDING_FRAMES - 1) * sizeof(flushed[0]));
+        flushed_count--;
+    }
+    flushed[flushed_count++] = frame;
+}
+
+void frame_stats_refresh_end_impl() {
+    if (refreshed) {
+        if (rendered_count == PENDING_FRAMES) {
+            memmove(rendered, rendered + 1, (PENDING_FRAMES - 1) * sizeof(rendered[0]));
+            rendered_count--;
+        }
+        rendered[rendered_count++] = { refresh_start_us, now_us(), refreshed_px };
+        refreshed = false;
+        refreshed_px = 0;
+    }
+
+    // Frames flush in the order they were drawn: pair them up oldest first
+    FlushedFrame done[PENDING_FRAMES];
+    uint32_t n_done;
+    {
+        std::lock_guard<std::mutex> lock(flushed_lock);
+        n_done = flushed_count;
+        memcpy(done, flushed, n_done * sizeof(done[0]));
+        flushed_count = 0;
+    }
+    for (uint32_t i = 0; i < n_done && rendered_count > 0; i++) {
+        const RenderedFrame r = rendered[0];
+        memmove(rendered, rendered + 1, (rendered_count - 1) * sizeof(rendered[0]));
+        rendered_count--;
+
+        uint64_t end_us = done[i].done_us > r.end_us ? done[i].done_us : r.end_us;
+        frame_hist_add(&current.render_us, (uint32_t)(end_us - r.start_us));
+        frame_hist_add(&current.area_px, r.px);
+        frame_hist_add(&current.bands, done[i].bands);
+        frame_hist_add(&current.flush_us, done[i].flush_us);
+        current.frames++;
+    }
+}
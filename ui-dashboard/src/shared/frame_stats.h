@@ -0,0 +1,90 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+// ============================================================================
+// Frame statistics: render/flush time, invalidated area, flush bands and
+// main loop latency per frame, in fixed-size log2 histograms
+// ============================================================================
+// main reports loop iterations and times lv_timer_handler(); the display
+// backends report each flushed band and the end of the frame's last one
+// (from any thread). With a flush thread that last band can land after
+// lv_timer_handler() returned, so a frame is only counted once it is
+// flushed completely, against the lv_timer_handler() call that drew it.
+// Every period the window is closed: it feeds the on-screen overlay and, if
+// configured, is written as one JSON line, with the LVGL heap's state, to a
+// file (replaced each time) or sent to a Unix datagram socket
+// ("unix:/run/dash-stats.sock").
+//
+// Disabled (the default) every hook is a single branch on a global.
+
+#include <stdint.h>
+
+#define FRAME_HIST_BUCKETS 24           // [0,2), [2,4), [4,8) ... [2^23, inf)
+
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[FRAME_HIST_BUCKETS];
+} FrameHist;
+
+typedef struct {
+    FrameHist render_us;        // lv_timer_handler() calls that redrew, until their last band was flushed
+    FrameHist flush_us;         // Per frame, all bands
+    FrameHist area_px;          // Invalidated pixels per frame
+    FrameHist bands;            // Flush calls per frame
+    FrameHist loop_us;          // Main loop iteration period
+    uint32_t frames;
+    float seconds;              // Window length
+} FrameStats;
+
+extern bool g_frame_stats_enabled;
+
+void frame_hist_add(FrameHist* h, uint32_t value);
+uint32_t frame_hist_percentile(const FrameHist* h, float p);    // Bucket upper bound, p in [0, 1]
+
+// export_path: file, "unix:<socket path>" or NULL
+bool frame_stats_enable(float period_s, const char* export_path);
+void frame_stats_shutdown();
+
+// Last closed window; false until the first one closes
+bool frame_stats_window(FrameStats* out, uint32_t* sequence);
+
+// Hooks
+void frame_stats_loop_impl();
+void frame_stats_refresh_begin_impl();
+void frame_stats_refresh_end_impl();
+void frame_stats_refreshed_impl(uint32_t px);
+void frame_stats_band_impl(uint32_t flush_us);
+void frame_stats_flushed_impl();
+
+// Main loop iteration start
+static inline void frame_stats_loop() {
+    if (g_frame_stats_enabled) frame_stats_loop_impl();
+}
+
+// Around lv_timer_handler()
+static inline void frame_stats_refresh_begin() {
+    if (g_frame_stats_enabled) frame_stats_refresh_begin_impl();
+}
+static inline void frame_stats_refresh_end() {
+    if (g_frame_stats_enabled) frame_stats_refresh_end_impl();
+}
+
+// From the display's monitor_cb: a refresh redrew px pixels
+static inline void frame_stats_refreshed(uint32_t px) {
+    if (g_frame_stats_enabled) frame_stats_refreshed_impl(px);
+}
+
+// From the display backend, per flushed band (any thread)
+static inline void frame_stats_band(uint32_t flush_us) {
+    if (g_frame_stats_enabled) frame_stats_band_impl(flush_us);
+}
+
+// From the display backend once the frame's last band is out (same thread
+// as its bands)
+static inline void frame_stats_flushed() {
+    if (g_frame_stats_enabled) frame_stats_flushed_impl();
+}
+
+#endif // FRAME_STATS_H
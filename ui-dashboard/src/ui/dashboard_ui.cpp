@@ -1,5 +1,6 @@
 #include "dashboard_ui.h"
 #include "screens/ui_screen_main.h"
+#include "gauge_layers.h"
 #include <algorithm>
 #include <cstdio>
 #include <ctime>
@@ -11,94 +12,103 @@ void DashboardUI::init() {
     printf("[UI] Starting UI component binding...\n");
 
     // Bind SquareLine UI components from ui_screen_main
-    time_label = ui_Time;
-    printf("[UI] time_label bound: %p\n", (void*)time_label);
+    time_label.bind(ui_Time, UI_RATE_SLOW_HZ, &update_stats);
+    printf("[UI] time_label bound: %p\n", (void*)time_label.get());
 
-    gear_label = ui_DNRlabel;
-    printf("[UI] gear_label bound: %p\n", (void*)gear_label);
+    gear_label.bind(ui_DNRlabel, UI_RATE_FAST_HZ, &update_stats);
+    printf("[UI] gear_label bound: %p\n", (void*)gear_label.get());
 
-    torque_gauge = ui_TRQgauge;
-    printf("[UI] torque_gauge bound: %p\n", (void*)torque_gauge);
+    torque_gauge.bind(ui_TRQgauge, UI_RATE_FAST_HZ, &update_stats);
+    printf("[UI] torque_gauge bound: %p\n", (void*)torque_gauge.get());
 
-    torque_gauge_regen = ui_TRQgauge1;
-    printf("[UI] torque_gauge_regen bound: %p\n", (void*)torque_gauge_regen);
+    torque_gauge_regen.bind(ui_TRQgauge1, UI_RATE_FAST_HZ, &update_stats);
+    printf("[UI] torque_gauge_regen bound: %p\n", (void*)torque_gauge_regen.get());
 
-    speed_label = ui_SPEEDlabel;
-    printf("[UI] speed_label bound: %p\n", (void*)speed_label);
+    speed_label.bind(ui_SPEEDlabel, UI_RATE_FAST_HZ, &update_stats);
+    printf("[UI] speed_label bound: %p\n", (void*)speed_label.get());
 
-    power_gauge = ui_BATPOWERgauge;
-    printf("[UI] power_gauge bound: %p\n", (void*)power_gauge);
+    power_gauge.bind(ui_BATPOWERgauge, UI_RATE_FAST_HZ, &update_stats);
+    printf("[UI] power_gauge bound: %p\n", (void*)power_gauge.get());
 
-    soc_label = ui_BATSOClabel;
-    printf("[UI] soc_label bound: %p\n", (void*)soc_label);
+    soc_label.bind(ui_BATSOClabel, UI_RATE_SLOW_HZ, &update_stats);
+    printf("[UI] soc_label bound: %p\n", (void*)soc_label.get());
 
     // Battery temperature components
-    battery_temp_bar = ui_TEMPbar;
-    printf("[UI] battery_temp_bar bound: %p\n", (void*)battery_temp_bar);
+    battery_temp_bar.bind(ui_TEMPbar, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] battery_temp_bar bound: %p\n", (void*)battery_temp_bar.get());
 
-    battery_temp_value = ui_TEMPvalue;
-    printf("[UI] battery_temp_value bound: %p\n", (void*)battery_temp_value);
+    battery_temp_value.bind(ui_TEMPvalue, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] battery_temp_value bound: %p\n", (void*)battery_temp_value.get());
 
     battery_temp_name = ui_TEMPname;
     printf("[UI] battery_temp_name bound: %p\n", (void*)battery_temp_name);
 
     // Motor temperature components
-    motor_temp_bar = ui_TEMPbar1;
-    printf("[UI] motor_temp_bar bound: %p\n", (void*)motor_temp_bar);
+    motor_temp_bar.bind(ui_TEMPbar1, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] motor_temp_bar bound: %p\n", (void*)motor_temp_bar.get());
 
-    motor_temp_value = ui_TEMPvalue1;
-    printf("[UI] motor_temp_value bound: %p\n", (void*)motor_temp_value);
+    motor_temp_value.bind(ui_TEMPvalue1, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] motor_temp_value bound: %p\n", (void*)motor_temp_value.get());
 
     motor_temp_name = ui_TEMPname1;
     printf("[UI] motor_temp_name bound: %p\n", (void*)motor_temp_name);
 
     // Inverter temperature components
-    inverter_temp_bar = ui_TEMPbar2;
-    printf("[UI] inverter_temp_bar bound: %p\n", (void*)inverter_temp_bar);
+    inverter_temp_bar.bind(ui_TEMPbar2, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] inverter_temp_bar bound: %p\n", (void*)inverter_temp_bar.get());
 
-    inverter_temp_value = ui_TEMPvalue2;
-    printf("[UI] inverter_temp_value bound: %p\n", (void*)inverter_temp_value);
+    inverter_temp_value.bind(ui_TEMPvalue2, UI_RATE_TEMP_HZ, &update_stats);
+    printf("[UI] inverter_temp_value bound: %p\n", (void*)inverter_temp_value.get());
 
     inverter_temp_name = ui_TEMPname2;
     printf("[UI] inverter_temp_name bound: %p\n", (void*)inverter_temp_name);
 
+    // Speed and SOC as fixed-width digit cells (the labels stay as fallback)
+    if (speed_digits.create(ui_SPEEDlabel, 3, "kph", DIGITS_SUFFIX_BELOW, UI_RATE_FAST_HZ, &update_stats)) {
+        gauge_layers_add_live(speed_digits.get());
+    }
+    if (soc_digits.create(ui_BATSOClabel, 3, "%", DIGITS_SUFFIX_RIGHT, UI_RATE_SLOW_HZ, &update_stats)) {
+        gauge_layers_add_live(soc_digits.get());
+    }
+    printf("[UI] speed/SOC digit displays: %s\n", speed_digits.get() && soc_digits.get() ? "yes" : "labels");
+
     printf("[UI] All components bound successfully\n");
 
     // Configure torque gauge (Arc: 0 to 320 Nm for positive torque)
-    if (torque_gauge) {
+    if (torque_gauge.get()) {
         printf("[UI] Configuring torque gauge...\n");
-        lv_arc_set_range(torque_gauge, 0, 320);
-        lv_arc_set_value(torque_gauge, 0);
+        lv_arc_set_range(torque_gauge.get(), 0, 320);
+        lv_arc_set_value(torque_gauge.get(), 0);
         printf("[UI] Torque gauge configured (range: 0 to 320 Nm)\n");
     } else {
         printf("[UI] WARNING: torque_gauge is NULL!\n");
     }
 
     // Configure regen torque gauge (Arc: 0 to 100 Nm for regen, reverse mode)
-    if (torque_gauge_regen) {
+    if (torque_gauge_regen.get()) {
         printf("[UI] Configuring regen torque gauge...\n");
-        lv_arc_set_range(torque_gauge_regen, 0, 100);
-        lv_arc_set_value(torque_gauge_regen, 0);
+        lv_arc_set_range(torque_gauge_regen.get(), 0, 100);
+        lv_arc_set_value(torque_gauge_regen.get(), 0);
         printf("[UI] Regen torque gauge configured (range: 0 to 100 Nm, reverse mode)\n");
     } else {
         printf("[UI] WARNING: torque_gauge_regen is NULL!\n");
     }
 
     // Configure temperature bars
-    if (battery_temp_bar) {
+    if (battery_temp_bar.get()) {
         printf("[UI] Configuring battery temp bar...\n");
-        lv_bar_set_range(battery_temp_bar, 20, 50);  // Battery: 20-50°C
-        lv_bar_set_value(battery_temp_bar, 25, LV_ANIM_OFF);
+        lv_bar_set_range(battery_temp_bar.get(), 20, 50);  // Battery: 20-50°C
+        lv_bar_set_value(battery_temp_bar.get(), 25, LV_ANIM_OFF);
     }
-    if (motor_temp_bar) {
+    if (motor_temp_bar.get()) {
         printf("[UI] Configuring motor temp bar...\n");
-        lv_bar_set_range(motor_temp_bar, 20, 110);   // Motor: 20-110°C
-        lv_bar_set_value(motor_temp_bar, 25, LV_ANIM_OFF);
+        lv_bar_set_range(motor_temp_bar.get(), 20, 110);   // Motor: 20-110°C
+        lv_bar_set_value(motor_temp_bar.get(), 25, LV_ANIM_OFF);
     }
-    if (inverter_temp_bar) {
+    if (inverter_temp_bar.get()) {
         printf("[UI] Configuring inverter temp bar...\n");
-        lv_bar_set_range(inverter_temp_bar, 0, 70);  // Inverter: 0-70°C
-        lv_bar_set_value(inverter_temp_bar, 25, LV_ANIM_OFF);
+        lv_bar_set_range(inverter_temp_bar.get(), 0, 70);  // Inverter: 0-70°C
+        lv_bar_set_value(inverter_temp_bar.get(), 25, LV_ANIM_OFF);
     }
 
     // Set initial temperature labels
@@ -143,59 +153,43 @@ void DashboardUI::update(const CANReceiver& can) {
 }
 
 void DashboardUI::updateTime(uint8_t h, uint8_t m, uint8_t s) {
-    if (!time_label) return;
-    lv_label_set_text_fmt(time_label, "%02d:%02d", h, m);
+    (void)s;
+    char text[8];
+    snprintf(text, sizeof(text), "%02d:%02d", h, m);
+    time_label.setText(text);
 }
 
 void DashboardUI::updateSpeedDisplay(float speed_kmh) {
-    if (!speed_label) return;
     int speed = (int)(speed_kmh + 0.5f);  // Round to nearest integer
-    lv_label_set_text_fmt(speed_label, "%d\nkph", speed);
+    if (speed_digits.get()) speed_digits.set(speed);
+    else speed_label.setInt(speed, "%d\nkph");
 }
 
 void DashboardUI::updateBatterySOC(uint8_t soc_percent) {
-    if (!soc_label) return;
     const uint8_t clamped = (soc_percent > 100) ? 100 : soc_percent;
-    lv_label_set_text_fmt(soc_label, "%u%%", (unsigned)clamped);
+    if (soc_digits.get()) soc_digits.set(clamped);
+    else soc_label.setInt(clamped, "%d%%");
 }
 
 void DashboardUI::updateGearDisplay(uint8_t gear) {
-    if (!gear_label) return;
     const char* gear_str[] = {"P", "R", "N", "D", "B"};
     const char* display = (gear < 5) ? gear_str[gear] : "?";
-    lv_label_set_text(gear_label, display);
+    gear_label.setText(display);
 }
 
 void DashboardUI::updateTorqueGauge(float torque_nm) {
-    // Handle positive torque (0 to 320 Nm) on ui_TRQgauge
-    if (torque_gauge) {
-        if (torque_nm >= 0) {
-            int torque = (int)torque_nm;
-            torque = std::min(torque, 320);
-            lv_arc_set_value(torque_gauge, torque);
-        } else {
-            lv_arc_set_value(torque_gauge, 0);
-        }
-    }
-
-    // Handle negative/regen torque (-100 to 0 Nm) on ui_TRQgauge1
-    if (torque_gauge_regen) {
-        if (torque_nm < 0) {
-            int regen = (int)(-torque_nm);  // Convert to positive value
-            regen = std::min(regen, 100);
-            lv_arc_set_value(torque_gauge_regen, regen);
-        } else {
-            lv_arc_set_value(torque_gauge_regen, 0);
-        }
-    }
+    // Positive torque (0 to 320 Nm) on ui_TRQgauge, regen (-100 to 0 Nm) on ui_TRQgauge1
+    int torque = torque_nm >= 0 ? std::min((int)torque_nm, 320) : 0;
+    int regen = torque_nm < 0 ? std::min((int)(-torque_nm), 100) : 0;
+    torque_gauge.set(torque);
+    torque_gauge_regen.set(regen);
 }
 
 void DashboardUI::updatePowerGauge(float power_kw) {
-    if (!power_gauge) return;
     // power_gauge is an Arc widget (-100 to 100 range for regen/power)
     int power = (int)power_kw;
     power = std::max(-100, std::min(power, 100));
-    lv_arc_set_value(power_gauge, power);
+    power_gauge.set(power);
 }
 
 // Helper function to get color based on temperature percentage
@@ -212,56 +206,24 @@ static lv_color_t getTemperatureColor(float percentage) {
     }
 }
 
-void DashboardUI::updateBatteryTemp(int8_t temp_c) {
-    if (battery_temp_bar) {
-        int v = std::max(20, std::min((int)temp_c, 50));
-        lv_bar_set_value(battery_temp_bar, v, LV_ANIM_ON);
-
-        // Calculate percentage (range: 20-50°C)
-        float percentage = ((float)temp_c - 20.0f) / (50.0f - 20.0f) * 100.0f;
-        percentage = std::max(0.0f, std::min(percentage, 100.0f));
+// Bar clamped to [lo, hi], colored by its position in the range
+static void setTemperatureBar(BoundBar& bar, int temp_c, int lo, int hi) {
+    int v = std::max(lo, std::min(temp_c, hi));
+    float percentage = (float)(v - lo) / (float)(hi - lo) * 100.0f;
+    bar.set(v, getTemperatureColor(percentage));
+}
 
-        // Set color based on percentage
-        lv_color_t color = getTemperatureColor(percentage);
-        lv_obj_set_style_bg_color(battery_temp_bar, color, LV_PART_INDICATOR);
-    }
-    if (battery_temp_value) {
-        lv_label_set_text_fmt(battery_temp_value, "%dC", (int)temp_c);
-    }
+void DashboardUI::updateBatteryTemp(int8_t temp_c) {
+    setTemperatureBar(battery_temp_bar, temp_c, 20, 50);        // Battery: 20-50°C
+    battery_temp_value.setInt(temp_c, "%dC");
 }
 
 void DashboardUI::updateMotorTemp(uint8_t temp_c) {
-    if (motor_temp_bar) {
-        int v = std::max(20, std::min((int)temp_c, 110));
-        lv_bar_set_value(motor_temp_bar, v, LV_ANIM_ON);
-
-        // Calculate percentage (range: 20-110°C)
-        float percentage = ((float)temp_c - 20.0f) / (110.0f - 20.0f) * 100.0f;
-        percentage = std::max(0.0f, std::min(percentage, 100.0f));
-
-        // Set color based on percentage
-        lv_color_t color = getTemperatureColor(percentage);
-        lv_obj_set_style_bg_color(motor_temp_bar, color, LV_PART_INDICATOR);
-    }
-    if (motor_temp_value) {
-        lv_label_set_text_fmt(motor_temp_value, "%dC", (int)temp_c);
-    }
+    setTemperatureBar(motor_temp_bar, temp_c, 20, 110);         // Motor: 20-110°C
+    motor_temp_value.setInt(temp_c, "%dC");
 }
 
 void DashboardUI::updateInverterTemp(uint8_t temp_c) {
-    if (inverter_temp_bar) {
-        int v = std::max(0, std::min((int)temp_c, 70));
-        lv_bar_set_value(inverter_temp_bar, v, LV_ANIM_ON);
-
-        // Calculate percentage (range: 0-70°C)
-        float percentage = ((float)temp_c - 0.0f) / (70.0f - 0.0f) * 100.0f;
-        percentage = std::max(0.0f, std::min(percentage, 100.0f));
-
-        // Set color based on percentage
-        lv_color_t color = getTemperatureColor(percentage);
-        lv_obj_set_style_bg_color(inverter_temp_bar, color, LV_PART_INDICATOR);
-    }
-    if (inverter_temp_value) {
-        lv_label_set_text_fmt(inverter_temp_value, "%dC", (int)temp_c);
-    }
+    setTemperatureBar(inverter_temp_bar, temp_c, 0, 70);        // Inverter: 0-70°C
+    inverter_temp_value.setInt(temp_c, "%dC");
 }
@@ -5,6 +5,8 @@
 #include "lvgl.h"
 #include "ui.h"           // SquareLine globals
 #include "can_receiver.h"
+#include "widget_binding.h"
+#include "digit_display.h"
 
 class DashboardUI {
 public:
@@ -15,6 +17,9 @@ public:
     void update(const CANReceiver&); // push data into widgets
     void updateTime(uint8_t h, uint8_t m, uint8_t s);
 
+    // LVGL setter calls made vs. skipped, since init
+    const WidgetUpdateStats& getUpdateStats() const { return update_stats; }
+
 private:
     // Helpers
     void updateSpeedDisplay(float speed_kmh);
@@ -26,28 +31,32 @@ private:
     void updateMotorTemp(uint8_t temp_c);
     void updateInverterTemp(uint8_t temp_c);
 
+    WidgetUpdateStats update_stats = {};
+
     // New SquareLine UI components from ui_screen_main
-    lv_obj_t* time_label = nullptr;           // ui_Time
-    lv_obj_t* gear_label = nullptr;           // ui_DNRlabel
-    lv_obj_t* torque_gauge = nullptr;         // ui_TRQgauge (Arc) - positive torque
-    lv_obj_t* torque_gauge_regen = nullptr;   // ui_TRQgauge1 (Arc) - regen/negative torque
-    lv_obj_t* speed_label = nullptr;          // ui_SPEEDlabel
-    lv_obj_t* power_gauge = nullptr;          // ui_BATPOWERgauge
-    lv_obj_t* soc_label = nullptr;            // ui_BATSOClabel
+    BoundLabel time_label;                    // ui_Time
+    BoundLabel gear_label;                    // ui_DNRlabel
+    BoundArc torque_gauge;                    // ui_TRQgauge (Arc) - positive torque
+    BoundArc torque_gauge_regen;              // ui_TRQgauge1 (Arc) - regen/negative torque
+    BoundLabel speed_label;                   // ui_SPEEDlabel
+    DigitDisplay speed_digits;                // Replaces ui_SPEEDlabel
+    BoundArc power_gauge;                     // ui_BATPOWERgauge
+    BoundLabel soc_label;                     // ui_BATSOClabel
+    DigitDisplay soc_digits;                  // Replaces ui_BATSOClabel
 
     // Battery temperature (TEMPbar, TEMPvalue, TEMPname)
-    lv_obj_t* battery_temp_bar = nullptr;     // ui_TEMPbar
-    lv_obj_t* battery_temp_value = nullptr;   // ui_TEMPvalue
+    BoundBar battery_temp_bar;                // ui_TEMPbar
+    BoundLabel battery_temp_value;            // ui_TEMPvalue
     lv_obj_t* battery_temp_name = nullptr;    // ui_TEMPname
 
     // Motor temperature (TEMPbar1, TEMPvalue1, TEMPname1)
-    lv_obj_t* motor_temp_bar = nullptr;       // ui_TEMPbar1
-    lv_obj_t* motor_temp_value = nullptr;     // ui_TEMPvalue1
+    BoundBar motor_temp_bar;                  // ui_TEMPbar1
+    BoundLabel motor_temp_value;              // ui_TEMPvalue1
     lv_obj_t* motor_temp_name = nullptr;      // ui_TEMPname1
 
     // Inverter temperature (TEMPbar2, TEMPvalue2, TEMPname2)
-    lv_obj_t* inverter_temp_bar = nullptr;    // ui_TEMPbar2
-    lv_obj_t* inverter_temp_value = nullptr;  // ui_TEMPvalue2
+    BoundBar inverter_temp_bar;               // ui_TEMPbar2
+    BoundLabel inverter_temp_value;           // ui_TEMPvalue2
     lv_obj_t* inverter_temp_name = nullptr;   // ui_TEMPname2
 };
 
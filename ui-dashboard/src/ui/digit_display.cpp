@@ -0,0 +1,163 @@
+#include "digit_display.h"
+#include <cstdlib>
+#include <cstring>
+
+// Digit images of one font in one color
+typedef struct {
+    const lv_font_t* font;
+    uint32_t color;             // lv_color_to32
+    lv_img_dsc_t digit[10];
+} DigitGlyphs;
+
+#define MAX_GLYPH_SETS 4
+
+static DigitGlyphs glyph_sets[MAX_GLYPH_SETS];
+static int glyph_set_count = 0;
+
+static void put_pixel(uint8_t* p, lv_color_t color, lv_opa_t alpha) {
+#if LV_COLOR_DEPTH == 32
+    color.ch.alpha = alpha;
+    memcpy(p, &color, sizeof(color));
+#else
+    memcpy(p, &color, sizeof(color));
+    p[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = alpha;
+#endif
+}
+
+// '0'-'9' as TRUE_COLOR_ALPHA images of the widest digit's advance, each
+// glyph centered and on the font's baseline as lv_draw_letter puts it.
+// Kept for the process lifetime.
+static const lv_img_dsc_t* rasterize_digits(const lv_font_t* font, lv_color_t color) {
+    uint32_t color32 = lv_color_to32(color);
+    for (int i = 0; i < glyph_set_count; i++) {
+        if (glyph_sets[i].font == font && glyph_sets[i].color == color32) return glyph_sets[i].digit;
+    }
+    if (!font || glyph_set_count == MAX_GLYPH_SETS) return nullptr;
+
+    lv_font_glyph_dsc_t g[10];
+    lv_coord_t cell_w = 0;
+    lv_coord_t cell_h = font->line_height;
+    for (int d = 0; d < 10; d++) {
+        if (!lv_font_get_glyph_dsc(font, &g[d], '0' + d, 0)) return nullptr;
+        if (g[d].bpp != 1 && g[d].bpp != 2 && g[d].bpp != 4 && g[d].bpp != 8) return nullptr;
+        if (g[d].adv_w > cell_w) cell_w = g[d].adv_w;
+    }
+
+    uint32_t cell_bytes = cell_w * cell_h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    uint8_t* buf = (uint8_t*)calloc(10, cell_bytes);       // Transparent
+    if (!buf) return nullptr;
+
+    DigitGlyphs* set = &glyph_sets[glyph_set_count++];
+    set->font = font;
+    set->color = color32;
+    for (int d = 0; d < 10; d++) {
+        uint8_t* cell = buf + d * cell_bytes;
+        const uint8_t* bitmap = lv_font_get_glyph_bitmap(font, '0' + d);
+        const uint32_t bpp = g[d].bpp;
+        const uint32_t max = (1u << bpp) - 1;
+        const int x0 = (cell_w - g[d].adv_w) / 2 + g[d].ofs_x;
+        const int y0 = cell_h - font->base_line - g[d].box_h - g[d].ofs_y;
+
+        // Glyph bitmaps are packed rows, MSB first, no padding
+        for (int y = 0; bitmap && y < g[d].box_h; y++) {
+            for (int x = 0; x < g[d].box_w; x++) {
+                uint32_t bit = (y * g[d].box_w + x) * bpp;
+                uint32_t v = (bitmap[bit >> 3] >> (8 - bpp - (bit & 7))) & max;
+                int cx = x0 + x, cy = y0 + y;
+                if (!v || cx < 0 || cx >= cell_w || cy < 0 || cy >= cell_h) continue;
+                put_pixel(cell + (cy * cell_w + cx) * LV_IMG_PX_SIZE_ALPHA_BYTE, color, (lv_opa_t)(v * 255 / max));
+            }
+        }
+
+        lv_img_dsc_t* dsc = &set->digit[d];
+        memset(dsc, 0, sizeof(*dsc));
+        dsc->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        dsc->header.w = cell_w;
+        dsc->header.h = cell_h;
+        dsc->data_size = cell_bytes;
+        dsc->data = cell;
+    }
+    return set->digit;
+}
+
+bool DigitDisplay::create(lv_obj_t* label, uint8_t digits, const char* suffix, DigitSuffixPos suffix_pos,
+                          uint32_t max_hz, WidgetUpdateStats* stats) {
+    if (!label || digits == 0 || digits > MAX_DIGITS) return false;
+    const lv_font_t* font = lv_obj_get_style_text_font(label, LV_PART_MAIN);
+    lv_color_t color = lv_obj_get_style_text_color(label, LV_PART_MAIN);
+    glyphs_ = rasterize_digits(font, color);
+    if (!glyphs_) return false;
+
+    const lv_coord_t cell_w = glyphs_[0].header.w;
+    const lv_coord_t cell_h = glyphs_[0].header.h;
+    const lv_coord_t digits_w = digits * cell_w;
+
+    lv_obj_t* box = lv_obj_create(lv_obj_get_parent(label));
+    lv_obj_remove_style_all(box);
+    lv_obj_clear_flag(box, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+
+    // Size: digits plus suffix; digits and suffix right-aligned
+    lv_coord_t w = digits_w, h = cell_h;
+    lv_obj_t* suffix_label = nullptr;
+    lv_point_t suffix_size = { 0, 0 };
+    if (suffix && *suffix) {
+        suffix_label = lv_label_create(box);
+        lv_obj_set_style_text_font(suffix_label, font, LV_PART_MAIN);
+        lv_obj_set_style_text_color(suffix_label, color, LV_PART_MAIN);
+        lv_label_set_text(suffix_label, suffix);
+        lv_txt_get_size(&suffix_size, suffix, font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+        if (suffix_pos == DIGITS_SUFFIX_RIGHT) {
+            w += suffix_size.x;
+        } else {
+            w = LV_MAX(w, suffix_size.x);
+            h += suffix_size.y;
+        }
+    }
+    const lv_coord_t digits_x = suffix_pos == DIGITS_SUFFIX_RIGHT ? 0 : w - digits_w;
+    if (suffix_label) {
+        if (suffix_pos == DIGITS_SUFFIX_RIGHT) lv_obj_set_pos(suffix_label, digits_w, 0);
+        else lv_obj_set_pos(suffix_label, w - suffix_size.x, cell_h);
+    }
+
+    // Where the label was
+    lv_obj_set_size(box, w, h);
+    lv_obj_set_align(box, (lv_align_t)lv_obj_get_style_align(label, LV_PART_MAIN));
+    lv_obj_set_pos(box, lv_obj_get_style_x(label, LV_PART_MAIN), lv_obj_get_style_y(label, LV_PART_MAIN));
+
+    for (uint8_t i = 0; i < digits; i++) {
+        cells_[i] = lv_img_create(box);
+        lv_img_set_src(cells_[i], &glyphs_[0]);
+        lv_obj_set_pos(cells_[i], digits_x + i * cell_w, 0);
+        lv_obj_add_flag(cells_[i], LV_OBJ_FLAG_HIDDEN);
+        shown_digit_[i] = -1;
+    }
+    digits_ = digits;
+
+    lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+    bind(box, max_hz, stats);
+    return true;
+}
+
+void DigitDisplay::set(int32_t value) {
+    int32_t limit = 1;
+    for (uint8_t i = 0; i < digits_; i++) limit *= 10;
+    value = LV_CLAMP(0, value, limit - 1);
+    if (!admit(value != value_)) return;
+    value_ = value;
+
+    // Last cell holds the ones; zeros left of the first digit are hidden
+    int32_t rest = value;
+    for (int i = digits_ - 1; i >= 0; i--) {
+        int8_t d = (rest > 0 || i == digits_ - 1) ? (int8_t)(rest % 10) : -1;
+        rest /= 10;
+        if (d == shown_digit_[i]) continue;
+
+        if (d < 0) {
+            lv_obj_add_flag(cells_[i], LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_img_set_src(cells_[i], &glyphs_[d]);
+            if (shown_digit_[i] < 0) lv_obj_clear_flag(cells_[i], LV_OBJ_FLAG_HIDDEN);
+        }
+        shown_digit_[i] = d;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef DIGIT_DISPLAY_H
+#define DIGIT_DISPLAY_H
+
+// ============================================================================
+// Fixed-width digit display for the large numeric readouts (speed, SOC)
+// ============================================================================
+// Replaces a SquareLine label: the digits 0-9 of the label's font are
+// rasterized once, in its text color, into images of one fixed-width cell
+// (shared by every display with the same font and color). Each digit
+// position is an image object showing one of them, so a change from 63 to
+// 64 sets one image source and invalidates one cell: no printf, no label
+// layout, no glyph rendering. Digits are right-aligned; leading cells are
+// hidden. The suffix ("kph", "%") is a label drawn once.
+
+#include <cstdint>
+#include "lvgl.h"
+#include "widget_binding.h"
+
+typedef enum {
+    DIGITS_SUFFIX_RIGHT,        // "64%"
+    DIGITS_SUFFIX_BELOW,        // "64" over "kph"
+} DigitSuffixPos;
+
+class DigitDisplay : public BoundWidget {
+public:
+    // Hides label and puts the display where it was, in its font and color.
+    // false if the font cannot be rasterized (label left as it is).
+    bool create(lv_obj_t* label, uint8_t digits, const char* suffix, DigitSuffixPos suffix_pos,
+                uint32_t max_hz, WidgetUpdateStats* stats);
+
+    // Clamped to 0 .. 10^digits - 1
+    void set(int32_t value);
+
+private:
+    static const uint8_t MAX_DIGITS = 4;
+
+    const lv_img_dsc_t* glyphs_ = nullptr;  // [10]
+    lv_obj_t* cells_[MAX_DIGITS] = {};      // Most significant first
+    int8_t shown_digit_[MAX_DIGITS] = {};   // -1 = hidden
+    uint8_t digits_ = 0;
+    int32_t value_ = 0;
+};
+
+#endif // DIGIT_DISPLAY_H
@@ -0,0 +1,204 @@
+#include "gauge_layers.h"
+#include "ui.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// A local style override and the local value it replaced, if there was one
+typedef struct {
+    lv_obj_t* obj;
+    lv_style_prop_t prop;
+    lv_part_t part;
+    bool had_local;
+    lv_style_value_t value;
+} SavedProp;
+
+#define MAX_SAVED_PROPS 16
+
+typedef struct {
+    SavedProp props[MAX_SAVED_PROPS];
+    int count;
+} SavedProps;
+
+static GaugeDrawStats stats[GAUGE_LAYER_GAUGES];
+static uint64_t draw_start_us[GAUGE_LAYER_GAUGES];
+static bool timing_attached = false;
+
+static lv_obj_t* layer = nullptr;
+static lv_img_dsc_t layer_dsc;
+static void* layer_buf = nullptr;
+static SavedProps live_overrides;       // While the layer is shown
+static lv_obj_t* statics[6];            // Cached completely, hidden while the layer is shown
+
+#define MAX_LIVE_OBJECTS 8
+static lv_obj_t* extra_live[MAX_LIVE_OBJECTS];
+static int extra_live_count = 0;
+
+static uint64_t now_us() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void override_prop(SavedProps* saved, lv_obj_t* obj, lv_style_prop_t prop, lv_part_t part, int32_t num) {
+    if (!obj || saved->count == MAX_SAVED_PROPS) return;
+    SavedProp* s = &saved->props[saved->count++];
+    s->obj = obj;
+    s->prop = prop;
+    s->part = part;
+    s->had_local = lv_obj_get_local_style_prop(obj, prop, &s->value, part | LV_STATE_DEFAULT) == LV_RES_OK;
+
+    lv_style_value_t v;
+    v.num = num;
+    lv_obj_set_local_style_prop(obj, prop, v, part | LV_STATE_DEFAULT);
+}
+
+static void restore_props(SavedProps* saved) {
+    for (int i = saved->count - 1; i >= 0; i--) {
+        const SavedProp* s = &saved->props[i];
+        // Without a local value before, the theme/shared styles apply again
+        if (s->had_local) lv_obj_set_local_style_prop(s->obj, s->prop, s->value, s->part | LV_STATE_DEFAULT);
+        else lv_obj_remove_local_style_prop(s->obj, s->prop, s->part | LV_STATE_DEFAULT);
+    }
+    saved->count = 0;
+}
+
+static void set_hidden(lv_obj_t* const* objs, int n, bool hidden) {
+    for (int i = 0; i < n; i++) {
+        if (!objs[i]) continue;
+        if (hidden) lv_obj_add_flag(objs[i], LV_OBJ_FLAG_HIDDEN);
+        else lv_obj_clear_flag(objs[i], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Hides the visible ones; returns them in out (for set_hidden(out, n, false))
+static int hide_visible(lv_obj_t* const* objs, int n, lv_obj_t** out) {
+    int hidden = 0;
+    for (int i = 0; i < n; i++) {
+        if (!objs[i] || lv_obj_has_flag(objs[i], LV_OBJ_FLAG_HIDDEN)) continue;
+        lv_obj_add_flag(objs[i], LV_OBJ_FLAG_HIDDEN);
+        out[hidden++] = objs[i];
+    }
+    return hidden;
+}
+
+// ============================================================================
+// DRAW TIMING
+// ============================================================================
+
+static void gauge_draw_cb(lv_event_t* e) {
+    GaugeDrawStats* s = (GaugeDrawStats*)lv_event_get_user_data(e);
+    int i = (int)(s - stats);
+    if (lv_event_get_code(e) == LV_EVENT_DRAW_MAIN_BEGIN) {
+        draw_start_us[i] = now_us();
+        return;
+    }
+
+    uint32_t us = (uint32_t)(now_us() - draw_start_us[i]);
+    s->draws++;
+    s->total_us += us;
+    if (us > s->max_us) s->max_us = us;
+}
+
+static void attach_timing() {
+    lv_obj_t* gauges[GAUGE_LAYER_GAUGES] = { ui_TRQgauge, ui_TRQgauge1, ui_BATPOWERgauge };
+    static const char* names[GAUGE_LAYER_GAUGES] = { "torque", "regen", "power" };
+    for (int i = 0; i < GAUGE_LAYER_GAUGES; i++) {
+        stats[i] = {};
+        stats[i].name = names[i];
+        if (!gauges[i]) continue;
+        lv_obj_add_event_cb(gauges[i], gauge_draw_cb, LV_EVENT_DRAW_MAIN_BEGIN, &stats[i]);
+        lv_obj_add_event_cb(gauges[i], gauge_draw_cb, LV_EVENT_DRAW_POST_END, &stats[i]);
+    }
+    timing_attached = true;
+}
+
+// ============================================================================
+// LAYER
+// ============================================================================
+
+bool gauge_layers_init(bool cache) {
+    if (!ui_screen_main) return false;
+    if (!timing_attached) attach_timing();
+    if (!cache || layer) return layer != nullptr;
+
+    // Cached completely, then hidden
+    lv_obj_t* screen_statics[] = { ui_Container2, ui_Container1, ui_Logo, ui_TEMPname, ui_TEMPname1, ui_TEMPname2 };
+    static_assert(sizeof(screen_statics) == sizeof(statics), "statics");
+    memcpy(statics, screen_statics, sizeof(statics));
+    // Left out of the layer entirely
+    lv_obj_t* screen_dynamics[] = { ui_Time, ui_DNRlabel, ui_SPEEDlabel, ui_BATSOClabel,
+                                    ui_TEMPvalue, ui_TEMPvalue1, ui_TEMPvalue2 };
+    const int n_screen_dynamics = sizeof(screen_dynamics) / sizeof(screen_dynamics[0]);
+    lv_obj_t* dynamics[n_screen_dynamics + MAX_LIVE_OBJECTS];
+    lv_obj_t* hidden[n_screen_dynamics + MAX_LIVE_OBJECTS];
+    memcpy(dynamics, screen_dynamics, sizeof(screen_dynamics));
+    memcpy(dynamics + n_screen_dynamics, extra_live, extra_live_count * sizeof(lv_obj_t*));
+    // Track cached, indicator (and knob) drawn live
+    lv_obj_t* arcs[] = { ui_TRQgauge, ui_TRQgauge1, ui_BATPOWERgauge };
+    lv_obj_t* bars[] = { ui_TEMPbar, ui_TEMPbar1, ui_TEMPbar2 };
+
+    // Render the screen without its live parts
+    SavedProps capture = {};
+    int n_hidden = hide_visible(dynamics, n_screen_dynamics + extra_live_count, hidden);
+    for (lv_obj_t* arc : arcs) {
+        override_prop(&capture, arc, LV_STYLE_ARC_OPA, LV_PART_INDICATOR, LV_OPA_TRANSP);
+        override_prop(&capture, arc, LV_STYLE_BG_OPA, LV_PART_KNOB, LV_OPA_TRANSP);
+    }
+    for (lv_obj_t* bar : bars) {
+        override_prop(&capture, bar, LV_STYLE_BG_OPA, LV_PART_INDICATOR, LV_OPA_TRANSP);
+    }
+    lv_obj_update_layout(ui_screen_main);
+
+    uint32_t size = lv_snapshot_buf_size_needed(ui_screen_main, LV_IMG_CF_TRUE_COLOR);
+    layer_buf = size ? malloc(size) : nullptr;      // 1.5 MB at 800x480x32: not from the LVGL heap
+    lv_res_t res = layer_buf ? lv_snapshot_take_to_buf(ui_screen_main, LV_IMG_CF_TRUE_COLOR,
+                                                       &layer_dsc, layer_buf, size)
+                             : LV_RES_INV;
+
+    restore_props(&capture);
+    set_hidden(hidden, n_hidden, false);
+    if (res != LV_RES_OK) {
+        printf("[UI] Static layer snapshot failed, drawing everything live\n");
+        free(layer_buf);
+        layer_buf = nullptr;
+        return false;
+    }
+
+    // Opaque and screen-sized: LVGL starts every redraw from it
+    lv_coord_t ext = _lv_obj_get_ext_draw_size(ui_screen_main);
+    layer = lv_img_create(ui_screen_main);
+    lv_img_set_src(layer, &layer_dsc);
+    lv_obj_set_pos(layer, -ext, -ext);
+    lv_obj_move_background(layer);
+
+    set_hidden(statics, sizeof(statics) / sizeof(statics[0]), true);
+    for (lv_obj_t* arc : arcs) {
+        override_prop(&live_overrides, arc, LV_STYLE_ARC_OPA, LV_PART_MAIN, LV_OPA_TRANSP);
+    }
+    for (lv_obj_t* bar : bars) {
+        override_prop(&live_overrides, bar, LV_STYLE_BG_OPA, LV_PART_MAIN, LV_OPA_TRANSP);
+    }
+    lv_obj_invalidate(ui_screen_main);
+
+    printf("[UI] Static layer cached (%dx%d, %u KB)\n", (int)layer_dsc.header.w, (int)layer_dsc.header.h, size / 1024);
+    return true;
+}
+
+void gauge_layers_add_live(lv_obj_t* obj) {
+    if (obj && extra_live_count < MAX_LIVE_OBJECTS) extra_live[extra_live_count++] = obj;
+}
+
+void gauge_layers_get_stats(GaugeDrawStats out[GAUGE_LAYER_GAUGES]) {
+    for (int i = 0; i < GAUGE_LAYER_GAUGES; i++) out[i] = stats[i];
+}
+
+void gauge_layers_cleanup() {
+    if (!layer) return;
+    set_hidden(statics, sizeof(statics) / sizeof(statics[0]), false);
+    restore_props(&live_overrides);
+    lv_obj_del(layer);
+    layer = nullptr;
+    free(layer_buf);
+    layer_buf = nullptr;
+}
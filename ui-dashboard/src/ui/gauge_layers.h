@@ -0,0 +1,44 @@
+#ifndef GAUGE_LAYERS_H
+#define GAUGE_LAYERS_H
+
+// ============================================================================
+// Static layer cache for ui_screen_main
+// ============================================================================
+// Most of the main screen never changes: the background containers (the top
+// bar's gradient), the zoomed logo, the temperature names and the tracks of
+// the three arcs and the temperature bars. gauge_layers_init() renders all
+// of that once into an opaque full-screen image (lv_snapshot, outside the
+// LVGL heap) placed behind everything; the cached objects are then hidden,
+// or keep only their live parts: arc indicator + knob, bar indicator.
+// A redraw of a gauge becomes an image copy plus its indicator instead of
+// gradient, background arc and anti-aliasing work.
+//
+// Draw time of each gauge is measured either way, to compare with the
+// cache off (--no-layer-cache).
+
+#include <cstdint>
+#include "lvgl.h"
+
+#define GAUGE_LAYER_GAUGES 3            // ui_TRQgauge, ui_TRQgauge1, ui_BATPOWERgauge
+
+typedef struct {
+    const char* name;
+    uint32_t draws;                     // Draw passes (one per refreshed area the gauge is in)
+    uint64_t total_us;
+    uint32_t max_us;
+} GaugeDrawStats;
+
+// After ui_init() and DashboardUI::init(). cache = false only times the
+// gauges. Returns false if the layer could not be rendered (screen as before).
+bool gauge_layers_init(bool cache);
+
+// Before gauge_layers_init(): an object created on top of the SquareLine
+// screen that changes at runtime, left out of the layer
+void gauge_layers_add_live(lv_obj_t* obj);
+
+void gauge_layers_get_stats(GaugeDrawStats out[GAUGE_LAYER_GAUGES]);
+
+// Restores the screen and frees the layer
+void gauge_layers_cleanup();
+
+#endif // GAUGE_LAYERS_H
@@ -0,0 +1,42 @@
+#include "perf_overlay.h"
+#include "frame_stats.h"
+#include <cstdio>
+
+static lv_obj_t* overlay = nullptr;
+static uint32_t shown_seq = 0;
+
+void perf_overlay_create() {
+    overlay = lv_label_create(lv_layer_top());
+    lv_obj_set_style_text_font(overlay, &lv_font_montserrat_12, LV_PART_MAIN);
+    lv_obj_set_style_text_color(overlay, lv_color_white(), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(overlay, lv_color_black(), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_70, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(overlay, 4, LV_PART_MAIN);
+    lv_obj_align(overlay, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_label_set_text(overlay, "frame stats: waiting for first window");
+}
+
+void perf_overlay_update() {
+    FrameStats s;
+    uint32_t seq;
+    if (!overlay || !frame_stats_window(&s, &seq) || seq == shown_seq) return;
+    shown_seq = seq;
+
+    // avg / p99 (bucket bound) per frame; the overlay's own redraw is included
+    const FrameHist& r = s.render_us;
+    const FrameHist& f = s.flush_us;
+    const FrameHist& a = s.area_px;
+    const FrameHist& l = s.loop_us;
+
+    // snprintf: LVGL's own printf is built without float support
+    char text[160];
+    snprintf(text, sizeof(text),
+             "%.1f fps  render %.2f/%.2f ms  flush %.2f/%.2f ms  %u kpx  %.1f bands  loop %.1f/%.1f ms",
+             s.frames / s.seconds,
+             r.count ? r.sum / r.count / 1000.0 : 0.0, frame_hist_percentile(&r, 0.99f) / 1000.0,
+             f.count ? f.sum / f.count / 1000.0 : 0.0, frame_hist_percentile(&f, 0.99f) / 1000.0,
+             (unsigned)(a.count ? a.sum / a.count / 1000 : 0),
+             s.bands.count ? (double)s.bands.sum / s.bands.count : 0.0,
+             l.count ? l.sum / l.count / 1000.0 : 0.0, frame_hist_percentile(&l, 0.99f) / 1000.0);
+    lv_label_set_text(overlay, text);
+}
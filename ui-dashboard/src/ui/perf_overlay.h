@@ -0,0 +1,11 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include "lvgl.h"
+
+// Frame stats overlay (--overlay): one small label on the top layer showing
+// the last frame_stats window; redrawn only when a window closes
+void perf_overlay_create();
+void perf_overlay_update();
+
+#endif // PERF_OVERLAY_H
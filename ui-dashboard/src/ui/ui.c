@@ -14,8 +14,8 @@ lv_obj_t * ui____initial_actions0;
 // IMAGES AND IMAGE SETS
 
 ///////////////////// TEST LVGL SETTINGS ////////////////////
-#if LV_COLOR_DEPTH != 32
-    #error "LV_COLOR_DEPTH should be 32bit to match SquareLine Studio's settings"
+#if LV_COLOR_DEPTH != 32 && LV_COLOR_DEPTH != 16
+    #error "LV_COLOR_DEPTH should be 32bit (or 16bit for the RGB565 build) to match SquareLine Studio's settings"
 #endif
 #if LV_COLOR_16_SWAP !=0
     #error "LV_COLOR_16_SWAP should be 0 to match SquareLine Studio's settings"
@@ -0,0 +1,68 @@
+#include "widget_binding.h"
+#include <cstdio>
+#include <cstring>
+
+void BoundWidget::bind(lv_obj_t* obj, uint32_t max_hz, WidgetUpdateStats* stats) {
+    obj_ = obj;
+    stats_ = stats;
+    period_ms_ = max_hz ? 1000 / max_hz : 0;
+    shown_ = false;
+}
+
+bool BoundWidget::admit(bool changed) {
+    if (!obj_) return false;
+    if (shown_ && !changed) {
+        stats_->unchanged++;
+        return false;
+    }
+    if (shown_ && lv_tick_elaps(last_ms_) < period_ms_) {
+        stats_->deferred++;
+        return false;
+    }
+    last_ms_ = lv_tick_get();
+    shown_ = true;
+    stats_->applied++;
+    return true;
+}
+
+void BoundLabel::setInt(int32_t value, const char* fmt) {
+    if (shown_ && value == value_) {
+        admit(false);
+        return;
+    }
+
+    // Different values can still print the same
+    char text[sizeof(text_)];
+    snprintf(text, sizeof(text), fmt, (int)value);
+    bool changed = strcmp(text, text_) != 0;
+    if (!admit(changed)) {
+        if (!changed) value_ = value;
+        return;
+    }
+    value_ = value;
+    memcpy(text_, text, sizeof(text_));
+    lv_label_set_text(obj_, text_);
+}
+
+void BoundLabel::setText(const char* text) {
+    if (!admit(strncmp(text, text_, sizeof(text_)) != 0)) return;
+    snprintf(text_, sizeof(text_), "%s", text);
+    lv_label_set_text(obj_, text_);
+}
+
+void BoundArc::set(int32_t value) {
+    if (!admit(value != value_)) return;
+    value_ = value;
+    lv_arc_set_value(obj_, (int16_t)value);
+}
+
+void BoundBar::set(int32_t value, lv_color_t indicator) {
+    uint32_t color = lv_color_to32(indicator);
+    bool first = !shown_;
+    if (!admit(value != value_ || color != color_)) return;
+
+    if (first || value != value_) lv_bar_set_value(obj_, value, LV_ANIM_ON);
+    if (first || color != color_) lv_obj_set_style_bg_color(obj_, indicator, LV_PART_INDICATOR);
+    value_ = value;
+    color_ = color;
+}
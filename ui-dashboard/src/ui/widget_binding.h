@@ -0,0 +1,72 @@
+#ifndef WIDGET_BINDING_H
+#define WIDGET_BINDING_H
+
+// ============================================================================
+// Widget bindings: change detection + refresh rate caps for DashboardUI
+// ============================================================================
+// DashboardUI::update() runs every main loop iteration (~200 Hz). Each
+// binding remembers what its widget displays and only calls the LVGL setter
+// (text layout, style refresh, invalidation) when that changes, and at most
+// max_hz times per second. A value changed within the cap is not lost: the
+// next update() after the period applies whatever is current then.
+
+#include <cstdint>
+#include "lvgl.h"
+
+// Refresh caps (Hz)
+#define UI_RATE_FAST_HZ  30     // Speed, torque/power arcs, gear
+#define UI_RATE_TEMP_HZ  10     // Temperature bars and labels
+#define UI_RATE_SLOW_HZ   5     // SOC, clock
+
+typedef struct {
+    uint32_t applied;           // LVGL setter called
+    uint32_t unchanged;         // Skipped: already displayed
+    uint32_t deferred;          // Skipped: changed, but inside the rate cap
+} WidgetUpdateStats;
+
+class BoundWidget {
+public:
+    void bind(lv_obj_t* obj, uint32_t max_hz, WidgetUpdateStats* stats);
+    lv_obj_t* get() const { return obj_; }
+
+protected:
+    // true if the widget should be refreshed now; counts the outcome
+    bool admit(bool changed);
+
+    lv_obj_t* obj_ = nullptr;
+    WidgetUpdateStats* stats_ = nullptr;
+    uint32_t period_ms_ = 0;
+    uint32_t last_ms_ = 0;
+    bool shown_ = false;        // First set always goes through
+};
+
+class BoundLabel : public BoundWidget {
+public:
+    // printf-style with one int; formats only when the value changed
+    void setInt(int32_t value, const char* fmt);
+    void setText(const char* text);
+
+private:
+    int32_t value_ = 0;
+    char text_[24] = "";        // As displayed
+};
+
+class BoundArc : public BoundWidget {
+public:
+    void set(int32_t value);
+
+private:
+    int32_t value_ = 0;
+};
+
+class BoundBar : public BoundWidget {
+public:
+    // Value (animated) and indicator color
+    void set(int32_t value, lv_color_t indicator);
+
+private:
+    int32_t value_ = 0;
+    uint32_t color_ = 0;        // lv_color_to32
+};
+
+#endif // WIDGET_BINDING_H